@@ -1,47 +1,1106 @@
 ﻿#include <fstream>
 #include <filesystem>
 #include <format>
+#include <vector>
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <set>
+#include <map>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
 
 #include "ClassInfo.hpp"
 #include "Logger.hpp"
 #include "bench_timer.hpp"
 #include "IOUtils.hpp"
+#include "ThreadPool.hpp"
+#include "CmdLine.hpp"
+#include "Manifest.hpp"
+#include "Watcher.hpp"
+#include "SymbolIndex.hpp"
+#include "BenchSuite.hpp"
+#include "Metadata.hpp"
+#include "Namespaces.hpp"
+#include "ApiDiff.hpp"
+#include "Server.hpp"
+#include "NdJson.hpp"
+#include "Shard.hpp"
 
 using namespace std;
 namespace fs = std::filesystem;
 
-int main(int argc, char* argv[]) try {
-    fs::path inputDir = ".\\input";
-    fs::path outputDir = ".\\output";
+// --regex-stats：各文件在正则路径上的耗时，按分支拆开；工作线程共用，同一文件再次解析时覆盖
+class RegexReport {
+public:
+    void add(string key, size_t bytes, const RegexStats& stats) {
+        lock_guard lock(mutex_);
+        rows_.insert_or_assign(std::move(key), Row{ bytes, stats });
+    }
 
-    LOG_DEBUG("ClassLike: {}", ClassLike::getBuilder().pattern);
-    LOG_DEBUG("   Method: {}",    Method::getBuilder().pattern);
-    LOG_DEBUG("    Field: {}",     Field::getBuilder().pattern);
-    LOG_DEBUG(" Property: {}",  Property::getBuilder().pattern);
-    LOG_DEBUG(" Constant: {}",  Constant::getBuilder().pattern);
-    LOG_DEBUG("    Event: {}",     Event::getBuilder().pattern);
+    bool empty() const {
+        lock_guard lock(mutex_);
+        return rows_.empty();
+    }
 
-    BENCH_SCOPE("总耗时");
+    // 制表符分隔，按总耗时从高到低
+    string table() const {
+        lock_guard lock(mutex_);
+        vector<const pair<const string, Row>*> order;
+        for (auto&& row : rows_)
+            order.push_back(&row);
+        ranges::stable_sort(order, greater{}, [](auto* r) { return r->second.stats.total(); });
 
-    LOG_INFO("正在扫描 {}", inputDir.string());
-    auto files = IOUtils::list_files(inputDir, ".cs");
+        auto ms = [](RegexStats::clock::duration d) { return chrono::duration<double, milli>(d).count(); };
+        string out = "文件\t字节\t总计(ms)\t未匹配(ms)";
+        for (auto name : MemberRegexBranches)
+            std::format_to(back_inserter(out), "\t{}(ms)", name);
+        out += "\t超长声明\t正则报错\t改用扫描器\t超时\n";
+        for (auto* r : order) {
+            auto& st = r->second.stats;
+            std::format_to(back_inserter(out), "{}\t{}\t{:.3f}\t{:.3f}", r->first, r->second.bytes, ms(st.total()), ms(st.missed.time));
+            for (size_t k = 0; k < MemberRegexBranches.size(); ++k)
+                std::format_to(back_inserter(out), "\t{:.3f}", ms(st.matched[k].time));
+            std::format_to(back_inserter(out), "\t{}\t{}\t{}\t{}\n", st.longDecls, st.errors, st.fallbacks, st.timedOut ? "是" : "");
+        }
+        return out;
+    }
 
-    LOG_INFO("共发现 {} 个文件", files.size());
+private:
+    struct Row {
+        size_t bytes;
+        RegexStats stats;
+    };
+    mutable mutex mutex_;
+    map<string, Row> rows_;
+};
+
+static RegexReport regexReport;
+
+// 按选项解析一个文件。正则路径按 --regex-window/--regex-budget 限额，超出的声明层文本段改用扫描器，
+// 这样的文件记一条警告并指出最慢的分支
+static ClassInfoView parseFile(string_view text, const fs::path& file, const cli::Options& opt) {
+    if (!opt.regex)
+        return ClassInfoView(text);
+
+    RegexStats stats;
+    ClassInfoView info(text, Parser::Regex, RegexBudget{ opt.regexWindow, chrono::milliseconds(opt.regexBudget) }, &stats);
+    if (stats.degraded()) {
+        size_t slowest = 0;
+        for (size_t k = 1; k < MemberRegexBranches.size(); ++k)
+            if (stats.matched[k].time > stats.matched[slowest].time)
+                slowest = k;
+        auto reason = stats.timedOut ? std::format("超过 {} ms 时限", opt.regexBudget)
+                    : stats.longDecls ? std::format("遇到超过 {} 字节的声明", opt.regexWindow)
+                    : string("正则库报错");
+        LOG_WARN("{}：正则匹配{}，{} 段改用扫描器；最慢的分支为 {}（{:.1f} ms），未匹配的尝试共 {:.1f} ms",
+                 file.string(), reason, stats.fallbacks, MemberRegexBranches[slowest],
+                 chrono::duration<double, milli>(stats.matched[slowest].time).count(),
+                 chrono::duration<double, milli>(stats.missed.time).count());
+    }
+    if (!opt.regexStatsFile.empty())
+        regexReport.add(Manifest::keyFor(file, opt.inputDir), text.size(), stats);
+    return info;
+}
+
+static void writeRegexStats(const cli::Options& opt) {
+    if (opt.regexStatsFile.empty() || regexReport.empty())
+        return;
+    IOUtils::write_file(opt.regexStatsFile, regexReport.table());
+    LOG_INFO("→ 正则耗时统计已写入 {}", opt.regexStatsFile.string());
+}
+
+// 解析方式，计入清单版本戳与分片摘要
+static string parseMode(const cli::Options& opt) {
+    return opt.regex ? std::format("regex/{}", opt.regexWindow) : "scanner";
+}
+
+// 工具版本、匹配规则与解析方式；分片摘要记下它，merge 据此确认各分片能够合并
+static uint64_t configStamp(string_view mode) {
+    return IOUtils::hash_bytes(std::format("{}|{}|{}", AnalyzerVersion, MemberRegex::pattern, mode));
+}
 
+// 清单版本戳在此之外再加上输入目录，任一变化都重新全量分析
+static uint64_t manifestStamp(string_view mode, const fs::path& inputDir) {
+    return IOUtils::hash_bytes(std::format("{}|{}|{}|{}", AnalyzerVersion, MemberRegex::pattern, mode,
+                                           fs::absolute(inputDir).lexically_normal().generic_string()));
+}
+
+// --shard：只留下本分片的文件，并填好分片摘要；摘要等本分片的结果全部落盘后再由调用方写出
+static vector<fs::path> selectShard(const vector<fs::path>& files, const cli::Options& opt, uint64_t stamp, shard::Summary& summary) {
+    auto summaryPath = shard::Summary::pathFor(opt.outputDir);
+    error_code ec;
+    fs::remove(summaryPath, ec);        // 中途失败时不留下旧摘要，merge 会报缺分片
+
+    vector<string> keys(files.size());
+    vector<uintmax_t> sizes(files.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        keys[i] = Manifest::keyFor(files[i], opt.inputDir);
+        sizes[i] = fs::file_size(files[i], ec);
+        if (ec)
+            sizes[i] = 0;
+    }
+    auto owner = shard::assign(keys, sizes, opt.shardCount);
+
+    vector<fs::path> mine;
+    uintmax_t bytes = 0, total = 0;
+    for (size_t i = 0; i < files.size(); ++i) {
+        total += sizes[i];
+        if (owner[i] == opt.shardIndex) {
+            mine.push_back(files[i]);
+            bytes += sizes[i];
+        }
+    }
+    auto mode = parseMode(opt);
+    summary = { opt.shardIndex, opt.shardCount, configStamp(mode), stamp, files.size(), shard::listingHash(keys, sizes), mode };
+    LOG_INFO("分片 {}/{}：{} 个文件、{} 字节（全部 {} 个文件、{} 字节）",
+             opt.shardIndex, opt.shardCount, mine.size(), bytes, files.size(), total);
+    return mine;
+}
+
+// 单个文件的处理结果
+struct FileResult {
+    fs::path outPath;
+    vector<nslist::TypeName> types;     // 顶层类型，供命名空间列表使用
+};
+
+// 读取、解析、格式化单个文件并交给后台写出
+static FileResult processFile(const fs::path& file, const cli::Options& opt, IOUtils::AsyncWriter& writer) {
+    // 映射只在本函数内存活，info 中的成员都是指向映射内容的视图
+    IOUtils::MappedFile mapped(file);
+    auto info = parseFile(mapped.view(), file, opt);
+
+    // 复用写出线程回收的缓冲区，按估计大小预留一次，格式化结果直接交给写出线程
+    string result = writer.acquire();
+    {
+        PROFILE_SCOPE("格式化");
+        result.reserve(std::formatter<ClassInfoView>::sizeHint(info));
+        std::format_to(back_inserter(result), "{}", info);
+    }
+
+    auto outPath = IOUtils::make_output_path(file, opt.inputDir, opt.outputDir);
+    writer.submit(outPath, std::move(result));
+    return { outPath, nslist::collectTypes(info) };
+}
+
+// 对照旧清单挑出需要重新分析的文件；大小与时间戳都没变直接跳过，时间戳变了但内容哈希相同的只刷新清单。
+// 需要分析的文件在这里算好内容哈希记进 next，去重时直接取用，不再读第二遍
+static vector<fs::path> selectChanged(const vector<fs::path>& files, const cli::Options& opt,
+                                      const Manifest& old, Manifest& next) {
+    vector<fs::path> todo;
     for (const auto& file : files) {
-        BENCH_SCOPE(std::format("处理文件 {}", file.filename().string()));
+        auto key = Manifest::keyFor(file, opt.inputDir);
+        error_code sizeEc, timeEc;
+        Manifest::Entry cur{ 0, fs::file_size(file, sizeEc), Manifest::mtimeOf(file, timeEc) };
+
+        const auto* prev = opt.full ? nullptr : old.find(key);
+        if (prev && !sizeEc && !timeEc && prev->size == cur.size && prev->mtime == cur.mtime
+            && fs::exists(IOUtils::make_output_path(file, opt.inputDir, opt.outputDir))) {
+            next.set(key, *prev);
+            continue;
+        }
+        cur.hash = IOUtils::hash_bytes(IOUtils::MappedFile(file).view());
+        next.set(std::move(key), cur);
+        if (!prev || sizeEc || timeEc || prev->size != cur.size || cur.hash != prev->hash
+            || !fs::exists(IOUtils::make_output_path(file, opt.inputDir, opt.outputDir)))
+            todo.push_back(file);
+    }
+    return todo;
+}
+
+// 删除源文件已不存在的输出，并顺带清掉因此变空的输出子目录
+static void removeOrphans(const Manifest& old, const Manifest& next, const cli::Options& opt) {
+    for (auto&& [key, e] : old.entries()) {
+        if (next.find(key))
+            continue;
+        fs::path rel(u8string(key.begin(), key.end()));
+        auto outPath = IOUtils::make_output_path(opt.inputDir / rel, opt.inputDir, opt.outputDir);
+        error_code ec;
+        if (fs::remove(outPath, ec))
+            LOG_INFO("× 已删除 {}", outPath.string());
+        for (auto dir = rel.parent_path(); !dir.empty(); dir = dir.parent_path()) {
+            if (!fs::is_empty(opt.outputDir / dir, ec) || ec || !fs::remove(opt.outputDir / dir, ec))
+                break;
+        }
+    }
+}
+
+// 多线程处理：大文件优先调度，结果按原顺序返回
+static vector<FileResult> processParallel(const vector<fs::path>& files, const cli::Options& opt, IOUtils::AsyncWriter& writer) {
+    vector<size_t> order(files.size());
+    vector<uintmax_t> sizes(files.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        error_code ec;
+        order[i] = i;
+        sizes[i] = fs::file_size(files[i], ec);
+    }
+    ranges::stable_sort(order, greater{}, [&](size_t i) { return sizes[i]; });
+
+    vector<FileResult> results(files.size());
+    vector<exception_ptr> errors(files.size());
+
+    ClassInfoView::warmUp(opt.regex ? Parser::Regex : Parser::Scanner);
+    {
+        ThreadPool pool(opt.jobs);
+        LOG_INFO("使用 {} 个线程处理", pool.size());
+        for (size_t i : order) {
+            pool.submit([&, i] {
+                try {
+                    BENCH_SCOPE("处理文件", files[i].filename().string());
+                    results[i] = processFile(files[i], opt, writer);
+                }
+                catch (...) {
+                    errors[i] = current_exception();
+                }
+            });
+        }
+        pool.wait();
+    }
+
+    for (auto&& e : errors)
+        if (e)
+            rethrow_exception(e);
+    return results;
+}
+
+// 分析 files 中相对 old 有变化的文件并记入 next，清理 old 中有而 next 中没有的输出，有变化时保存清单；
+// 重新解析的文件顺带把顶层类型记进 catalog
+static void applyChanges(const vector<fs::path>& files, const cli::Options& opt,
+                         const Manifest& old, Manifest& next, const fs::path& manifestPath, nslist::Catalog& catalog) {
+    auto todo = selectChanged(files, opt, old, next);
+    LOG_INFO("{} 个文件未变化，跳过；{} 个文件需要分析", files.size() - todo.size(), todo.size());
+
+    // 解析前先按内容哈希去重：内容相同的文件只分析一份，其余直接链接到那份输出。
+    // 与未变化文件相同的链接到已有输出，本批内重复的链接到本批第一个；哈希相同还要逐字节比对才算
+    vector<uint64_t> hashes(todo.size());
+    set<string> pending;
+    for (size_t i = 0; i < todo.size(); ++i) {
+        auto key = Manifest::keyFor(todo[i], opt.inputDir);
+        hashes[i] = next.find(key)->hash;
+        pending.insert(std::move(key));
+    }
+    unordered_multimap<uint64_t, fs::path> known;
+    for (auto&& [key, e] : next.entries())
+        if (e.hash && !pending.contains(key))
+            known.emplace(e.hash, opt.inputDir / fs::path(u8string(key.begin(), key.end())));
+
+    vector<fs::path> unique;
+    vector<pair<size_t, fs::path>> links;      // 待链接的 todo 下标与内容相同的源文件
+    unordered_multimap<uint64_t, size_t> first;
+    for (size_t i = 0; i < todo.size(); ++i) {
+        auto sameAs = [&](const fs::path& other) { return IOUtils::same_content(other, todo[i]); };
+        const fs::path* source = nullptr;
+        for (auto [it, end] = known.equal_range(hashes[i]); !source && it != end; ++it)
+            if (fs::exists(IOUtils::make_output_path(it->second, opt.inputDir, opt.outputDir)) && sameAs(it->second))
+                source = &it->second;
+        for (auto [it, end] = first.equal_range(hashes[i]); !source && it != end; ++it)
+            if (sameAs(todo[it->second]))
+                source = &todo[it->second];
+        if (source) {
+            links.emplace_back(i, *source);
+            continue;
+        }
+        first.emplace(hashes[i], i);
+        unique.push_back(todo[i]);
+    }
+
+    // 写出放在后台线程，等全部落盘后再按原顺序汇报，日志与串行一致
+    vector<FileResult> results;
+    IOUtils::AsyncWriter writer;
+    if (opt.jobs > 1 && unique.size() > 1)
+        results = processParallel(unique, opt, writer);
+    else {
+        for (const auto& file : unique) {
+            BENCH_SCOPE("处理文件", file.filename().string());
+
+            results.push_back(processFile(file, opt, writer));
+        }
+    }
+    auto stats = writer.flush();
+    for (size_t j = 0; j < results.size(); ++j) {
+        LOG_INFO("→ 已写入 {}", results[j].outPath.string());
+        catalog.set(Manifest::keyFor(unique[j], opt.inputDir), std::move(results[j].types));
+    }
+    if (stats.unchanged)
+        LOG_INFO("{} 个输出内容未变，未重写", stats.unchanged);
+
+    // 源输出已经落盘，重复的文件直接链接过去
+    size_t copied = 0;
+    for (auto&& [i, source] : links) {
+        auto outPath = IOUtils::make_output_path(todo[i], opt.inputDir, opt.outputDir);
+        copied += !IOUtils::link_or_copy(IOUtils::make_output_path(source, opt.inputDir, opt.outputDir), outPath);
+        LOG_INFO("→ 已链接 {}（内容与 {} 相同）", outPath.string(), source.filename().string());
+        if (auto* types = catalog.find(Manifest::keyFor(source, opt.inputDir)))
+            catalog.set(Manifest::keyFor(todo[i], opt.inputDir), *types);
+    }
+    if (!links.empty())
+        LOG_INFO("{} 个文件与其他文件内容相同，未重复分析{}", links.size(),
+                 copied ? std::format("（{} 个不支持硬链接，已复制）", copied) : "");
+
+    removeOrphans(old, next, opt);
+    if (next.entries() != old.entries())
+        next.save(manifestPath);
+}
+
+// 解析 files 得到各自的符号，路径记为相对 root 的路径
+static vector<symidx::FileSymbols> collectAll(const vector<fs::path>& files, const fs::path& root, const cli::Options& opt) {
+    vector<symidx::FileSymbols> symbols(files.size());
+    auto collect = [&](size_t i) {
+        IOUtils::MappedFile mapped(files[i]);
+        auto info = parseFile(mapped.view(), files[i], opt);
+        symbols[i] = symidx::collectSymbols(Manifest::keyFor(files[i], root), info);
+    };
+
+    // 内容相同的文件只解析一份，其余复制符号后换上自己的路径
+    vector<size_t> unique, sourceOf(files.size());
+    unordered_multimap<uint64_t, size_t> first;
+    for (size_t i = 0; i < files.size(); ++i) {
+        auto h = IOUtils::hash_bytes(IOUtils::MappedFile(files[i]).view());
+        sourceOf[i] = i;
+        for (auto [it, end] = first.equal_range(h); it != end; ++it) {
+            if (IOUtils::same_content(files[it->second], files[i])) {
+                sourceOf[i] = it->second;
+                break;
+            }
+        }
+        if (sourceOf[i] == i) {
+            first.emplace(h, i);
+            unique.push_back(i);
+        }
+    }
+
+    if (opt.jobs > 1 && unique.size() > 1) {
+        vector<exception_ptr> errors(files.size());
+        ClassInfoView::warmUp(opt.regex ? Parser::Regex : Parser::Scanner);
+        ThreadPool pool(opt.jobs);
+        for (size_t i : unique) {
+            pool.submit([&, i] {
+                try {
+                    collect(i);
+                }
+                catch (...) {
+                    errors[i] = current_exception();
+                }
+            });
+        }
+        pool.wait();
+        for (auto&& e : errors)
+            if (e)
+                rethrow_exception(e);
+    }
+    else {
+        for (size_t i : unique)
+            collect(i);
+    }
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (sourceOf[i] != i) {
+            symbols[i] = symbols[sourceOf[i]];
+            symbols[i].path = Manifest::keyFor(files[i], root);
+        }
+    }
+    return symbols;
+}
+
+// 按路径顺序汇总各文件的符号并写出 <输出目录>.idx，索引内容与线程数、分片方式无关
+static void buildIndex(vector<symidx::FileSymbols>& symbols, const cli::Options& opt) {
+    ranges::sort(symbols, {}, &symidx::FileSymbols::path);
+    symidx::IndexBuilder builder;
+    for (auto&& file : symbols)
+        builder.add(file);
+    auto path = symidx::indexPathFor(opt.outputDir);
+    builder.write(path);
+    LOG_INFO("→ 符号索引 {} 个类型、{} 个成员、{} 个被引用类型名，已写入 {}",
+             builder.typeCount(), builder.memberCount(), builder.usageCount(), path.string());
+}
+
+// 解析 files 并写出 <输出目录>.idx
+static void writeIndex(const vector<fs::path>& files, const cli::Options& opt) {
+    BENCH_SCOPE("生成符号索引");
+    auto symbols = collectAll(files, opt.inputDir, opt);
+    buildIndex(symbols, opt);
+}
+
+// 重新解析全部输入生成符号索引；索引要覆盖未变化的文件，因此不走增量清单，只在清单有变化或索引缺失时重建
+static void updateIndex(const vector<fs::path>& files, const cli::Options& opt, const Manifest& old, const Manifest& next) {
+    if (!opt.index || (next.entries() == old.entries() && fs::exists(symidx::indexPathFor(opt.outputDir))))
+        return;
+    writeIndex(files, opt);
+}
+
+// 命名空间列表的组：相对路径的第一层目录，直接放在输入目录下的文件归入以输入目录命名的组
+static string groupOf(const string& key, const cli::Options& opt) {
+    if (auto slash = key.find('/'); slash != string::npos)
+        return key.substr(0, slash);
+    auto root = fs::absolute(opt.inputDir).lexically_normal();
+    if (!root.has_filename())
+        root = root.parent_path();
+    return root.filename().string();
+}
+
+// 按清单里的全部文件汇总命名空间列表；目录里缺记录的文件（如首次开启或目录失效）补解析一次，
+// 源文件已删除的记录一并去掉，不再有文件的组删除其列表
+static void updateListings(const cli::Options& opt, const Manifest& manifest, nslist::Catalog& catalog) {
+    if (!opt.listsNamespaces())
+        return;
+    BENCH_SCOPE("命名空间列表");
+    vector<string> removed;
+    set<string> staleGroups;
+    for (auto&& [key, types] : catalog.entries()) {
+        if (!manifest.find(key)) {
+            removed.push_back(key);
+            staleGroups.insert(groupOf(key, opt));
+        }
+    }
+    for (auto&& key : removed)
+        catalog.erase(key);
+
+    size_t parsed = 0;
+    map<string, vector<nslist::TypeName>> groups;
+    for (auto&& [key, e] : manifest.entries()) {
+        const auto* types = catalog.find(key);
+        if (!types) {
+            auto file = opt.inputDir / fs::path(u8string(key.begin(), key.end()));
+            IOUtils::MappedFile mapped(file);
+            catalog.set(key, nslist::collectTypes(parseFile(mapped.view(), file, opt)));
+            types = catalog.find(key);
+            ++parsed;
+        }
+        auto& group = groups[groupOf(key, opt)];
+        group.insert(group.end(), types->begin(), types->end());
+    }
+    if (parsed)
+        LOG_INFO("补充解析了 {} 个文件的类型记录", parsed);
+
+    // 分片只留类型目录，列表由 merge 汇总全部分片后生成
+    if (opt.shardCount) {
+        catalog.save(nslist::Catalog::pathFor(opt.outputDir));
+        LOG_INFO("→ {} 个文件的类型记录已写入 {}", catalog.entries().size(), nslist::Catalog::pathFor(opt.outputDir).string());
+        return;
+    }
+
+    nslist::Filter filter{ opt.namespaceFilters, opt.namespaceDepth, opt.rootDepth, opt.namespaceAllKinds };
+    auto written = nslist::writeListings(groups, filter, opt.namespaceDir, opt.rootNamespaceDir);
+    for (auto&& group : staleGroups) {
+        if (groups.contains(group))
+            continue;
+        for (auto&& dir : { opt.namespaceDir, opt.rootNamespaceDir }) {
+            error_code ec;
+            if (!dir.empty() && fs::remove(dir / (group + ".txt"), ec))
+                LOG_INFO("× 已删除 {}", (dir / (group + ".txt")).string());
+        }
+    }
+    catalog.save(nslist::Catalog::pathFor(opt.outputDir));
+    LOG_INFO("→ 命名空间列表 {} 组，{} 个文件有更新", groups.size(), written);
+}
 
-        string code = IOUtils::read_file(file);
+// 扫描整个输入目录做一轮增量分析，返回新的清单
+static Manifest fullPass(const cli::Options& opt, const Manifest& old, const fs::path& manifestPath, nslist::Catalog& catalog) {
+    LOG_INFO("正在扫描 {}", opt.inputDir.string());
+    auto files = IOUtils::list_files(opt.inputDir, opt.extension);
 
-        ClassInfo info(code);
+    LOG_INFO("共发现 {} 个文件", files.size());
+    shard::Summary summary;
+    if (opt.shardCount)
+        files = selectShard(files, opt, old.stamp(), summary);
+
+    Manifest next(old.stamp());
+    applyChanges(files, opt, old, next, manifestPath, catalog);
+    updateIndex(files, opt, old, next);
+    updateListings(opt, next, catalog);
+    if (opt.shardCount)
+        summary.save(shard::Summary::pathFor(opt.outputDir));
+    return next;
+}
+
+// 监视模式常驻的各文件符号（按路径排序），先取现有索引，与清单对不上时重新解析全部文件
+static vector<symidx::FileSymbols> loadSymbols(const cli::Options& opt, const Manifest& manifest) {
+    auto path = symidx::indexPathFor(opt.outputDir);
+    error_code ec;
+    if (fs::exists(path, ec)) {
+        try {
+            auto symbols = symidx::readSymbols(symidx::SymbolIndex(path));
+            if (symbols.size() == manifest.entries().size() && ranges::all_of(symbols, [&](auto&& f) { return manifest.find(f.path); })) {
+                ranges::sort(symbols, {}, &symidx::FileSymbols::path);
+                return symbols;
+            }
+        }
+        catch (const exception& e) {
+            LOG_WARN("无法读取符号索引（{}），重新解析", e.what());
+        }
+    }
+    vector<fs::path> files;
+    for (auto&& [key, e] : manifest.entries())
+        files.push_back(opt.inputDir / fs::path(u8string(key.begin(), key.end())));
+    auto symbols = collectAll(files, opt.inputDir, opt);
+    buildIndex(symbols, opt);
+    return symbols;
+}
+
+// 只重新解析内容哈希相对 old 有变化的文件，替换常驻符号中对应的记录后重建索引
+static void refreshSymbols(vector<symidx::FileSymbols>& symbols, const cli::Options& opt, const Manifest& old, const Manifest& next) {
+    set<string> stale;
+    vector<fs::path> changed;
+    for (auto&& [key, e] : old.entries())
+        if (!next.find(key))
+            stale.insert(key);
+    for (auto&& [key, e] : next.entries()) {
+        const auto* prev = old.find(key);
+        if (!prev || prev->hash != e.hash) {
+            stale.insert(key);
+            changed.push_back(opt.inputDir / fs::path(u8string(key.begin(), key.end())));
+        }
+    }
+    if (stale.empty() && fs::exists(symidx::indexPathFor(opt.outputDir)))
+        return;
+
+    BENCH_SCOPE("生成符号索引");
+    erase_if(symbols, [&](const symidx::FileSymbols& f) { return stale.contains(f.path); });
+    ranges::move(collectAll(changed, opt.inputDir, opt), back_inserter(symbols));
+    buildIndex(symbols, opt);
+}
+
+// 常驻监视输入目录，文件写完（安静 debounce 毫秒）后只重新分析变化的部分；单批出错只记录，不退出。
+// watcher 在首轮分析之前就已建好，首轮扫描之后才写完的文件留在第一批里处理
+[[noreturn]] static void watchLoop(const cli::Options& opt, DirWatcher& watcher, Manifest& manifest, const fs::path& manifestPath, nslist::Catalog& catalog) {
+    ClassInfoView::warmUp(opt.regex ? Parser::Regex : Parser::Scanner);
+    vector<symidx::FileSymbols> symbols;
+    if (opt.index)
+        symbols = loadSymbols(opt, manifest);
+    LOG_INFO("正在监视 {}，按 Ctrl+C 退出", opt.inputDir.string());
+
+    while (true) {
+        auto batch = watcher.wait();
+        try {
+            BENCH_SCOPE("本批耗时");
+            if (batch.rescan) {
+                LOG_WARN("监视事件不完整，重新比对整个输入目录");
+                manifest = fullPass(opt, manifest, manifestPath, catalog);
+                if (opt.index)
+                    symbols = loadSymbols(opt, manifest);
+                continue;
+            }
+
+            Manifest next = manifest;
+            vector<fs::path> changed;
+            for (auto&& c : batch.changes) {
+                error_code ec;
+                if (c.removed || !fs::is_regular_file(c.path, ec))
+                    next.erase(Manifest::keyFor(c.path, opt.inputDir));
+                else
+                    changed.push_back(c.path);
+            }
+            applyChanges(changed, opt, manifest, next, manifestPath, catalog);
+            if (opt.index)
+                refreshSymbols(symbols, opt, manifest, next);
+            updateListings(opt, next, catalog);
+            writeRegexStats(opt);
+            manifest = std::move(next);
+        }
+        catch (const exception& e) {
+            LOG_ERROR("错误: {}\n", e.what());
+        }
+    }
+}
+
+// query 子命令：映射 <输出目录>.idx 查找符号，结果写到标准输出
+static int runQuery(const cli::Options& opt) {
+    symidx::SymbolIndex index(symidx::indexPathFor(opt.outputDir));
+    string out;
+    auto line = [&](uint32_t s) {
+        std::format_to(back_inserter(out), "{:<9}{}  ->  {}  ({})\n", symidx::kindName(index.kindOf(s)),
+                       index.describe(s), index.fullName(s), index.fileOf(s));
+    };
+
+    size_t count = 0;
+    {
+        BENCH_SCOPE("查询");
+        switch (opt.queryMode) {
+        case cli::QueryMode::Symbols:
+            if (opt.queryPrefix) {
+                for (auto s : index.prefix(opt.query))
+                    line(s), ++count;
+            }
+            else {
+                for (auto s : index.find(opt.query))
+                    line(s), ++count;
+            }
+            break;
+        case cli::QueryMode::Members:
+            for (auto s : index.find(opt.query)) {
+                if (symidx::SymbolIndex::isMember(s))
+                    continue;
+                line(s), ++count;
+                auto first = index.type(s).firstMember;
+                for (uint32_t m = 0; m < index.members(s).size(); ++m)
+                    line((first + m) | symidx::MemberBit), ++count;
+            }
+            break;
+        case cli::QueryMode::Uses:
+            if (opt.queryPrefix) {
+                for (auto&& u : index.usages(opt.query)) {
+                    std::format_to(back_inserter(out), "{}：{} 处引用\n", index.str(u.name), u.count);
+                    for (auto s : index.postings(u))
+                        out += "    ", line(s), ++count;
+                }
+            }
+            else {
+                for (auto s : index.uses(opt.query))
+                    line(s), ++count;
+            }
+            break;
+        }
+    }
+    cout << out;
+    if (count == 0)
+        LOG_WARN("没有找到：{}", opt.query);
+    return count == 0 ? 1 : 0;
+}
+
+// bench 子命令：生成合成语料（可选再回放输入目录），逐项测量后把结果表写到标准输出
+static int runBench(const cli::Options& opt) {
+    bench::CorpusSpec spec{ size_t{ opt.benchSize } * 1024, opt.benchMix, opt.benchDepth, opt.benchBody, opt.benchSeed };
+    vector<string> corpus{ bench::generateCorpus(spec) };
+    LOG_INFO("合成语料 {} 字节：泛型深度 {}，成员体 {} 行，方法/字段/属性/常量/事件比例 {}:{}:{}:{}:{}", corpus[0].size(),
+             spec.genericDepth, spec.bodyLines, spec.mix[0], spec.mix[1], spec.mix[2], spec.mix[3], spec.mix[4]);
+    cout << std::format("== 合成语料（{} KB）==\n", corpus[0].size() / 1024)
+         << bench::report(bench::runSuite(corpus, opt.benchReps)) << bench::footprint(corpus);
+
+    if (opt.benchReplay) {
+        vector<string> texts;
+        size_t bytes = 0;
+        for (auto&& file : IOUtils::list_files(opt.inputDir, opt.extension)) {
+            texts.push_back(IOUtils::read_file(file));
+            bytes += texts.back().size();
+        }
+        cout << std::format("== {}（{} 个文件，{} KB）==\n", opt.inputDir.string(), texts.size(), bytes / 1024)
+             << bench::report(bench::runSuite(texts, opt.benchReps)) << bench::footprint(texts);
+    }
+    return 0;
+}
+
+// dll 子命令：每个程序集输出到 <输出目录>/<程序集名>/<命名空间各段>/<类型>.out.txt，
+// 内容未变的不重写，程序集里已不存在的类型对应的旧输出一并删除
+static int runMetadata(const cli::Options& opt) {
+    BENCH_SCOPE("读取程序集");
+    vector<fs::path> dlls;
+    for (auto&& p : opt.assemblies) {
+        if (fs::is_directory(p)) {
+            auto found = IOUtils::list_files<false>(p, ".dll");
+            ranges::sort(found);
+            dlls.insert(dlls.end(), found.begin(), found.end());
+        }
+        else
+            dlls.push_back(p);
+    }
 
-        string result = std::format("{}", info);
+    IOUtils::AsyncWriter writer;
+    vector<pair<fs::path, set<fs::path>>> produced;        // 程序集输出目录与其中本次写出的文件
+    map<string, vector<nslist::TypeName>> groups;           // 程序集名 -> 顶层类型
+    size_t types = 0;
+    for (auto&& dll : dlls) {
+        BENCH_SCOPE("读取程序集", dll.filename().string());
+        clr::Metadata md(dll);
+        clr::Describer describer(md);
+        auto root = opt.outputDir / describer.assemblyName();
+        auto& [dir, files] = produced.emplace_back(root, set<fs::path>{});
+        for (auto&& t : describer.types()) {
+            string text = writer.acquire();
+            text.reserve(std::formatter<ClassInfo>::sizeHint(t.info));
+            std::format_to(back_inserter(text), "{}", t.info);
+            auto outPath = root / t.path;
+            files.insert(outPath);
+            writer.submit(outPath, std::move(text));
+            auto listed = nslist::collectTypes(t.info);
+            auto& group = groups[describer.assemblyName()];
+            group.insert(group.end(), listed.begin(), listed.end());
+        }
+        types += files.size();
+        LOG_INFO("{}：{} 个类型 → {}", dll.filename().string(), files.size(), root.string());
+    }
+    auto stats = writer.flush();
+    LOG_INFO("共 {} 个类型，写出 {} 个，{} 个内容未变", types, stats.written, stats.unchanged);
+    if (opt.listsNamespaces()) {
+        nslist::Filter filter{ opt.namespaceFilters, opt.namespaceDepth, opt.rootDepth, opt.namespaceAllKinds };
+        auto written = nslist::writeListings(groups, filter, opt.namespaceDir, opt.rootNamespaceDir);
+        LOG_INFO("→ 命名空间列表 {} 组，{} 个文件有更新", groups.size(), written);
+    }
 
-        auto outPath = IOUtils::make_output_path(file, inputDir, outputDir);
-        IOUtils::write_file(outPath, result);
+    for (auto&& [dir, files] : produced) {
+        if (!fs::exists(dir))
+            continue;
+        for (auto&& stale : IOUtils::list_files(dir, ".txt")) {
+            if (!stale.filename().string().ends_with(".out.txt") || files.contains(stale))
+                continue;
+            error_code ec;
+            if (fs::remove(stale, ec))
+                LOG_INFO("× 已删除 {}", stale.string());
+        }
+    }
+    return 0;
+}
+
+// 解析 files 收入常驻语料，路径记为相对 root 的路径；各文件的映射在收入后即释放
+static void loadCorpus(apistore::Corpus& corpus, const vector<fs::path>& files, const fs::path& root, const cli::Options& opt) {
+    auto add = [&](const fs::path& file) {
+        IOUtils::MappedFile mapped(file);
+        corpus.add(Manifest::keyFor(file, root), parseFile(mapped.view(), file, opt));
+    };
+    if (opt.jobs <= 1 || files.size() <= 1) {
+        for (auto&& file : files)
+            add(file);
+        return;
+    }
+    vector<exception_ptr> errors(files.size());
+    ClassInfoView::warmUp(opt.regex ? Parser::Regex : Parser::Scanner);
+    ThreadPool pool(opt.jobs);
+    for (size_t i = 0; i < files.size(); ++i) {
+        pool.submit([&, i] {
+            try {
+                add(files[i]);
+            }
+            catch (...) {
+                errors[i] = current_exception();
+            }
+        });
+    }
+    pool.wait();
+    for (auto&& e : errors)
+        if (e)
+            rethrow_exception(e);
+}
 
-        LOG_INFO("→ 已写入 {}", outPath.string());
+// diff 的一侧：索引文件、旁边带索引的输出目录，或者当场解析的源码目录
+static apidiff::ApiSet loadApi(const fs::path& side, const cli::Options& opt) {
+    BENCH_SCOPE("读入", side.string());
+    auto index = fs::is_directory(side) ? symidx::indexPathFor(side) : side;
+    if (fs::is_regular_file(index)) {
+        auto api = apidiff::ApiSet::fromIndex(symidx::SymbolIndex(index));
+        LOG_INFO("{}：索引中 {} 个类型、{} 个成员", index.string(), api.types().size(), api.memberCount());
+        return api;
     }
+    auto files = IOUtils::list_files(side, opt.extension);
+    if (files.empty())
+        throw runtime_error(std::format("{} 既不是索引，也没有 {} 文件", side.string(), opt.extension));
+    ranges::sort(files);
+    apistore::Corpus corpus;
+    loadCorpus(corpus, files, side, opt);
+    auto fp = corpus.footprint();
+    LOG_INFO("{}：解析 {} 个文件，{} 个类型、{} 个成员，常驻 {} KB（{} 个不同字符串）", side.string(), files.size(),
+             corpus.typeCount(), corpus.memberCount(), fp.liveBytes / 1024, fp.strings);
+    return apidiff::ApiSet::fromCorpus(corpus);
+}
+
+// diff 子命令：逐类型比较两个版本的成员签名，人读的报告写到标准输出，--json 另写机读报告
+static int runDiff(const cli::Options& opt) {
+    auto before = loadApi(opt.diffSides[0], opt);
+    auto after = loadApi(opt.diffSides[1], opt);
+    apidiff::Changelog log;
+    {
+        BENCH_SCOPE("比较");
+        log = apidiff::diff(before, after, opt.jobs);
+    }
+    cout << apidiff::textReport(log);
+    if (!opt.jsonFile.empty()) {
+        IOUtils::write_file(opt.jsonFile, apidiff::jsonReport(log, opt.diffSides[0].generic_string(), opt.diffSides[1].generic_string()));
+        LOG_INFO("→ JSON 报告已写入 {}", opt.jsonFile.string());
+    }
+    return 0;
+}
+
+// --format ndjson：按相对路径顺序把全部文件写成一条 NDJSON 流，不走增量清单。
+// 工作线程把各文件的记录序列化进环形槽位里复用的缓冲区，主线程按顺序写出；
+// 在途的文件不超过线程数的 4 倍，内存占用与语料大小无关
+static int runNdjson(const cli::Options& opt) {
+    auto files = IOUtils::list_files(opt.inputDir, opt.extension);
+    shard::Summary summary;
+    if (opt.shardCount)
+        files = selectShard(files, opt, 0, summary);
+    vector<string> keys(files.size());
+    vector<size_t> order(files.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        keys[i] = Manifest::keyFor(files[i], opt.inputDir);
+        order[i] = i;
+    }
+    ranges::sort(order, {}, [&](size_t i) -> const string& { return keys[i]; });
+
+    struct Slot {
+        string text;
+        bool done = false;
+        exception_ptr error;
+    };
+    const size_t window = static_cast<size_t>(max(opt.jobs, 1u)) * 4;
+    vector<Slot> slots(window);
+    mutex m;
+    condition_variable cv;
+    auto serialize = [&](size_t i, Slot& slot) {
+        try {
+            thread_local string scope;
+            IOUtils::MappedFile mapped(files[i]);
+            auto info = parseFile(mapped.view(), files[i], opt);
+            slot.text.clear();
+            ndjson::Writer(slot.text, scope).file(keys[i], info);
+        }
+        catch (...) {
+            slot.error = current_exception();
+        }
+    };
+
+    ndjson::Sink sink(opt.outputDir);
+    size_t records = 0;
+    auto emit = [&](Slot& slot) {
+        if (slot.error)
+            rethrow_exception(exchange(slot.error, nullptr));
+        records += static_cast<size_t>(ranges::count(slot.text, '\n'));
+        sink.write(slot.text);
+    };
+
+    BENCH_SCOPE("NDJSON");
+    if (opt.jobs <= 1 || files.size() <= 1) {
+        for (size_t i : order) {
+            serialize(i, slots[0]);
+            emit(slots[0]);
+        }
+    }
+    else {
+        ClassInfoView::warmUp(opt.regex ? Parser::Regex : Parser::Scanner);
+        ThreadPool pool(opt.jobs);
+        size_t submitted = 0;
+        for (size_t next = 0; next < order.size(); ++next) {
+            // 槽位 submitted % window 上一次的文件已经写出，可以复用
+            for (; submitted < order.size() && submitted < next + window; ++submitted) {
+                auto& slot = slots[submitted % window];
+                {
+                    lock_guard lock(m);
+                    slot.done = false;
+                }
+                pool.submit([&, i = order[submitted]] {
+                    serialize(i, slot);
+                    {
+                        lock_guard lock(m);
+                        slot.done = true;
+                    }
+                    cv.notify_all();
+                });
+            }
+            auto& slot = slots[next % window];
+            {
+                unique_lock lock(m);
+                cv.wait(lock, [&] { return slot.done; });
+            }
+            emit(slot);
+        }
+    }
+    sink.flush();
+    if (opt.shardCount)
+        summary.save(shard::Summary::pathFor(opt.outputDir));
+    writeRegexStats(opt);
+    LOG_INFO("→ {} 个文件、{} 条记录已写入 {}", files.size(), records, opt.outputDir == "-" ? "标准输出" : opt.outputDir.string());
+    return 0;
+}
+
+// serve 子命令：解析输入目录后常驻内存，经本地套接字回答查询；文件变化时（或收到 reload）只重新解析变了的部分
+static int runServe(const cli::Options& opt) {
+    auto socketPath = opt.socketPath.empty() ? serve::socketPathFor(opt.inputDir) : opt.socketPath;
+    serve::Listener listener(socketPath);
+
+    ClassInfo::warmUp(opt.regex ? Parser::Regex : Parser::Scanner);
+    serve::Store::Parse parse = [&](string_view text) {
+        return opt.regex ? ClassInfo(text, Parser::Regex, RegexBudget{ opt.regexWindow, chrono::milliseconds(opt.regexBudget) })
+                         : ClassInfo(text);
+    };
+    serve::Store store;
+    mutex reloading;       // 监视线程与 reload 请求不同时比对
+    auto reload = [&] {
+        lock_guard lock(reloading);
+        return store.sync(IOUtils::list_files(opt.inputDir, opt.extension), opt.inputDir, parse, opt.jobs);
+    };
+
+    // 先开始监视再载入，载入时列出文件之后才写完的文件由监视线程补上；监视不可用的平台上只能靠 reload 请求重新比对
+    shared_ptr<DirWatcher> dir;
+    try {
+        dir = make_shared<DirWatcher>(opt.inputDir, opt.extension, chrono::milliseconds(opt.debounce));
+    }
+    catch (const exception& e) {
+        LOG_WARN("无法监视输入目录（{}），文件变化后请发送 reload", e.what());
+    }
+    {
+        BENCH_SCOPE("载入");
+        reload();
+    }
+    auto counts = store.counts();
+    LOG_INFO("已载入 {} 个文件、{} 个类型、{} 个成员", counts.files, counts.types, counts.members);
+
+    jthread watcher;
+    if (dir) {
+        watcher = jthread([&, dir] {
+            while (true) {
+                auto batch = dir->wait();
+                try {
+                    lock_guard lock(reloading);
+                    size_t n;
+                    if (batch.rescan)
+                        n = store.sync(IOUtils::list_files(opt.inputDir, opt.extension), opt.inputDir, parse, opt.jobs);
+                    else {
+                        vector<fs::path> changed, removed;
+                        for (auto&& c : batch.changes)
+                            (c.removed ? removed : changed).push_back(c.path);
+                        n = store.update(changed, removed, opt.inputDir, parse, opt.jobs);
+                    }
+                    LOG_INFO("已重新载入 {} 个文件", n);
+                }
+                catch (const exception& e) {
+                    LOG_ERROR("重新载入失败: {}", e.what());
+                }
+            }
+        });
+    }
+
+    LOG_INFO("正在监听 {}，按 Ctrl+C 退出", listener.path().string());
+    function<size_t()> onReload = reload;
+    serve::run(listener, store, onReload);
+}
+
+// client 子命令：发一条请求，回应原样写到标准输出；回应为错误时返回 1
+static int runClient(const cli::Options& opt) {
+    auto conn = serve::Connection::connect(opt.socketPath.empty() ? serve::socketPathFor(opt.inputDir) : opt.socketPath);
+    conn.writeLine(opt.request);
+    string reply;
+    if (!conn.readLine(reply, SIZE_MAX))
+        throw runtime_error("服务端未回应就关闭了连接");
+    cout << reply << '\n';
+    return reply.starts_with("{\"ok\":true") ? 0 : 1;
+}
+
+// merge 子命令：核对各分片的摘要，把输出链接进 -o，合并清单、类型目录与索引，结果与单机运行相同。
+// -i 与 --namespaces 等选项应与单机运行时一致：清单版本戳与直接放在输入目录下的文件所属的组都取决于它们
+static int runMerge(const cli::Options& opt) {
+    auto outputs = opt.shardOutputs;
+    vector<shard::Summary> parts;
+    for (auto&& o : outputs)
+        parts.push_back(shard::Summary::load(shard::Summary::pathFor(o)));
+    shard::verify(parts, outputs, configStamp(parts.front().mode));
+
+    BENCH_SCOPE("合并");
+    if (opt.format == cli::Format::Ndjson) {
+        ndjson::Sink sink(opt.outputDir);
+        auto records = ndjson::merge(outputs, sink);
+        sink.flush();
+        LOG_INFO("→ {} 个分片、{} 条记录已写入 {}", parts.size(), records, opt.outputDir == "-" ? "标准输出" : opt.outputDir.string());
+        return 0;
+    }
+
+    auto stamp = manifestStamp(parts.front().mode, opt.inputDir);
+    auto manifestPath = Manifest::pathFor(opt.outputDir);
+    auto old = Manifest::load(manifestPath, stamp);
+    Manifest next(stamp);
+    auto catalog = opt.listsNamespaces() ? nslist::Catalog::load(nslist::Catalog::pathFor(opt.outputDir), stamp) : nslist::Catalog(stamp);
+    vector<symidx::FileSymbols> symbols;
+    size_t copied = 0;
+    for (size_t k = 0; k < parts.size(); ++k) {
+        const auto& dir = outputs[k];
+        auto part = Manifest::load(Manifest::pathFor(dir), parts[k].stamp);
+        for (auto&& [key, e] : part.entries()) {
+            if (next.find(key))
+                throw runtime_error(std::format("{} 同时出现在多个分片中", key));
+            next.set(key, e);
+            auto file = opt.inputDir / fs::path(u8string(key.begin(), key.end()));
+            auto src = IOUtils::make_output_path(file, opt.inputDir, dir);
+            if (!fs::exists(src))
+                throw runtime_error(std::format("分片 {} 缺少输出 {}", dir.string(), src.string()));
+            copied += !IOUtils::link_or_copy(src, IOUtils::make_output_path(file, opt.inputDir, opt.outputDir));
+        }
+
+        if (opt.listsNamespaces()) {
+            auto types = nslist::Catalog::load(nslist::Catalog::pathFor(dir), parts[k].stamp);
+            for (auto&& [key, e] : part.entries()) {
+                const auto* t = types.find(key);
+                if (!t)
+                    throw runtime_error(std::format("分片 {} 没有 {} 的类型记录，分片运行时需要加 --namespaces", dir.string(), key));
+                catalog.set(key, *t);
+            }
+        }
+        if (opt.index) {
+            auto path = symidx::indexPathFor(dir);
+            if (!fs::exists(path))
+                throw runtime_error(std::format("分片 {} 没有符号索引，分片运行时需要加 --index", dir.string()));
+            auto files = symidx::readSymbols(symidx::SymbolIndex(path));
+            if (files.size() != part.entries().size() || ranges::any_of(files, [&](auto&& f) { return !part.find(f.path); }))
+                throw runtime_error(std::format("分片 {} 的符号索引与清单不符，请重新运行该分片", dir.string()));
+            ranges::move(files, back_inserter(symbols));
+        }
+    }
+    if (next.entries().size() != parts.front().files)
+        throw runtime_error(std::format("各分片合计 {} 个文件，与输入目录的 {} 个不符", next.entries().size(), parts.front().files));
+    LOG_INFO("已合并 {} 个分片、{} 个文件的输出{}", parts.size(), next.entries().size(),
+             copied ? std::format("（{} 个不支持硬链接，已复制）", copied) : "");
+
+    removeOrphans(old, next, opt);
+    if (next.entries() != old.entries())
+        next.save(manifestPath);
+    if (opt.index)
+        buildIndex(symbols, opt);
+    updateListings(opt, next, catalog);
+    return 0;
+}
+
+int main(int argc, char* argv[]) try {
+    auto opt = cli::parse(argc, argv);
+    if (opt.command == cli::Command::Query)
+        return runQuery(opt);
+    if (opt.command == cli::Command::Bench)
+        return runBench(opt);
+    if (opt.command == cli::Command::Metadata)
+        return runMetadata(opt);
+    if (opt.command == cli::Command::Diff)
+        return runDiff(opt);
+    if (opt.command == cli::Command::Serve)
+        return runServe(opt);
+    if (opt.command == cli::Command::Client)
+        return runClient(opt);
+    if (opt.command == cli::Command::Merge)
+        return runMerge(opt);
+    if (opt.format == cli::Format::Ndjson)
+        return runNdjson(opt);
+
+    LOG_DEBUG("ClassLike: {}", ClassLike::getBuilder().pattern);
+    LOG_DEBUG("   Method: {}",    Method::getBuilder().pattern);
+    LOG_DEBUG("    Field: {}",     Field::getBuilder().pattern);
+    LOG_DEBUG(" Property: {}",  Property::getBuilder().pattern);
+    LOG_DEBUG(" Constant: {}",  Constant::getBuilder().pattern);
+    LOG_DEBUG("    Event: {}",     Event::getBuilder().pattern);
+
+    // 版本戳覆盖工具版本、匹配规则、解析方式（含正则路径的窗口上限）与输入目录，任一变化都重新全量分析
+    auto stamp = manifestStamp(parseMode(opt), opt.inputDir);
+    auto manifestPath = Manifest::pathFor(opt.outputDir);
+    auto manifest = Manifest::load(manifestPath, stamp);
+    auto catalog = opt.listsNamespaces() ? nslist::Catalog::load(nslist::Catalog::pathFor(opt.outputDir), stamp) : nslist::Catalog(stamp);
+
+    // 先开始监视再做首轮分析，首轮列出文件之后才写完的文件也会留下事件
+    unique_ptr<DirWatcher> watcher;
+    if (opt.watch)
+        watcher = make_unique<DirWatcher>(opt.inputDir, opt.extension, chrono::milliseconds(opt.debounce));
+
+    if (opt.profile)
+        bench::Profiler::instance().enable();
+    {
+        BENCH_SCOPE("总耗时");
+        manifest = fullPass(opt, manifest, manifestPath, catalog);
+    }
+    writeRegexStats(opt);
+    if (opt.profile) {
+        auto& profiler = bench::Profiler::instance();
+        cout << profiler.summary();
+        if (!opt.traceFile.empty()) {
+            IOUtils::write_file(opt.traceFile, profiler.chromeTrace());
+            LOG_INFO("→ 性能跟踪已写入 {}", opt.traceFile.string());
+        }
+        profiler.enable(false);     // 监视模式不再累积
+    }
+
+    if (opt.watch)
+        watchLoop(opt, *watcher, manifest, manifestPath, catalog);
 
     return 0;
 }
@@ -49,4 +1108,3 @@ catch (const exception& e) {
     LOG_ERROR("错误: {}\n", e.what());
     return 1;
 }
-
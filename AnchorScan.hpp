@@ -0,0 +1,166 @@
+#pragma once
+#include <string_view>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <bit>
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CS_ANCHOR_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CS_ANCHOR_SSE2 1
+#endif
+
+#include "CsScanner.hpp"
+#include "RegexBuilder.hpp"
+
+// 正则路径的预筛：各条规则都以“关键字 + 空白”开头（Constant 还允许 const 前有空白），
+// 所以先用 SIMD 找出“空白且往前若干字节是某个候选关键字首字母”的位置，再逐个核对关键字，
+// 得到的起点窗口交给 searchAnchored，正则只在这些位置上尝试
+namespace cs {
+
+    namespace detail {
+        inline constexpr std::string_view AnchorWords[] = {
+            "new", "public", "protected", "internal", "private", "static", "virtual", "sealed", "override",
+            "abstract", "extern", "readonly", "unsafe", "volatile", "const", "namespace",
+        };
+        inline constexpr std::size_t MaxAnchorWord = 9;
+
+        // 同一长度的关键字首字母，向量比较时按长度各读一次
+        struct AnchorProbe {
+            std::size_t length = 0;
+            std::array<char, 8> letters{};
+            std::size_t count = 0;
+        };
+
+        struct AnchorProbes {
+            std::array<AnchorProbe, MaxAnchorWord + 1> byLength{};
+            std::size_t count = 0;
+        };
+
+        constexpr AnchorProbes anchorProbes(std::uint32_t mask) noexcept {
+            std::array<AnchorProbe, MaxAnchorWord + 1> table{};
+            for (auto w : AnchorWords) {
+                if (!(keyword(w) & mask))
+                    continue;
+                auto& p = table[w.size()];
+                p.length = w.size();
+                if (std::find(p.letters.begin(), p.letters.begin() + p.count, w[0]) == p.letters.begin() + p.count)
+                    p.letters[p.count++] = w[0];
+            }
+            AnchorProbes out;
+            for (auto&& p : table)
+                if (p.count)
+                    out.byLength[out.count++] = p;
+            return out;
+        }
+
+#if defined(CS_ANCHOR_AVX2)
+        struct AnchorSimd {
+            using V = __m256i;
+            static constexpr std::size_t Width = 32;
+            static V load(const char* p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+            static V splat(char c) noexcept { return _mm256_set1_epi8(c); }
+            static V eq(V a, V b) noexcept { return _mm256_cmpeq_epi8(a, b); }
+            static V bor(V a, V b) noexcept { return _mm256_or_si256(a, b); }
+            static V band(V a, V b) noexcept { return _mm256_and_si256(a, b); }
+            static V sub(V a, V b) noexcept { return _mm256_sub_epi8(a, b); }
+            static V minu(V a, V b) noexcept { return _mm256_min_epu8(a, b); }
+            static V zero() noexcept { return _mm256_setzero_si256(); }
+            static std::uint32_t bits(V v) noexcept { return static_cast<std::uint32_t>(_mm256_movemask_epi8(v)); }
+        };
+#elif defined(CS_ANCHOR_SSE2)
+        struct AnchorSimd {
+            using V = __m128i;
+            static constexpr std::size_t Width = 16;
+            static V load(const char* p) noexcept { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+            static V splat(char c) noexcept { return _mm_set1_epi8(c); }
+            static V eq(V a, V b) noexcept { return _mm_cmpeq_epi8(a, b); }
+            static V bor(V a, V b) noexcept { return _mm_or_si128(a, b); }
+            static V band(V a, V b) noexcept { return _mm_and_si128(a, b); }
+            static V sub(V a, V b) noexcept { return _mm_sub_epi8(a, b); }
+            static V minu(V a, V b) noexcept { return _mm_min_epu8(a, b); }
+            static V zero() noexcept { return _mm_setzero_si128(); }
+            static std::uint32_t bits(V v) noexcept { return static_cast<std::uint32_t>(_mm_movemask_epi8(v)); }
+        };
+#endif
+    } // namespace detail
+
+    /// 对 text 中每个可能的匹配起点窗口调用 fn(AnchorWindow)，窗口按起点升序；fn 返回 false 时停止。
+    /// mask 为 detail::Kw 的组合，只认其中的关键字；含 KwConst 时 const 前连续的空白也算起点
+    template <typename Fn>
+    void forEachAnchor(std::string_view text, std::uint32_t mask, Fn&& fn) {
+        using namespace detail;
+        const auto probes = anchorProbes(mask);
+        const char* s = text.data();
+        const std::size_t n = text.size();
+
+        // 位置 w 是空白时，核对以它结尾的各长度关键字；空白左边的关键字互不重叠，按 w 升序给出的窗口起点也是升序
+        auto verify = [&](std::size_t w) {
+            for (std::size_t k = 0; k < probes.count; ++k) {
+                std::size_t len = probes.byLength[k].length;
+                if (w < len)
+                    continue;
+                std::size_t b = w - len;
+                auto kw = keyword(text.substr(b, len));
+                if (!(kw & mask))
+                    continue;
+                std::size_t from = b;
+                if (kw == KwConst)
+                    while (from > 0 && isSpace(s[from - 1]))
+                        --from;
+                return fn(AnchorWindow{ from, b });
+            }
+            return true;
+        };
+        auto scalar = [&](std::size_t w) {
+            return !isSpace(s[w]) || verify(w);
+        };
+
+        std::size_t w = 0;
+#if defined(CS_ANCHOR_AVX2) || defined(CS_ANCHOR_SSE2)
+        using Simd = AnchorSimd;
+        for (; w < std::min(n, MaxAnchorWord); ++w)
+            if (!scalar(w))
+                return;
+
+        const auto space = Simd::splat(' ');
+        const auto ctlBase = Simd::splat('\t');                 // \t \n \v \f \r 连续，减去 \t 后不超过 4
+        const auto ctlSpan = Simd::splat('\r' - '\t');
+        typename Simd::V letters[MaxAnchorWord + 1][8];
+        for (std::size_t k = 0; k < probes.count; ++k)
+            for (std::size_t j = 0; j < probes.byLength[k].count; ++j)
+                letters[k][j] = Simd::splat(probes.byLength[k].letters[j]);
+
+        for (; w + Simd::Width <= n; w += Simd::Width) {
+            auto v = Simd::load(s + w);
+            auto ctl = Simd::sub(v, ctlBase);
+            auto ws = Simd::bor(Simd::eq(v, space), Simd::eq(Simd::minu(ctl, ctlSpan), ctl));
+            if (!Simd::bits(ws))
+                continue;
+
+            auto head = Simd::zero();
+            for (std::size_t k = 0; k < probes.count; ++k) {
+                auto at = Simd::load(s + w - probes.byLength[k].length);
+                for (std::size_t j = 0; j < probes.byLength[k].count; ++j)
+                    head = Simd::bor(head, Simd::eq(at, letters[k][j]));
+            }
+            for (auto bits = Simd::bits(Simd::band(ws, head)); bits; bits &= bits - 1)
+                if (!verify(w + static_cast<std::size_t>(std::countr_zero(bits))))
+                    return;
+        }
+#endif
+        for (; w < n; ++w)
+            if (!scalar(w))
+                return;
+    }
+
+    /// 便于传给 searchAnchored 的窗口来源
+    inline auto anchorsOf(std::string_view text, std::uint32_t mask) {
+        return [text, mask](auto&& fn) { forEachAnchor(text, mask, fn); };
+    }
+
+} // namespace cs
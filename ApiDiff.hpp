@@ -0,0 +1,454 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <span>
+#include <unordered_map>
+#include <map>
+#include <algorithm>
+#include <ranges>
+#include <format>
+#include <iterator>
+#include <exception>
+#include <cstdint>
+
+#include "SymbolIndex.hpp"
+#include "ApiStore.hpp"
+#include "ThreadPool.hpp"
+#include "IOUtils.hpp"
+
+/// 两个版本之间的 API 差异：各类型的成员先规范化成按键排序的签名表，
+/// 键为 种类 + 名字 + 参数类型 的哈希（版本间稳定），值为整条签名的哈希，逐类型归并即得增删改
+namespace apidiff {
+
+    using symidx::SymbolKind;
+
+    struct MemberSig {
+        std::uint64_t key = 0;      // 同一成员在两个版本间相同
+        std::uint64_t sig = 0;      // 签名任何部分变化都会不同
+        SymbolKind kind{};
+        std::string name;           // 用于把键对不上的增删配成“签名变化”
+        std::string text;           // 单行签名
+    };
+
+    struct TypeTable {
+        std::string fullName;
+        std::string file;
+        std::string header;             // 单行的类型声明
+        std::vector<MemberSig> members; // 按 key 排序
+    };
+
+    namespace detail {
+        // 参数表只留类型：去掉特性、默认值与参数名，ref/out/in/params/this 保留，如 "int a, ref Foo b = null" -> "int,ref Foo"
+        inline std::string parameterTypes(std::string_view params) {
+            std::string out;
+            std::size_t begin = 0;
+            int depth = 0;
+            auto piece = [&](std::string_view p) {
+                std::size_t eq = std::string_view::npos, lastSpace = std::string_view::npos;
+                int d = 0;
+                for (std::size_t i = 0; i < p.size(); ++i) {
+                    char c = p[i];
+                    if (c == '(' || c == '<' || c == '[' || c == '{')
+                        ++d;
+                    else if (c == ')' || c == '>' || c == ']' || c == '}')
+                        --d;
+                    else if (d == 0 && c == '=' && eq == std::string_view::npos)
+                        eq = i;
+                }
+                p = p.substr(0, eq);
+                while (!p.empty() && cs::detail::isSpace(p.back()))
+                    p.remove_suffix(1);
+                while (!p.empty() && cs::detail::isSpace(p.front()))
+                    p.remove_prefix(1);
+                if (p.starts_with('[')) {           // 参数特性
+                    d = 0;
+                    std::size_t i = 0;
+                    for (; i < p.size(); ++i) {
+                        d += p[i] == '[';
+                        if (p[i] == ']' && --d == 0)
+                            break;
+                    }
+                    p.remove_prefix(std::min(i + 1, p.size()));
+                }
+                d = 0;
+                for (std::size_t i = 0; i < p.size(); ++i) {
+                    char c = p[i];
+                    d += (c == '(' || c == '<' || c == '[') - (c == ')' || c == '>' || c == ']');
+                    if (d == 0 && cs::detail::isSpace(c))
+                        lastSpace = i;
+                }
+                std::string type(lastSpace == std::string_view::npos ? p : p.substr(0, lastSpace));
+                symidx::squeeze(type);
+                if (!out.empty())
+                    out += ',';
+                out += type;
+            };
+            for (std::size_t i = 0; i < params.size(); ++i) {
+                char c = params[i];
+                if (c == '(' || c == '<' || c == '[' || c == '{')
+                    ++depth;
+                else if (c == ')' || c == '>' || c == ']' || c == '}')
+                    --depth;
+                else if (c == '"' || c == '\'') {
+                    for (++i; i < params.size() && params[i] != c; ++i)
+                        i += params[i] == '\\';
+                }
+                else if (c == ',' && depth == 0) {
+                    piece(params.substr(begin, i - begin));
+                    begin = i + 1;
+                }
+            }
+            if (params.find_first_not_of(" \t\r\n") != std::string_view::npos)
+                piece(params.substr(begin));
+            return out;
+        }
+
+        inline std::string escape(std::string_view s) {
+            std::string out;
+            for (char c : s) {
+                if (c == '"' || c == '\\')
+                    out += '\\';
+                if (static_cast<unsigned char>(c) >= 0x20)
+                    out += c;
+            }
+            return out;
+        }
+    } // namespace detail
+
+    /// 一个版本的全部类型；同名类型（如分部类）的成员合在一起
+    class ApiSet {
+    public:
+        /// 从 symidx::SymbolIndex 读入，成员直接取映射中的字符串
+        static ApiSet fromIndex(const symidx::SymbolIndex& index) {
+            ApiSet api;
+            for (std::uint32_t t = 0; t < index.typeCount(); ++t) {
+                const auto& rec = index.type(t);
+                auto& table = api.type(index.str(rec.fullName), index.file(rec.file), index.describe(t));
+                for (std::uint32_t m = 0; m < rec.memberCount; ++m) {
+                    const auto& mr = index.member(rec.firstMember + m);
+                    api.add(table, mr.kind, index.str(mr.name), index.str(mr.parameters), index.describe((rec.firstMember + m) | symidx::MemberBit));
+                }
+            }
+            api.finish();
+            return api;
+        }
+
+        /// 从常驻语料读入，签名由各列拼出后同样压成单行
+        static ApiSet fromCorpus(const apistore::Corpus& c) {
+            ApiSet api;
+            auto& files = c.files();
+            // 多线程收入时文件顺序不定，按路径排序后再读，结果与线程数无关
+            std::vector<std::uint32_t> order(files.size());
+            for (std::uint32_t f = 0; f < order.size(); ++f)
+                order[f] = f;
+            std::ranges::sort(order, {}, [&](std::uint32_t f) { return c.str(files.path[f]); });
+            for (auto f : order) {
+                std::string path(c.str(files.path[f]));
+                for (auto t = files.firstType[f]; t < files.firstType[f] + files.typeCount[f]; ++t)
+                    api.addStored(c, t, std::string(c.str(files.namespaceName[f])), path);
+            }
+            api.finish();
+            return api;
+        }
+
+        const std::vector<TypeTable>& types() const noexcept { return types_; }
+
+        const TypeTable* find(std::string_view fullName) const {
+            auto it = byName_.find(std::string(fullName));
+            return it == byName_.end() ? nullptr : &types_[it->second];
+        }
+
+        std::size_t memberCount() const noexcept {
+            std::size_t n = 0;
+            for (auto&& t : types_)
+                n += t.members.size();
+            return n;
+        }
+
+    private:
+        std::vector<TypeTable> types_;
+        std::unordered_map<std::string, std::size_t> byName_;
+
+        TypeTable& type(std::string_view fullName, std::string_view file, std::string header) {
+            auto [it, inserted] = byName_.try_emplace(std::string(fullName), types_.size());
+            if (inserted)
+                types_.push_back({ std::string(fullName), std::string(file), std::move(header), {} });
+            return types_[it->second];
+        }
+
+        void addStored(const apistore::Corpus& c, std::uint32_t t, const std::string& scope, const std::string& path) {
+            auto& types = c.types();
+            auto simple = symidx::keyName(c.str(types.name[t]));
+            if (simple.empty())
+                return;         // 没找到类型的文件，零散声明不参与比较
+            auto fullName = scope.empty() ? std::string(simple) : std::format("{}.{}", scope, simple);
+
+            std::string header;
+            apistore::formatModifier(std::back_inserter(header), types.modifier[t], c.strings());
+            std::format_to(std::back_inserter(header), "{} {}{}", c.str(types.kind[t]), c.str(types.name[t]), c.str(types.super[t]));
+            symidx::squeeze(header);
+            auto& table = type(fullName, path, std::move(header));
+
+            for (std::size_t k = 0; k < apistore::MemberKinds; ++k) {
+                auto& cols = c.members(static_cast<apistore::MemberKind>(k));
+                auto kind = static_cast<SymbolKind>(k + 1);
+                for (auto m = types.firstMember[k][t]; m < types.firstMember[k][t] + types.memberCount[k][t]; ++m) {
+                    std::string text;
+                    apistore::formatModifier(std::back_inserter(text), cols.modifier[m], c.strings());
+                    std::format_to(std::back_inserter(text), "{} {}", c.str(cols.type[m]), c.str(cols.name[m]));
+                    auto params = kind == SymbolKind::Method ? c.str(cols.parameters[m]) : std::string_view{};
+                    if (kind == SymbolKind::Method)
+                        std::format_to(std::back_inserter(text), "({})", params);
+                    symidx::squeeze(text);
+                    add(table, kind, c.str(cols.name[m]), params, std::move(text));
+                }
+            }
+            for (auto n = types.firstNested[t]; n < types.firstNested[t] + types.nestedCount[t]; ++n)
+                addStored(c, n, fullName, path);
+        }
+
+        static void add(TypeTable& table, SymbolKind kind, std::string_view name, std::string_view parameters, std::string text) {
+            MemberSig m;
+            m.kind = kind;
+            m.name = name;
+            symidx::squeeze(m.name);
+            auto key = std::format("{}|{}", static_cast<int>(kind), m.name);
+            if (kind == SymbolKind::Method)
+                key += '|' + detail::parameterTypes(parameters);
+            m.key = IOUtils::hash_bytes(key);
+            m.sig = IOUtils::hash_bytes(text);
+            m.text = std::move(text);
+            table.members.push_back(std::move(m));
+        }
+
+        // 同名类型出现在多个文件里（分部类或重复的文件）时，完全相同的成员只算一次
+        void finish() {
+            for (auto&& t : types_) {
+                auto bySig = [](const MemberSig& m) { return std::pair(m.key, m.sig); };
+                std::ranges::sort(t.members, {}, bySig);
+                auto dup = std::ranges::unique(t.members, {}, bySig);
+                t.members.erase(dup.begin(), dup.end());
+            }
+        }
+    };
+
+    enum class Op : char {
+        Added = '+',
+        Removed = '-',
+        Changed = '~',
+    };
+
+    inline constexpr std::string_view opName(Op op) noexcept {
+        return op == Op::Added ? "added" : op == Op::Removed ? "removed" : "changed";
+    }
+
+    struct MemberChange {
+        Op op{};
+        SymbolKind kind{};
+        std::string before, after;      // 新增时 before 为空，删除时 after 为空
+    };
+
+    struct TypeChange {
+        Op op{};
+        std::string fullName, file;
+        std::string before, after;      // 类型声明；未变时两者相同
+        std::size_t memberCount = 0;    // 新增、删除的类型的成员数
+        std::vector<MemberChange> members;
+    };
+
+    struct Changelog {
+        std::vector<TypeChange> types;  // 按全名排序
+
+        struct Counts {
+            std::size_t added = 0, removed = 0, changed = 0;
+        };
+        Counts typeCounts() const {
+            Counts c;
+            for (auto&& t : types)
+                ++(t.op == Op::Added ? c.added : t.op == Op::Removed ? c.removed : c.changed);
+            return c;
+        }
+        Counts memberCounts() const {
+            Counts c;
+            for (auto&& t : types)
+                for (auto&& m : t.members)
+                    ++(m.op == Op::Added ? c.added : m.op == Op::Removed ? c.removed : c.changed);
+            return c;
+        }
+    };
+
+    /// 两张已按键排序的签名表归并：键相同而签名不同为“变化”；键对不上的，同种类同名的删除与新增依次配对，
+    /// 也算“变化”（如方法多了一个参数），其余为增删。重载按键区分，不会互相配对
+    inline std::vector<MemberChange> diffMembers(std::span<const MemberSig> before, std::span<const MemberSig> after) {
+        std::vector<MemberChange> out;
+        std::vector<const MemberSig*> removed, added;
+        std::size_t i = 0, j = 0;
+        while (i < before.size() || j < after.size()) {
+            if (j == after.size() || (i < before.size() && before[i].key < after[j].key))
+                removed.push_back(&before[i++]);
+            else if (i == before.size() || after[j].key < before[i].key)
+                added.push_back(&after[j++]);
+            else {
+                // 同键的若干条（重复声明）先按签名对上相同的，剩下的逐条算变化
+                auto key = before[i].key;
+                auto ie = i, je = j;
+                while (ie < before.size() && before[ie].key == key)
+                    ++ie;
+                while (je < after.size() && after[je].key == key)
+                    ++je;
+                std::vector<const MemberSig*> lhs, rhs;
+                while (i < ie || j < je) {
+                    if (j == je || (i < ie && before[i].sig < after[j].sig))
+                        lhs.push_back(&before[i++]);
+                    else if (i == ie || after[j].sig < before[i].sig)
+                        rhs.push_back(&after[j++]);
+                    else
+                        ++i, ++j;
+                }
+                std::size_t n = std::min(lhs.size(), rhs.size());
+                for (std::size_t k = 0; k < n; ++k)
+                    out.push_back({ Op::Changed, lhs[k]->kind, lhs[k]->text, rhs[k]->text });
+                removed.insert(removed.end(), lhs.begin() + n, lhs.end());
+                added.insert(added.end(), rhs.begin() + n, rhs.end());
+            }
+        }
+
+        std::multimap<std::pair<SymbolKind, std::string_view>, const MemberSig*> unmatched;
+        for (auto* a : added)
+            unmatched.emplace(std::pair(a->kind, std::string_view(a->name)), a);
+        for (auto* r : removed) {
+            auto it = unmatched.find(std::pair(r->kind, std::string_view(r->name)));
+            if (it != unmatched.end()) {
+                out.push_back({ Op::Changed, r->kind, r->text, it->second->text });
+                unmatched.erase(it);
+            }
+            else
+                out.push_back({ Op::Removed, r->kind, r->text, {} });
+        }
+        for (auto&& [name, a] : unmatched)
+            out.push_back({ Op::Added, a->kind, {}, a->text });
+
+        // 报告里同种类放在一起，种类内按名字
+        std::ranges::stable_sort(out, {}, [](const MemberChange& c) {
+            return std::pair(c.kind, std::string_view(c.after.empty() ? c.before : c.after));
+        });
+        return out;
+    }
+
+    /// 逐类型比较，共有的类型分给 jobs 个线程；结果与线程数无关
+    inline Changelog diff(const ApiSet& before, const ApiSet& after, unsigned jobs = 1) {
+        Changelog log;
+        std::vector<std::pair<const TypeTable*, const TypeTable*>> common;
+        for (auto&& t : before.types()) {
+            if (auto* n = after.find(t.fullName))
+                common.emplace_back(&t, n);
+            else
+                log.types.push_back({ Op::Removed, t.fullName, t.file, t.header, {}, t.members.size(), {} });
+        }
+        for (auto&& t : after.types())
+            if (!before.find(t.fullName))
+                log.types.push_back({ Op::Added, t.fullName, t.file, {}, t.header, t.members.size(), {} });
+
+        std::vector<TypeChange> results(common.size());
+        auto compare = [&](std::size_t k) {
+            auto [o, n] = common[k];
+            auto members = diffMembers(o->members, n->members);
+            if (members.empty() && o->header == n->header)
+                return;
+            results[k] = { Op::Changed, n->fullName, n->file, o->header, n->header, 0, std::move(members) };
+        };
+        if (jobs > 1 && common.size() > 1) {
+            std::vector<std::exception_ptr> errors(common.size());
+            ThreadPool pool(jobs);
+            for (std::size_t k = 0; k < common.size(); ++k) {
+                pool.submit([&, k] {
+                    try {
+                        compare(k);
+                    }
+                    catch (...) {
+                        errors[k] = std::current_exception();
+                    }
+                });
+            }
+            pool.wait();
+            for (auto&& e : errors)
+                if (e)
+                    std::rethrow_exception(e);
+        }
+        else {
+            for (std::size_t k = 0; k < common.size(); ++k)
+                compare(k);
+        }
+
+        for (auto&& r : results)
+            if (!r.fullName.empty())
+                log.types.push_back(std::move(r));
+        std::ranges::sort(log.types, {}, &TypeChange::fullName);
+        return log;
+    }
+
+    /// 人读的报告：每个有变化的类型一段，+ 新增、- 删除、~ 签名变化（下一行为新签名）
+    inline std::string textReport(const Changelog& log) {
+        std::string out;
+        auto it = std::back_inserter(out);
+        for (auto&& t : log.types) {
+            switch (t.op) {
+            case Op::Added:
+                std::format_to(it, "+ {}  ({} 个成员, {})\n", t.fullName, t.memberCount, t.file);
+                continue;
+            case Op::Removed:
+                std::format_to(it, "- {}  ({} 个成员, {})\n", t.fullName, t.memberCount, t.file);
+                continue;
+            case Op::Changed:
+                std::format_to(it, "~ {}  ({})\n", t.fullName, t.file);
+                break;
+            }
+            if (t.before != t.after)
+                std::format_to(it, "    ~ {}\n      → {}\n", t.before, t.after);
+            for (auto&& m : t.members) {
+                if (m.op == Op::Changed)
+                    std::format_to(it, "    ~ {}\n      → {}\n", m.before, m.after);
+                else
+                    std::format_to(it, "    {} {}\n", static_cast<char>(m.op), m.op == Op::Added ? m.after : m.before);
+            }
+        }
+        auto tc = log.typeCounts();
+        auto mc = log.memberCounts();
+        std::format_to(it, "类型：新增 {}，删除 {}，变化 {}；成员：新增 {}，删除 {}，签名变化 {}\n",
+                       tc.added, tc.removed, tc.changed, mc.added, mc.removed, mc.changed);
+        return out;
+    }
+
+    /// 机读的报告，JSON；新增/删除时对侧的字段为 null
+    inline std::string jsonReport(const Changelog& log, std::string_view beforeName, std::string_view afterName) {
+        std::string out;
+        auto it = std::back_inserter(out);
+        auto str = [](std::string_view s, bool present) {
+            return present ? std::format("\"{}\"", detail::escape(s)) : std::string("null");
+        };
+        auto tc = log.typeCounts();
+        auto mc = log.memberCounts();
+        std::format_to(it, "{{\"before\":\"{}\",\"after\":\"{}\",\"summary\":{{"
+                           "\"types\":{{\"added\":{},\"removed\":{},\"changed\":{}}},"
+                           "\"members\":{{\"added\":{},\"removed\":{},\"changed\":{}}}}},\"types\":[",
+                       detail::escape(beforeName), detail::escape(afterName),
+                       tc.added, tc.removed, tc.changed, mc.added, mc.removed, mc.changed);
+        for (std::size_t k = 0; k < log.types.size(); ++k) {
+            auto&& t = log.types[k];
+            std::format_to(it, "{}\n{{\"name\":\"{}\",\"file\":\"{}\",\"change\":\"{}\",\"before\":{},\"after\":{},\"members\":[",
+                           k ? "," : "", detail::escape(t.fullName), detail::escape(t.file), opName(t.op),
+                           str(t.before, t.op != Op::Added), str(t.after, t.op != Op::Removed));
+            for (std::size_t i = 0; i < t.members.size(); ++i) {
+                auto&& m = t.members[i];
+                std::format_to(it, "{}{{\"kind\":\"{}\",\"change\":\"{}\",\"before\":{},\"after\":{}}}",
+                               i ? "," : "", symidx::kindName(m.kind), opName(m.op),
+                               str(m.before, m.op != Op::Added), str(m.after, m.op != Op::Removed));
+            }
+            out += "]}";
+        }
+        out += "\n]}\n";
+        return out;
+    }
+
+} // namespace apidiff
@@ -0,0 +1,368 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <memory_resource>
+#include <unordered_map>
+#include <mutex>
+#include <format>
+#include <iterator>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+#include "ClassInfo.hpp"
+
+/// 整个语料常驻内存用的紧凑表示：字符串在全语料范围内驻留并以 32 位编号引用，修饰符压成位标志，
+/// 各种成员按列（SoA）存放；驻留的字符成块分配，随 Corpus 一起释放。格式化结果与 ClassInfo 相同
+namespace apistore {
+
+    using Sym = std::uint32_t;
+
+    /// 字符串驻留表：相同内容只存一份，编号 0 固定为空串
+    class Interner {
+    public:
+        /// chars 存字符本身（只增不减），tables 存编号表与哈希表
+        Interner(std::pmr::memory_resource* chars, std::pmr::memory_resource* tables)
+            : chars_(chars), index_(tables), strings_(tables) {
+            strings_.push_back({});
+            index_.emplace(std::string_view{}, 0);
+        }
+
+        Sym intern(std::string_view s) {
+            if (auto it = index_.find(s); it != index_.end())
+                return it->second;
+            auto* p = static_cast<char*>(chars_->allocate(s.size(), 1));
+            std::memcpy(p, s.data(), s.size());
+            std::string_view stored(p, s.size());
+            auto id = static_cast<Sym>(strings_.size());
+            strings_.push_back(stored);
+            index_.emplace(stored, id);
+            bytes_ += s.size();
+            return id;
+        }
+
+        std::string_view operator[](Sym id) const noexcept { return strings_[id]; }
+        std::size_t size() const noexcept { return strings_.size(); }
+        std::size_t bytes() const noexcept { return bytes_; }         // 字符本身
+        std::size_t overhead() const noexcept {                         // 编号表与哈希表，按节点粗估
+            return strings_.capacity() * sizeof(std::string_view) + index_.size() * (sizeof(std::string_view) + sizeof(Sym) + 2 * sizeof(void*))
+                 + index_.bucket_count() * sizeof(void*);
+        }
+
+    private:
+        std::pmr::memory_resource* chars_;
+        std::pmr::unordered_map<std::string_view, Sym> index_;
+        std::pmr::vector<std::string_view> strings_;
+        std::size_t bytes_ = 0;
+    };
+
+    /// 修饰符位标志。按下面的顺序各接一个空格重新拼出来与原文相同时只存标志，
+    /// 否则（顺序不同、多余空白等）置 Verbatim，低位为原文的驻留编号，输出仍与原文一致
+    enum Modifier : std::uint32_t {
+        Public    = 1u << 0,
+        Private   = 1u << 1,
+        Protected = 1u << 2,
+        Internal  = 1u << 3,
+        New       = 1u << 4,
+        Static    = 1u << 5,
+        Abstract  = 1u << 6,
+        Virtual   = 1u << 7,
+        Sealed    = 1u << 8,
+        Override  = 1u << 9,
+        Extern    = 1u << 10,
+        Readonly  = 1u << 11,
+        Unsafe    = 1u << 12,
+        Volatile  = 1u << 13,
+        Const     = 1u << 14,
+        Event     = 1u << 15,
+        Verbatim  = 1u << 31,
+    };
+
+    inline constexpr std::string_view ModifierWords[] = {
+        "public", "private", "protected", "internal", "new", "static", "abstract", "virtual", "sealed",
+        "override", "extern", "readonly", "unsafe", "volatile", "const", "event",
+    };
+
+    inline std::uint32_t encodeModifier(std::string_view text, Interner& strings) {
+        std::uint32_t flags = 0;
+        std::size_t pos = 0, next = 0;      // next：下一个词在 ModifierWords 中至少的位置
+        while (pos < text.size()) {
+            std::size_t end = text.find(' ', pos);
+            if (end == std::string_view::npos)
+                return Verbatim | strings.intern(text);
+            auto word = text.substr(pos, end - pos);
+            std::size_t k = next;
+            while (k < std::size(ModifierWords) && ModifierWords[k] != word)
+                ++k;
+            if (k == std::size(ModifierWords))
+                return Verbatim | strings.intern(text);
+            flags |= 1u << k;
+            next = k + 1;
+            pos = end + 1;
+        }
+        return flags;
+    }
+
+    template <typename Out>
+    Out formatModifier(Out out, std::uint32_t m, const Interner& strings) {
+        if (m & Verbatim) {
+            auto s = strings[m & ~Verbatim];
+            return std::copy(s.begin(), s.end(), out);
+        }
+        for (std::size_t k = 0; k < std::size(ModifierWords); ++k) {
+            if (m & (1u << k)) {
+                out = std::copy(ModifierWords[k].begin(), ModifierWords[k].end(), out);
+                *out++ = ' ';
+            }
+        }
+        return out;
+    }
+
+    /// 成员种类，顺序与 ClassInfo::members 一致
+    enum class MemberKind : std::uint8_t { Method, Field, Property, Constant, Event };
+    inline constexpr std::size_t MemberKinds = 5;
+    inline constexpr std::string_view MemberKindNames[MemberKinds] = { "Method", "Field", "Property", "Constant", "Event" };
+
+    /// 一种成员的全部列；parameters 只有方法用
+    struct MemberColumns {
+        std::pmr::vector<std::uint32_t> modifier;
+        std::pmr::vector<Sym> type, name, parameters;
+
+        explicit MemberColumns(std::pmr::memory_resource* mr) : modifier(mr), type(mr), name(mr), parameters(mr) {}
+
+        std::size_t size() const noexcept { return name.size(); }
+        std::size_t bytes() const noexcept {
+            return (modifier.capacity() + type.capacity() + name.capacity() + parameters.capacity()) * sizeof(std::uint32_t);
+        }
+    };
+
+    /// 类型的列。同一类型的各种成员在对应列中连续；同一外层类型（或同一文件）的直接嵌套类型在类型列中连续
+    struct TypeColumns {
+        std::pmr::vector<std::uint32_t> modifier;
+        std::pmr::vector<Sym> kind, name, super;
+        std::array<std::pmr::vector<std::uint32_t>, MemberKinds> firstMember, memberCount;
+        std::pmr::vector<std::uint32_t> firstNested, nestedCount;
+
+        explicit TypeColumns(std::pmr::memory_resource* mr)
+            : modifier(mr), kind(mr), name(mr), super(mr),
+              firstMember{ column(mr), column(mr), column(mr), column(mr), column(mr) },
+              memberCount{ column(mr), column(mr), column(mr), column(mr), column(mr) },
+              firstNested(mr), nestedCount(mr) {}
+
+        std::size_t size() const noexcept { return name.size(); }
+        std::size_t bytes() const noexcept {
+            std::size_t n = modifier.capacity() + kind.capacity() + name.capacity() + super.capacity()
+                          + firstNested.capacity() + nestedCount.capacity();
+            for (std::size_t k = 0; k < MemberKinds; ++k)
+                n += firstMember[k].capacity() + memberCount[k].capacity();
+            return n * sizeof(std::uint32_t);
+        }
+
+    private:
+        static std::pmr::vector<std::uint32_t> column(std::pmr::memory_resource* mr) { return std::pmr::vector<std::uint32_t>(mr); }
+    };
+
+    struct FileColumns {
+        std::pmr::vector<Sym> path, namespaceName;
+        std::pmr::vector<std::uint32_t> firstType, typeCount;      // 顶层类型（自身 + 同文件的其余类型）
+
+        explicit FileColumns(std::pmr::memory_resource* mr) : path(mr), namespaceName(mr), firstType(mr), typeCount(mr) {}
+
+        std::size_t size() const noexcept { return path.size(); }
+        std::size_t bytes() const noexcept {
+            return (path.capacity() + namespaceName.capacity() + firstType.capacity() + typeCount.capacity()) * sizeof(std::uint32_t);
+        }
+    };
+
+    /// 内存占用，字节
+    struct Footprint {
+        std::size_t strings = 0;        // 驻留的不同字符串个数
+        std::size_t stringBytes = 0;    // 其字符
+        std::size_t internBytes = 0;    // 驻留表本身
+        std::size_t columnBytes = 0;    // 各列
+        std::size_t liveBytes = 0;     // 当前实际向系统申请着的总量
+    };
+
+    class Corpus;
+
+    /// 语料中的一个文件，格式化结果与该文件的 ClassInfo 相同
+    struct FileRef {
+        const Corpus* corpus;
+        std::uint32_t index;
+    };
+
+    /// 整个语料。add 可在多个工作线程中调用，每个文件在锁内一次写完，保证上面的连续性
+    class Corpus {
+    public:
+        Corpus() : strings_(&chars_, &upstream_), types_(&upstream_), files_(&upstream_),
+                   members_{ MemberColumns(&upstream_), MemberColumns(&upstream_), MemberColumns(&upstream_), MemberColumns(&upstream_), MemberColumns(&upstream_) } {}
+
+        Corpus(const Corpus&) = delete;
+        Corpus& operator=(const Corpus&) = delete;
+
+        /// 收入一个文件的解析结果，返回文件编号；info 可以是指向源文本的 ClassInfoView，加入后源文本即可释放
+        template <typename Str>
+        std::uint32_t add(std::string_view path, const BasicClassInfo<Str>& info) {
+            std::lock_guard lock(mutex_);
+            auto file = static_cast<std::uint32_t>(files_.size());
+            files_.path.push_back(strings_.intern(path));
+            files_.namespaceName.push_back(strings_.intern(info.namespaceName));
+            files_.firstType.push_back(static_cast<std::uint32_t>(types_.size()));
+            files_.typeCount.push_back(static_cast<std::uint32_t>(1 + info.others.size()));
+
+            // 没找到类型时 info 自身仍占一行（名字为空），文件层零散的声明挂在它下面，与 ClassInfo 的输出一致；
+            // 同一层的类型先占好连续的行并填写，它们的嵌套类型随后另占一段
+            std::vector<const BasicClassInfo<Str>*> level{ &info };
+            for (auto&& o : info.others)
+                level.push_back(&o);
+            addLevel(level);
+            return file;
+        }
+
+        std::size_t fileCount() const noexcept { return files_.size(); }
+        std::size_t typeCount() const noexcept { return types_.size(); }
+        std::size_t memberCount() const noexcept {
+            std::size_t n = 0;
+            for (auto&& m : members_)
+                n += m.size();
+            return n;
+        }
+
+        FileRef file(std::uint32_t i) const noexcept { return { this, i }; }
+
+        const Interner& strings() const noexcept { return strings_; }
+        const TypeColumns& types() const noexcept { return types_; }
+        const FileColumns& files() const noexcept { return files_; }
+        const MemberColumns& members(MemberKind k) const noexcept { return members_[static_cast<std::size_t>(k)]; }
+
+        std::string_view str(Sym s) const noexcept { return strings_[s]; }
+
+        Footprint footprint() const {
+            std::lock_guard lock(mutex_);
+            Footprint f;
+            f.strings = strings_.size();
+            f.stringBytes = strings_.bytes();
+            f.internBytes = strings_.overhead();
+            f.columnBytes = types_.bytes() + files_.bytes();
+            for (auto&& m : members_)
+                f.columnBytes += m.bytes();
+            f.liveBytes = upstream_.live;
+            return f;
+        }
+
+    private:
+        // 记下当前向系统申请着的总量，作为真实占用
+        struct CountingResource : std::pmr::memory_resource {
+            std::size_t live = 0;
+            void* do_allocate(std::size_t n, std::size_t align) override {
+                live += n;
+                return std::pmr::new_delete_resource()->allocate(n, align);
+            }
+            void do_deallocate(void* p, std::size_t n, std::size_t align) override {
+                live -= n;
+                std::pmr::new_delete_resource()->deallocate(p, n, align);
+            }
+            bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+        };
+
+        mutable std::mutex mutex_;
+        CountingResource upstream_;
+        std::pmr::monotonic_buffer_resource chars_{ &upstream_ };      // 驻留的字符只增不减，成块分配；各列扩容时旧块直接归还
+        Interner strings_;
+        TypeColumns types_;
+        FileColumns files_;
+        std::array<MemberColumns, MemberKinds> members_;
+
+        template <typename Str>
+        void addLevel(const std::vector<const BasicClassInfo<Str>*>& level) {
+            auto first = types_.size();
+            for (auto* t : level) {
+                types_.modifier.push_back(encodeModifier(t->self.modifier, strings_));
+                types_.kind.push_back(strings_.intern(t->self.type));
+                types_.name.push_back(strings_.intern(t->self.name));
+                types_.super.push_back(strings_.intern(t->self.super));
+                for (std::size_t k = 0; k < MemberKinds; ++k) {
+                    types_.firstMember[k].push_back(static_cast<std::uint32_t>(members_[k].size()));
+                    std::visit([&](auto&& v) {
+                        auto& cols = members_[k];
+                        for (auto&& m : v) {
+                            cols.modifier.push_back(encodeModifier(m.modifier, strings_));
+                            cols.type.push_back(strings_.intern(m.type));
+                            cols.name.push_back(strings_.intern(m.name));
+                            if constexpr (requires { m.parameters; })
+                                cols.parameters.push_back(strings_.intern(m.parameters));
+                        }
+                        types_.memberCount[k].push_back(static_cast<std::uint32_t>(v.size()));
+                    }, t->members[k].second);
+                }
+                types_.firstNested.push_back(0);
+                types_.nestedCount.push_back(static_cast<std::uint32_t>(t->nested.size()));
+            }
+            for (std::size_t i = 0; i < level.size(); ++i) {
+                if (level[i]->nested.empty())
+                    continue;
+                types_.firstNested[first + i] = static_cast<std::uint32_t>(types_.size());
+                std::vector<const BasicClassInfo<Str>*> children;
+                for (auto&& n : level[i]->nested)
+                    children.push_back(&n);
+                addLevel(children);
+            }
+        }
+    };
+
+} // namespace apistore
+
+template <>
+struct std::formatter<apistore::FileRef> {
+    constexpr auto parse(std::format_parse_context& ctx) { return ctx.begin(); }
+
+    auto format(const apistore::FileRef& f, std::format_context& ctx) const {
+        auto& c = *f.corpus;
+        auto out = ctx.out();
+        auto ns = c.str(c.files().namespaceName[f.index]);
+        if (!ns.empty())
+            out = std::format_to(out, "namespace {}\n", ns);
+        auto first = c.files().firstType[f.index];
+        for (auto t = first; t < first + c.files().typeCount[f.index]; ++t)
+            out = formatType(out, c, t, 0);
+        return out;
+    }
+
+private:
+    // 与 formatter<BasicClassInfo> 的布局相同
+    static constexpr std::size_t 成员缩进 = 2;
+    static constexpr std::size_t 内容缩进 = 6;
+
+    template <typename Out>
+    static Out formatType(Out out, const apistore::Corpus& c, std::uint32_t t, std::size_t 缩进) {
+        auto& types = c.types();
+        out = std::format_to(out, "{:{}}", "", 缩进);
+        out = apistore::formatModifier(out, types.modifier[t], c.strings());
+        out = std::format_to(out, "{} {}{}\n", c.str(types.kind[t]), c.str(types.name[t]), c.str(types.super[t]));
+
+        for (std::size_t k = 0; k < apistore::MemberKinds; ++k) {
+            auto count = types.memberCount[k][t];
+            if (count == 0)
+                continue;
+            auto& cols = c.members(static_cast<apistore::MemberKind>(k));
+            out = std::format_to(out, "{:{}}{} 个 {}:\n", "", 缩进 + 成员缩进, count, apistore::MemberKindNames[k]);
+            for (auto m = types.firstMember[k][t]; m < types.firstMember[k][t] + count; ++m) {
+                out = std::format_to(out, "{:{}}", "", 缩进 + 内容缩进);
+                out = apistore::formatModifier(out, cols.modifier[m], c.strings());
+                out = std::format_to(out, "{} {}", c.str(cols.type[m]), c.str(cols.name[m]));
+                if (k == static_cast<std::size_t>(apistore::MemberKind::Method))
+                    out = std::format_to(out, "({})", c.str(cols.parameters[m]));
+                *out++ = '\n';
+            }
+        }
+
+        if (auto nested = types.nestedCount[t]) {
+            out = std::format_to(out, "{:{}}{} 个 嵌套类型:\n", "", 缩进 + 成员缩进, nested);
+            for (auto n = types.firstNested[t]; n < types.firstNested[t] + nested; ++n)
+                out = formatType(out, c, n, 缩进 + 内容缩进);
+        }
+        return out;
+    }
+};
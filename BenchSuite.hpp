@@ -0,0 +1,359 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <chrono>
+#include <format>
+#include <algorithm>
+#include <numeric>
+#include <functional>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+
+#include "ClassInfo.hpp"
+#include "AnchorScan.hpp"
+#include "ApiStore.hpp"
+#include "NdJson.hpp"
+
+/// 基准测试：按参数生成合成的 C# 源码（也可以回放真实输入），分别测量各成员正则、
+/// ClassInfo 构造、matchNamespace 与格式化的吞吐量，每项重复多次取中位数
+namespace bench {
+
+    /// 合成语料的参数，同样的参数与种子总是生成同样的文本
+    struct CorpusSpec {
+        std::size_t bytes = 256 * 1024;                 // 目标大小
+        std::array<unsigned, 5> mix{ 6, 4, 4, 1, 1 };   // 方法、字段、属性、常量、事件的比例
+        unsigned genericDepth = 2;                      // 泛型参数最大嵌套层数
+        unsigned bodyLines = 6;                         // 方法体与访问器体的语句行数
+        std::uint64_t seed = 1;
+    };
+
+    /// 与标准库实现无关的随机数，保证各平台生成的语料一致
+    class SplitMix64 {
+    public:
+        explicit SplitMix64(std::uint64_t seed) noexcept : state_(seed) {}
+
+        std::uint64_t next() noexcept {
+            std::uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+
+        /// [0, n)
+        std::uint32_t below(std::uint32_t n) noexcept { return static_cast<std::uint32_t>(next() % n); }
+
+    private:
+        std::uint64_t state_;
+    };
+
+    /// 生成一个文件：一个 namespace 下若干类，每个类带一个嵌套结构体；
+    /// 成员体里混入注释、字符串与花括号，覆盖扫描器需要跳过的情形
+    inline std::string generateCorpus(const CorpusSpec& spec) {
+        SplitMix64 rng(spec.seed);
+        std::string out;
+        out.reserve(spec.bytes + 4096);
+        auto emit = [&]<typename... Args>(std::format_string<Args...> fmt, Args&&... args) {
+            std::format_to(std::back_inserter(out), fmt, std::forward<Args>(args)...);
+        };
+
+        constexpr std::string_view leaves[] = { "int", "string", "float", "bool", "Item", "Vector3", "Slot", "Inventory" };
+        constexpr std::string_view containers[] = { "List<{}>", "Dictionary<string, {}>", "IEnumerable<{}>", "{}[]" };
+        constexpr std::string_view modifiers[] = { "public ", "private ", "protected ", "internal ", "public static ", "private readonly " };
+        auto pick = [&](const auto& arr) { return arr[rng.below(static_cast<std::uint32_t>(std::size(arr)))]; };
+
+        std::function<std::string(unsigned)> typeName = [&](unsigned depth) -> std::string {
+            if (depth == 0 || rng.below(3) == 0)
+                return std::string(pick(leaves));
+            auto container = pick(containers);
+            auto inner = typeName(depth - 1);
+            return std::vformat(container, std::make_format_args(inner));
+        };
+        auto anyType = [&] { return typeName(spec.genericDepth); };
+        auto body = [&](std::string_view indent) {
+            for (unsigned j = 0; j < spec.bodyLines; ++j) {
+                switch (rng.below(4)) {
+                case 0: emit("{}var v{} = Compute({}, \"text {{ with }} braces\");\n", indent, j, j); break;
+                case 1: emit("{}// 注释里的 }} 与 public int Fake() {{ 不应被匹配\n", indent); break;
+                case 2: emit("{}if (v > {}) {{ Debug.Log($\"{{v}} > {}\"); }}\n", indent, j, j); break;
+                default: emit("{}items.Add(new Item {{ Id = {}, Name = 'x' }});\n", indent, j); break;
+                }
+            }
+        };
+
+        std::uint32_t total = std::accumulate(spec.mix.begin(), spec.mix.end(), 0u);
+        if (total == 0)
+            total = 1;
+
+        emit("using System;\nusing System.Collections.Generic;\n\nnamespace Bench.Synthetic.Ns{}\n{{\n", spec.seed);
+        for (unsigned c = 0; out.size() < spec.bytes; ++c) {
+            emit("\t/// <summary>合成类 {}</summary>\n\tpublic class Generated{} : MonoBehaviour, IComparable<Generated{}>\n\t{{\n", c, c, c);
+            unsigned members = 20 + rng.below(20);
+            for (unsigned m = 0; m < members; ++m) {
+                auto roll = rng.below(total);
+                std::size_t kind = 0;
+                while (kind + 1 < spec.mix.size() && roll >= spec.mix[kind])
+                    roll -= spec.mix[kind++];
+                switch (kind) {
+                case 0:
+                    emit("\t\t{}{} Method{}({} a, {} b = default)\n\t\t{{\n", pick(modifiers), anyType(), m, anyType(), anyType());
+                    body("\t\t\t");
+                    emit("\t\t}}\n\n");
+                    break;
+                case 1:
+                    emit("\t\t{}{} field{};\n\n", pick(modifiers), anyType(), m);
+                    break;
+                case 2:
+                    if (rng.below(2)) {
+                        emit("\t\t{}{} Prop{} {{ get; set; }}\n\n", pick(modifiers), anyType(), m);
+                        break;
+                    }
+                    emit("\t\t{}{} Prop{}\n\t\t{{\n\t\t\tget\n\t\t\t{{\n", pick(modifiers), anyType(), m);
+                    body("\t\t\t\t");
+                    emit("\t\t\t}}\n\t\t}}\n\n");
+                    break;
+                case 3:
+                    emit("\t\tpublic const int Const{} = {};\n\n", m, m);
+                    break;
+                default:
+                    emit("\t\tpublic event Action<{}> Event{}\n\t\t{{\n\t\t\tadd {{ handlers += value; }}\n\t\t\tremove {{ handlers -= value; }}\n\t\t}}\n\n", anyType(), m);
+                    break;
+                }
+            }
+            emit("\t\tpublic struct Inner{}\n\t\t{{\n\t\t\tpublic int x;\n\t\t\tpublic {} Value {{ get; set; }}\n\t\t}}\n\t}}\n\n", c, anyType());
+        }
+        out += "}\n";
+        return out;
+    }
+
+    /// 一项测量的结果；seconds 为每次重复的耗时
+    struct Result {
+        std::string name;
+        std::vector<double> seconds;
+        std::size_t bytes = 0;      // 每次处理的字节数
+        std::size_t items = 0;      // 每次产出的成员数
+
+        double median() const {
+            auto s = seconds;
+            std::ranges::sort(s);
+            return s.size() % 2 ? s[s.size() / 2] : (s[s.size() / 2 - 1] + s[s.size() / 2]) / 2;
+        }
+
+        double min() const { return std::ranges::min(seconds); }
+
+        /// 中位数绝对偏差相对中位数的比例，对偶发的慢样本不敏感
+        double spread() const {
+            auto m = median();
+            std::vector<double> dev;
+            for (double s : seconds)
+                dev.push_back(std::abs(s - m));
+            std::ranges::sort(dev);
+            return m > 0 ? dev[dev.size() / 2] / m : 0;
+        }
+    };
+
+    /// 先预热一次，再重复 reps 次；fn 返回本次产出的成员数，同时防止结果被优化掉
+    template <typename F>
+    Result measure(std::string name, unsigned reps, std::size_t bytes, F&& fn) {
+        using clock = std::chrono::steady_clock;
+        Result r{ std::move(name), {}, bytes, fn() };
+        for (unsigned i = 0; i < std::max(reps, 1u); ++i) {
+            auto start = clock::now();
+            auto items = fn();
+            r.seconds.push_back(std::chrono::duration<double>(clock::now() - start).count());
+            r.items = items;
+        }
+        return r;
+    }
+
+    inline std::string report(const std::vector<Result>& results) {
+        std::string out = std::format("{:<28}{:>12}{:>12}{:>9}{:>11}{:>14}\n", "项目", "中位数(ms)", "最小(ms)", "离散", "MB/s", "成员/s");
+        for (auto&& r : results) {
+            double m = r.median();
+            std::format_to(std::back_inserter(out), "{:<28}{:>12.3f}{:>12.3f}{:>8.1f}%{:>11.1f}{:>14.0f}\n",
+                           r.name, m * 1e3, r.min() * 1e3, r.spread() * 100,
+                           m > 0 ? r.bytes / m / (1024 * 1024) : 0, m > 0 ? r.items / m : 0);
+        }
+        return out;
+    }
+
+    template <typename T>
+    std::size_t matchAll(const std::vector<std::string>& texts) {
+        std::size_t n = 0;
+        for (auto&& t : texts)
+            for (auto&& m : T::getBuilder().match(t))
+                n += !m.name.empty();
+        return n;
+    }
+
+    template <typename Str>
+    std::size_t memberCount(const BasicClassInfo<Str>& info) {
+        std::size_t n = 0;
+        for (auto&& [name, v] : info.members)
+            n += std::visit([](auto&& vec) { return vec.size(); }, v);
+        for (auto&& c : info.nested)
+            n += memberCount(c) + 1;
+        for (auto&& c : info.others)
+            n += memberCount(c) + 1;
+        return n + !info.self.name.empty();
+    }
+
+    namespace detail {
+        inline std::size_t heapBytes(const std::string& s) {
+            return s.capacity() > std::string().capacity() ? s.capacity() + 1 : 0;
+        }
+
+        template <typename T>
+        std::size_t ownedBytes(const T& m) {
+            std::size_t n = heapBytes(m.modifier) + heapBytes(m.type) + heapBytes(m.name);
+            if constexpr (requires { m.parameters; })
+                n += heapBytes(m.parameters);
+            if constexpr (requires { m.super; })
+                n += heapBytes(m.super);
+            return n;
+        }
+
+        // 自持字符串的 ClassInfo 在堆上的占用（不含自身），按容量计
+        inline std::size_t ownedBytes(const ClassInfo& c) {
+            std::size_t n = ownedBytes(c.self) + heapBytes(c.namespaceName);
+            for (auto&& [name, v] : c.members) {
+                std::visit([&](auto&& vec) {
+                    n += vec.capacity() * sizeof(vec[0]);
+                    for (auto&& m : vec)
+                        n += ownedBytes(m);
+                }, v);
+            }
+            n += (c.nested.capacity() + c.others.capacity()) * sizeof(ClassInfo);
+            for (auto&& x : c.nested)
+                n += ownedBytes(x);
+            for (auto&& x : c.others)
+                n += ownedBytes(x);
+            return n;
+        }
+    } // namespace detail
+
+    /// 整份语料常驻内存时两种表示的占用对比
+    inline std::string footprint(const std::vector<std::string>& texts) {
+        std::size_t owned = 0;
+        apistore::Corpus corpus;
+        for (auto&& t : texts) {
+            ClassInfo info(t, Parser::Scanner);
+            owned += sizeof(ClassInfo) + detail::ownedBytes(info);
+            corpus.add({}, info);
+        }
+        auto fp = corpus.footprint();
+        return std::format("常驻内存：ClassInfo {} KB → apistore::Corpus {} KB（{} 个不同字符串共 {} KB，驻留表 {} KB，各列 {} KB）\n",
+                           owned / 1024, fp.liveBytes / 1024, fp.strings, fp.stringBytes / 1024,
+                           fp.internBytes / 1024, fp.columnBytes / 1024);
+    }
+
+    /// 对一组源文本跑全部测量项
+    inline std::vector<Result> runSuite(const std::vector<std::string>& texts, unsigned reps) {
+        std::size_t bytes = 0;
+        for (auto&& t : texts)
+            bytes += t.size();
+
+        ClassInfoView::warmUp(Parser::Regex);
+
+        std::vector<Result> results;
+        results.push_back(measure("ClassLike::match", reps, bytes, [&] { return matchAll<BasicClassLike<std::string_view>>(texts); }));
+        results.push_back(measure("Method::match", reps, bytes, [&] { return matchAll<BasicMethod<std::string_view>>(texts); }));
+        results.push_back(measure("Field::match", reps, bytes, [&] { return matchAll<BasicField<std::string_view>>(texts); }));
+        results.push_back(measure("Property::match", reps, bytes, [&] { return matchAll<BasicProperty<std::string_view>>(texts); }));
+        results.push_back(measure("Constant::match", reps, bytes, [&] { return matchAll<BasicConstant<std::string_view>>(texts); }));
+        results.push_back(measure("Event::match", reps, bytes, [&] { return matchAll<BasicEvent<std::string_view>>(texts); }));
+        results.push_back(measure("MemberRegex::scan", reps, bytes, [&] {
+            std::size_t n = 0;
+            for (auto&& t : texts)
+                BasicMemberRegex<std::string_view>::scan(t, [&](auto&&, std::string_view) { ++n; });
+            return n;
+        }));
+        results.push_back(measure("MemberRegex::scan(预筛)", reps, bytes, [&] {
+            std::size_t n = 0;
+            for (auto&& t : texts)
+                BasicMemberRegex<std::string_view>::scan(t, cs::anchorsOf(t, cs::detail::Candidates), [&](auto&&, std::string_view) { ++n; });
+            return n;
+        }));
+        results.push_back(measure("forEachAnchor", reps, bytes, [&] {
+            std::size_t n = 0;
+            for (auto&& t : texts)
+                cs::forEachAnchor(t, cs::detail::Candidates, [&](AnchorWindow) { ++n; return true; });
+            return n;
+        }));
+        results.push_back(measure("ClassInfo(扫描器)", reps, bytes, [&] {
+            std::size_t n = 0;
+            for (auto&& t : texts)
+                n += memberCount(ClassInfoView(t, Parser::Scanner));
+            return n;
+        }));
+        results.push_back(measure("ClassInfo(正则)", reps, bytes, [&] {
+            std::size_t n = 0;
+            for (auto&& t : texts)
+                n += memberCount(ClassInfoView(t, Parser::Regex));
+            return n;
+        }));
+        results.push_back(measure("matchNamespace", reps, bytes, [&] {
+            std::size_t n = 0;
+            for (auto&& t : texts)
+                n += ClassInfoView::matchNamespace(t).has_value();
+            return n;
+        }));
+        results.push_back(measure("matchNamespace(整段)", reps, bytes, [&] {
+            std::size_t n = 0;
+            for (auto&& t : texts)
+                n += ClassInfoView::matchNamespaceFullScan(t).has_value();
+            return n;
+        }));
+
+        std::vector<ClassInfoView> infos;
+        std::size_t members = 0;
+        for (auto&& t : texts) {
+            infos.emplace_back(t, Parser::Scanner);
+            members += memberCount(infos.back());
+        }
+        std::string buf;
+        results.push_back(measure("formatter<ClassInfo>", reps, bytes, [&] {
+            std::size_t n = 0;
+            for (auto&& info : infos) {
+                buf.clear();
+                std::format_to(std::back_inserter(buf), "{}", info);
+                n += buf.size() > 0;
+            }
+            return n ? members : 0;
+        }));
+
+        // 紧凑表示：收入常驻语料，再从各列格式化
+        results.push_back(measure("apistore::Corpus::add", reps, bytes, [&] {
+            apistore::Corpus corpus;
+            for (auto&& info : infos)
+                corpus.add({}, info);
+            return corpus.memberCount();
+        }));
+        apistore::Corpus corpus;
+        for (auto&& info : infos)
+            corpus.add({}, info);
+        results.push_back(measure("formatter<FileRef>", reps, bytes, [&] {
+            std::size_t n = 0;
+            for (std::uint32_t f = 0; f < corpus.fileCount(); ++f) {
+                buf.clear();
+                std::format_to(std::back_inserter(buf), "{}", corpus.file(f));
+                n += buf.size() > 0;
+            }
+            return n ? members : 0;
+        }));
+
+        // NDJSON 记录，缓冲区复用，同 --format ndjson
+        std::string scope;
+        results.push_back(measure("ndjson::Writer", reps, bytes, [&] {
+            buf.clear();
+            for (auto&& info : infos)
+                ndjson::Writer(buf, scope).file("bench.cs", info);
+            return buf.empty() ? 0 : members;
+        }));
+
+        return results;
+    }
+
+} // namespace bench
@@ -3,8 +3,19 @@
 #include <vector>
 #include <format>
 #include <variant>
-
+#include <tuple>
+#include <array>
+#include <optional>
+#include <string_view>
+#include <span>
+#include <ranges>
+#include <algorithm>
+
+#include "Logger.hpp"
 #include "RegexBuilder.hpp"
+#include "CsScanner.hpp"
+#include "AnchorScan.hpp"
+#include "bench_timer.hpp"
 
 using namespace std::literals;
 
@@ -15,161 +26,185 @@ constexpr std::string_view Identifier = R"([A-Za-z_]\w*)";
 constexpr std::string_view GenericName = R"([A-Za-z_]\w*(?:<[\w,\s<>]+>)?)";
 constexpr std::string_view Parameters = R"([^)]*)";
 
-// ʱƥûmodifier
+// 暂时不匹配没有modifier的语句
 constexpr std::string_view FieldModifier     = R"((?:(?:new|public|protected|internal|private|static|readonly|volatile|unsafe)\s+)+)";
 constexpr std::string_view EventModifier     = R"((?:(?:new|public|protected|internal|private|static|readonly|volatile|unsafe)\s+)+\s*event\s+)";
 constexpr std::string_view ClassModifier     = R"((?:(?:new|public|protected|internal|private|abstract|sealed|static|unsafe)\s+)+)";
-// MethodPropertyEventModifierƶһ
+// Method、Property、Event的Modifier限制都一样
 constexpr std::string_view Modifier    = R"((?:(?:new|public|protected|internal|private|static|virtual|sealed|override|abstract|extern|readonly|unsafe)\s+)+)";
 constexpr std::string_view ConstantModifier  = R"((?:(?:new|public|protected|internal|private)\s+)*\s*const\s+)";
 constexpr std::string_view Super = R"((?:\s*:\s*[\w<>,\.\s]*)?)";
 
+// 解析或输出格式有变化时递增，使增量清单整体失效
+constexpr std::string_view AnalyzerVersion = "8";
+
+/// 成员解析方式：默认走单遍扫描器，正则路径保留用于对照
+enum class Parser {
+    Scanner,
+    Regex,
+};
+
 template <typename T>
-using RegexMatchView = decltype(std::declval<RegexBuilder<T>>().match(std::declval<std::string>()));
+using RegexMatchView = decltype(StaticRegex<T>::match(std::declval<std::string_view>()));
 
-template <typename Derived>
+/// 成员的公共部分；Str 为 std::string 时自持数据，为 std::string_view 时指向源文本，需保证源文本比对象活得久
+template <typename Derived, typename Str = std::string>
 struct Base {
-    std::string modifier;
-    std::string type;              //  / 
-    std::string name;              // 
+    using string_type = Str;
+
+    Str modifier;
+    Str type;              // 数据类型 / 返回类型
+    Str name;              // 名称
 
     static inline constexpr std::string_view modifierRe   = Modifier;
     static inline constexpr std::string_view typeRe       = AntiConstType;
     static inline constexpr std::string_view identifierRe = Identifier;
 
-    static auto& getBuilder() {
-        static auto rb = RegexBuilder<Derived>()
-                              .join(&Derived::modifier, Derived::modifierRe)
-                              .join_with("\\s*", &Derived::type, Derived::typeRe)
-                              .join_with("\\s+", &Derived::name, Derived::identifierRe);
+    // 编译期拼出的正则描述，派生类在此基础上继续 join
+    static constexpr auto builder() {
+        return RegexBuilder<Derived>()
+                   .join(&Derived::modifier, Derived::modifierRe)
+                   .join_with("\\s*", &Derived::type, Derived::typeRe)
+                   .join_with("\\s+", &Derived::name, Derived::identifierRe);
+    }
+
+    // 按 Derived::builder() 特化的匹配器，正则在首次 match 时才编译
+    static const auto& getBuilder() {
+        static constexpr StaticRegex<Derived> rb{};
         return rb;
     }
+
+    // 由扫描器给出的声明构造成员
+    static Derived fromDecl(const cs::Decl& d) {
+        Derived obj;
+        obj.modifier = d.modifier;
+        obj.type = d.type;
+        obj.name = d.name;
+        if constexpr (requires { obj.parameters; })
+            obj.parameters = d.parameters;
+        if constexpr (requires { obj.super; })
+            obj.super = d.super;
+        return obj;
+    }
 };                                                               
 
-struct Method : public Base<Method>{
-    std::string parameters;
-    
+template <typename Str>
+struct BasicMethod : public Base<BasicMethod<Str>, Str> {
+    Str parameters;
+
     static inline constexpr std::string_view identifierRe = GenericName;
-    static auto& getBuilder() {
-        static auto rb = Base<Method>::getBuilder()
-                        .join_with(R"(\s*\()", &Method::parameters, Parameters)
-                        .join(R"(\)\s*(?:\{|=>|;))", false)
-                        .build();
-        return rb;
+    static constexpr auto builder() {
+        return Base<BasicMethod, Str>::builder()
+                        .join_with(R"(\s*\()", &BasicMethod::parameters, Parameters)
+                        .join(R"(\)\s*(?:\{|=>|;))", false);
     }
 };
 
-struct Field : public Base<Field>{
+template <typename Str>
+struct BasicField : public Base<BasicField<Str>, Str> {
     static inline constexpr std::string_view modifierRe = FieldModifier;
-    static auto& getBuilder() {
-        static auto rb = Base<Field>::getBuilder()
+    static constexpr auto builder() {
+        return Base<BasicField, Str>::builder()
                         .join_with("\\s*", "=[^>;]*", "?")
-                        .join(";", false)
-                        .build();
-        return rb;
+                        .join(";", false);
     }
 };
 
-struct Constant : public Base<Constant> {
+template <typename Str>
+struct BasicConstant : public Base<BasicConstant<Str>, Str> {
     static inline constexpr std::string_view modifierRe = ConstantModifier;
-    static inline constexpr std::string_view typeRe = Type;    // Ĭƥeventconst
-    static auto& getBuilder() {
-        static auto rb = Base<Constant>::getBuilder()
+    static inline constexpr std::string_view typeRe = Type;    // 默认情况不会匹配event和const
+    static constexpr auto builder() {
+        return Base<BasicConstant, Str>::builder()
                         .join_with("\\s*", "=[^>;]*", "?")
-                        .join(";", false)
-                        .build();
-        return rb;
+                        .join(";", false);
     }
 };
 
-struct Property : public Base<Property> {
-    static auto& getBuilder() {
-        static auto rb = Base<Property>::getBuilder()
-                        .join_with("\\s*", R"(\{\s*(?:get|set|init)\b|=>)")
-                        .build();
-        return rb;
+template <typename Str>
+struct BasicProperty : public Base<BasicProperty<Str>, Str> {
+    static constexpr auto builder() {
+        return Base<BasicProperty, Str>::builder()
+                        .join_with("\\s*", R"(\{\s*(?:get|set|init)\b|=>)");
     }
 };
 
-struct Event : public Base<Event> {
+template <typename Str>
+struct BasicEvent : public Base<BasicEvent<Str>, Str> {
     static inline constexpr std::string_view modifierRe = EventModifier;
     static inline constexpr std::string_view typeRe = Type;
 
-    static auto& getBuilder() {
-        static auto rb = Base<Event>::getBuilder()
-                        .join_with("\\s*", R"(\{\s*(?:add|remove)\b|=>)")
-                        .build();
-        return rb;
+    static constexpr auto builder() {
+        return Base<BasicEvent, Str>::builder()
+                        .join_with("\\s*", R"(\{\s*(?:add|remove)\b|=>)");
     }
 };
 
-struct ClassLike : public Base<ClassLike> {
+template <typename Str>
+struct BasicClassLike : public Base<BasicClassLike<Str>, Str> {
     static inline constexpr std::string_view modifierRe = ClassModifier;
     static inline constexpr std::string_view typeRe = ClassType;
     static inline constexpr std::string_view identifierRe = GenericName;
 
-    std::string super;            // 
+    Str super;            // 父类
 
-    static auto& getBuilder() {
-        static auto rb = Base<ClassLike>::getBuilder()
-            .join_with("\\s*", &ClassLike::super, Super)
-            .join_with("\\s*", "\\{", false)
-            .build();
-        return rb;
+    static constexpr auto builder() {
+        return Base<BasicClassLike, Str>::builder()
+            .join_with("\\s*", &BasicClassLike::super, Super)
+            .join_with("\\s*", "\\{", false);
     }
 };
 
-template <typename Derived>
-struct std::formatter<Base<Derived>> : std::formatter<std::string> {
-    // ʽ˵Ǻ
+using ClassLike = BasicClassLike<std::string>;
+using Method    = BasicMethod<std::string>;
+using Field     = BasicField<std::string>;
+using Property  = BasicProperty<std::string>;
+using Constant  = BasicConstant<std::string>;
+using Event     = BasicEvent<std::string>;
+
+// 各 formatter 都直接写进 ctx.out()，不经过临时字符串
+template <typename Derived, typename Str>
+struct std::formatter<Base<Derived, Str>> {
+    // 允许格式说明符（这里我们忽略它）
     constexpr auto parse(std::format_parse_context& ctx) { return ctx.begin(); }
 
-    // ʵʵĸʽ߼
-    auto format(const Base<Derived>& b, std::format_context& ctx) const {
-        std::string result;
-        if (!b.modifier.empty())
-            result += b.modifier;   // ڵĲᲶһոֱӾͲӿո
-        result += std::format("{} {}", b.type, b.name);
-        return std::formatter<std::string>::format(result, ctx);
+    // 实际的格式化输出逻辑
+    auto format(const Base<Derived, Str>& b, std::format_context& ctx) const {
+        // 现在的捕获会捕获最后一个空格，输出直接就不加空格了
+        return std::format_to(ctx.out(), "{}{} {}", b.modifier, b.type, b.name);
     }
 };
 
-template <>
-struct std::formatter<Method> : std::formatter<Base<Method>> {
-    auto format(const Method& m, std::format_context& ctx) const {
-        std::string result = std::format("{}", static_cast<const Base<Method>&>(m));
-        if (!m.parameters.empty())
-            result += std::format("({})", m.parameters);
-        else 
-			result += "()";
-        return std::formatter<std::string>::format(result, ctx);
+template <typename Str>
+struct std::formatter<BasicMethod<Str>> : std::formatter<Base<BasicMethod<Str>, Str>> {
+    auto format(const BasicMethod<Str>& m, std::format_context& ctx) const {
+        ctx.advance_to(std::formatter<Base<BasicMethod<Str>, Str>>::format(m, ctx));
+        return std::format_to(ctx.out(), "({})", m.parameters);
     }
 };
 
-template <>
-struct std::formatter<Field> : std::formatter<Base<Field>> {};
+template <typename Str>
+struct std::formatter<BasicField<Str>> : std::formatter<Base<BasicField<Str>, Str>> {};
 
-template <>
-struct std::formatter<Property> : std::formatter<Base<Property>> {};
+template <typename Str>
+struct std::formatter<BasicProperty<Str>> : std::formatter<Base<BasicProperty<Str>, Str>> {};
 
-template <>
-struct std::formatter<Constant> : std::formatter<Base<Constant>> {};
+template <typename Str>
+struct std::formatter<BasicConstant<Str>> : std::formatter<Base<BasicConstant<Str>, Str>> {};
 
-template <>
-struct std::formatter<Event> : std::formatter<Base<Event>> {};
+template <typename Str>
+struct std::formatter<BasicEvent<Str>> : std::formatter<Base<BasicEvent<Str>, Str>> {};
 
-template<>
-struct std::formatter<ClassLike> : std::formatter<Base<ClassLike>> {
-    auto format(const ClassLike& c, std::format_context& ctx) const {
-        std::string result = std::format("{}", static_cast<const Base<ClassLike>&>(c));
-        if (!c.super.empty())
-            result += std::format("{}", c.super);
-        return std::formatter<std::string>::format(result, ctx);
+template <typename Str>
+struct std::formatter<BasicClassLike<Str>> : std::formatter<Base<BasicClassLike<Str>, Str>> {
+    auto format(const BasicClassLike<Str>& c, std::format_context& ctx) const {
+        ctx.advance_to(std::formatter<Base<BasicClassLike<Str>, Str>>::format(c, ctx));
+        return std::format_to(ctx.out(), "{}", c.super);
     }
 };
 
 
-// 洢viewӰformatܣ
+// 存储view很影响format性能，留作备用
 //using AnyMatchView = std::variant<
 //    RegexMatchView<Method>,
 //    RegexMatchView<Field>,
@@ -180,92 +215,308 @@ struct std::formatter<ClassLike> : std::formatter<Base<ClassLike>> {
 //
 //using MemberArr = std::array<std::pair<std::string_view, std::optional<AnyMatchView>>, std::variant_size_v<AnyMatchView>>;
 
-struct ClassInfo;
-
-using AnyMatchView = std::variant<
-    std::vector<ClassLike>,
-    std::vector<Method>,
-    std::vector<Field>,
-    std::vector<Property>,
-    std::vector<Constant>,
-    std::vector<Event>
+template <typename Str>
+using BasicAnyMatchView = std::variant<
+    std::vector<BasicMethod<Str>>,
+    std::vector<BasicField<Str>>,
+    std::vector<BasicProperty<Str>>,
+    std::vector<BasicConstant<Str>>,
+    std::vector<BasicEvent<Str>>
 >;
 
-using MemberArr = std::array<std::pair<std::string_view, AnyMatchView>, std::variant_size_v<AnyMatchView>>;
-
-struct ClassInfo {
-    ClassLike self;
-    std::string namespaceName; // ռ
-
-    MemberArr members;
-    ClassInfo() = default;
-    ClassInfo(const std::string& code) {
-
-        auto r = ClassLike::getBuilder().match(code);
-        for (auto&& v : r) {
-            self = v;
-            break;
+template <typename Str>
+using BasicMemberArr = std::array<std::pair<std::string_view, BasicAnyMatchView<Str>>, std::variant_size_v<BasicAnyMatchView<Str>>>;
+
+using AnyMatchView = BasicAnyMatchView<std::string>;
+using MemberArr = BasicMemberArr<std::string>;
+
+// 所有成员种类合成的一条正则，分支顺序即同一起点时的优先顺序：关键字更明确的种类在前，
+// 避免 public static event ... 之类的声明被较宽松的 Property/Field 抢先匹配
+template <typename Str>
+using BasicMemberRegex = FusedRegex<BasicClassLike<Str>, BasicConstant<Str>, BasicEvent<Str>,
+                                    BasicMethod<Str>, BasicProperty<Str>, BasicField<Str>>;
+
+using MemberRegex = BasicMemberRegex<std::string>;
+
+/// MemberRegex 各分支的名字，与 RegexStats 中的分支编号对应
+inline constexpr std::array<std::string_view, 6> MemberRegexBranches{ "ClassLike", "Constant", "Event", "Method", "Property", "Field" };
+
+/// 一个类型及其成员；Str 为 std::string_view 时即 ClassInfoView，所有成员都指向传入的源文本，不做任何拷贝
+/// 先由 cs::Scanner::outline() 切出各层作用域，匹配只在声明层文本上进行，嵌套类型各自成一层
+template <typename Str>
+struct BasicClassInfo {
+    BasicClassLike<Str> self;
+    Str namespaceName; // 命名空间
+
+    BasicMemberArr<Str> members;
+    std::vector<BasicClassInfo> nested;     // 嵌套类型
+    std::vector<BasicClassInfo> others;     // 同一文件中的其余顶层类型
+
+    BasicClassInfo() = default;
+
+    /// 正则路径按 budget 限额逐条声明匹配，超出限额的声明层文本段改用扫描器；stats 非空时记下各分支的耗时
+    BasicClassInfo(std::string_view code, Parser parser = Parser::Scanner, const RegexBudget& budget = {}, RegexStats* stats = nullptr) {
+        RegexStats local;
+        Run run{ parser, RegexGuard(budget, stats ? *stats : local) };
+        cs::Scanner scanner(code);
+        cs::Outline outline;
+        {
+            PROFILE_SCOPE("ClassInfo::outline");
+            outline = scanner.outline();
+        }
+        LOG_TRACE("声明层文本 {} / {} 字节", outline.visible, code.size());
+
+        PROFILE_SCOPE("ClassInfo::match");
+        auto top = collect(code, outline.spans, run, scanner);
+        if (!outline.types.empty()) {
+            *this = build(code, outline.types.front(), top, run);
+            for (auto&& t : outline.types | std::views::drop(1))
+                others.push_back(build(code, t, top, run));
         }
         if (self.name.empty()) {
-            LOG_WARN("δҵ class ");
+            LOG_WARN("未找到 class 定义");
         }
 
-        if (auto ns = matchNamespace(code)) {
-            namespaceName = *ns;
+        // 文件层零散的声明（如委托）归入第一个类型，与原先整文件匹配的输出保持一致
+        auto stray = toMembers(top);
+        for (std::size_t k = 0; k < members.size(); ++k) {
+            std::visit([&](auto& dst) {
+                auto& src = std::get<std::remove_cvref_t<decltype(dst)>>(stray[k].second);
+                dst.insert(dst.end(), std::make_move_iterator(src.begin()), std::make_move_iterator(src.end()));
+            }, members[k].second);
         }
+
+        std::optional<std::string_view> ns = parser == Parser::Regex ? matchNamespace(code) : scanner.namespaceName();
+        if (ns)
+            namespaceName = *ns;
         else
-            LOG_TRACE("ûҵnamespace");
-
-        members = MemberArr{
-            std::pair{ "ClassLike"sv, r | std::views::drop(1) | std::ranges::to<std::vector>() },
-            std::pair{    "Method"sv,    Method::getBuilder().match(code) | std::ranges::to<std::vector>() },
-            std::pair{     "Field"sv,     Field::getBuilder().match(code) | std::ranges::to<std::vector>() },
-            std::pair{  "Property"sv,  Property::getBuilder().match(code) | std::ranges::to<std::vector>() },
-            std::pair{  "Constant"sv,  Constant::getBuilder().match(code) | std::ranges::to<std::vector>() },
-            std::pair{     "Event"sv,     Event::getBuilder().match(code) | std::ranges::to<std::vector>() },
-        };
+            LOG_TRACE("没找到namespace");
+    }
 
-        //for (auto&& [name, m] : members) {
-        //    std::visit([&](auto&& v) {
-        //        // if (v.empty()) return;
-        //        LOG_DEBUG("{}  {}:\n", v.size(), name);
-        //        for (auto&& mem : v)
-        //            LOG_DEBUG("{}\n", mem);
-        //        }, m);
-        //}
+    /// 预先编译正则路径用到的全部正则，多线程处理前调用；扫描器路径无需编译任何正则
+    static void warmUp(Parser parser) {
+        if (parser != Parser::Regex)
+            return;
+        BasicMemberRegex<Str>::regex();
+        matchNamespace({});
     }
 
-    static std::optional<std::string> matchNamespace(const std::string& code) {
+    static const std::regex& namespaceRegex() {
         static const std::regex nsRe(R"(namespace\s+([\w\.]+)\s*(?:\{|;))");
-        std::smatch m;
-        if (std::regex_search(code, m, nsRe))
-            return m[1].str();
+        return nsRe;
+    }
+
+    // 只在 "namespace + 空白" 处尝试，找到第一个即停
+    static std::optional<std::string_view> matchNamespace(std::string_view code) {
+        std::optional<std::string_view> ns;
+        searchAnchored(code, namespaceRegex(), cs::anchorsOf(code, cs::detail::KwNamespace), [&](const std::cmatch& m) {
+            ns = std::string_view(m[1].first, static_cast<std::size_t>(m[1].length()));
+            return false;
+        });
+        return ns;
+    }
+
+    // 不经预筛的整段搜索，供基准测试对照
+    static std::optional<std::string_view> matchNamespaceFullScan(std::string_view code) {
+        std::cmatch m;
+        if (std::regex_search(code.data(), code.data() + code.size(), m, namespaceRegex()))
+            return std::string_view(m[1].first, static_cast<std::size_t>(m[1].length()));
         return std::nullopt;
     }
+
+private:
+    struct Run {
+        Parser parser;
+        RegexGuard guard;
+    };
+
+    // 一层作用域中匹配到的声明
+    struct Found {
+        std::vector<std::pair<std::size_t, BasicClassLike<Str>>> classes;   // 以匹配终点（类型体 { 之后）对应到子作用域
+        std::vector<BasicMethod<Str>> methods;
+        std::vector<BasicField<Str>> fields;
+        std::vector<BasicProperty<Str>> properties;
+        std::vector<BasicConstant<Str>> constants;
+        std::vector<BasicEvent<Str>> events;
+
+        template <typename T>
+        std::vector<T>& get() {
+            return std::get<std::vector<T>&>(std::tie(methods, fields, properties, constants, events));
+        }
+
+        // 记下各列表的长度，一段文本改用扫描器时先退回到这里
+        std::array<std::size_t, 6> mark() const noexcept {
+            return { classes.size(), methods.size(), fields.size(), properties.size(), constants.size(), events.size() };
+        }
+
+        void rollback(const std::array<std::size_t, 6>& m) {
+            classes.resize(m[0]);
+            methods.resize(m[1]);
+            fields.resize(m[2]);
+            properties.resize(m[3]);
+            constants.resize(m[4]);
+            events.resize(m[5]);
+        }
+    };
+
+    // 各种成员的数量记入分析器，看得出匹配时间花在哪类声明上
+    static void countKinds(const Found& f) {
+        PROFILE_COUNT("ClassInfo/ClassLike", f.classes.size());
+        PROFILE_COUNT("ClassInfo/Method", f.methods.size());
+        PROFILE_COUNT("ClassInfo/Field", f.fields.size());
+        PROFILE_COUNT("ClassInfo/Property", f.properties.size());
+        PROFILE_COUNT("ClassInfo/Constant", f.constants.size());
+        PROFILE_COUNT("ClassInfo/Event", f.events.size());
+    }
+
+    static Found collect(std::string_view code, std::span<const cs::Span> spans, Run& run, cs::Scanner& scanner) {
+        Found f;
+        if (run.parser == Parser::Regex) {
+            PROFILE_SCOPE("MemberRegex::scan");
+            auto& stats = run.guard.stats;
+            for (auto&& span : spans) {
+                auto text = code.substr(span.begin, span.end - span.begin);
+                auto mark = f.mark();
+                if (!stats.timedOut && BasicMemberRegex<Str>::scan(text, cs::anchorsOf(text, cs::detail::Candidates), run.guard,
+                    [&]<typename T>(T&& v, std::string_view m) {
+                        using V = std::remove_cvref_t<T>;
+                        if constexpr (std::is_same_v<V, BasicClassLike<Str>>)
+                            f.classes.emplace_back(static_cast<std::size_t>(m.data() + m.size() - code.data()), std::forward<T>(v));
+                        else
+                            f.template get<V>().push_back(std::forward<T>(v));
+                    }))
+                    continue;
+
+                // 超出限额：这一段整体交给扫描器，已匹配的部分作废
+                f.rollback(mark);
+                ++stats.fallbacks;
+                scanDecls(scanner, std::span<const cs::Span>(&span, 1), f);
+            }
+            countKinds(f);
+            return f;
+        }
+
+        PROFILE_SCOPE("Scanner::scan");
+        scanDecls(scanner, spans, f);
+        countKinds(f);
+        return f;
+    }
+
+    static void scanDecls(cs::Scanner& scanner, std::span<const cs::Span> spans, Found& f) {
+        scanner.scan(spans, [&](const cs::Decl& d) {
+            switch (d.kind) {
+            case cs::DeclKind::ClassLike: f.classes.emplace_back(d.end, BasicClassLike<Str>::fromDecl(d)); break;
+            case cs::DeclKind::Method:    f.methods.push_back(BasicMethod<Str>::fromDecl(d));          break;
+            case cs::DeclKind::Field:     f.fields.push_back(BasicField<Str>::fromDecl(d));            break;
+            case cs::DeclKind::Property:  f.properties.push_back(BasicProperty<Str>::fromDecl(d));     break;
+            case cs::DeclKind::Constant:  f.constants.push_back(BasicConstant<Str>::fromDecl(d));      break;
+            case cs::DeclKind::Event:     f.events.push_back(BasicEvent<Str>::fromDecl(d));            break;
+            }
+        });
+    }
+
+    // parent 为外层作用域的匹配结果，从中取出本类型的声明头；ClassLike 规则匹配不上时直接按声明头解析
+    static BasicClassInfo build(std::string_view code, const cs::TypeScope& scope, const Found& parent, Run& run) {
+        BasicClassInfo info;
+        cs::Scanner scanner(code);
+        auto it = std::ranges::find(parent.classes, scope.open + 1, [](auto&& c) { return c.first; });
+        info.self = it != parent.classes.end() ? it->second : BasicClassLike<Str>::fromDecl(scanner.typeHeader(scope));
+
+        auto found = collect(code, scope.spans, run, scanner);
+        for (auto&& child : scope.nested)
+            info.nested.push_back(build(code, child, found, run));
+        info.members = toMembers(found);
+        return info;
+    }
+
+    static BasicMemberArr<Str> toMembers(Found& f) {
+        return BasicMemberArr<Str>{
+            std::pair{    "Method"sv, std::move(f.methods)    },
+            std::pair{     "Field"sv, std::move(f.fields)     },
+            std::pair{  "Property"sv, std::move(f.properties) },
+            std::pair{  "Constant"sv, std::move(f.constants)  },
+            std::pair{     "Event"sv, std::move(f.events)     },
+        };
+    }
 };
 
-template <>
-struct std::formatter<ClassInfo> : std::formatter<std::string> {
+using ClassInfo = BasicClassInfo<std::string>;
+using ClassInfoView = BasicClassInfo<std::string_view>;
+
+template <typename Str>
+struct std::formatter<BasicClassInfo<Str>> {
     constexpr auto parse(std::format_parse_context& ctx) { return ctx.begin(); }
 
-    auto format(const ClassInfo& c, std::format_context& ctx) const {
-		std::string Աǰ׺ = "  ";
-		std::string ǰ׺ = Աǰ׺ + "    ";
-        std::string out;
+    auto format(const BasicClassInfo<Str>& c, std::format_context& ctx) const {
+        auto out = ctx.out();
         if (!c.namespaceName.empty())
-            out += std::format("namespace {}\n", c.namespaceName);
-        
-        out += std::format("{}\n", c.self);
+            out = std::format_to(out, "namespace {}\n", c.namespaceName);
+
+        out = formatType(out, c, 0);
+        for (auto&& other : c.others)
+            out = formatType(out, other, 0);
+        return out;
+    }
+
+    /// 输出长度的估计（略大于实际），调用方据此一次性预留缓冲区
+    static std::size_t sizeHint(const BasicClassInfo<Str>& c) {
+        std::size_t n = c.namespaceName.size() + 12;
+        n += typeSize(c, 0);
+        for (auto&& other : c.others)
+            n += typeSize(other, 0);
+        return n;
+    }
+
+    static constexpr std::size_t 成员缩进 = 2;      // 分组标题相对类型
+    static constexpr std::size_t 内容缩进 = 6;      // 成员与嵌套类型相对类型
+
+    // 类型自身一行，成员按种类分组缩进；嵌套类型作为一组，整体再缩进一层。也供单独输出一个类型（不含命名空间行）
+    template <typename Out>
+    static Out formatType(Out out, const BasicClassInfo<Str>& c, std::size_t 缩进) {
+        out = std::format_to(out, "{:{}}{}\n", "", 缩进, c.self);
 
         for (auto&& [name, m] : c.members) {
             std::visit([&](auto&& v) {
                 if (v.empty()) return;
-                out += std::format("{}{}  {}:\n", Աǰ׺, v.size(), name);
+                out = std::format_to(out, "{:{}}{} 个 {}:\n", "", 缩进 + 成员缩进, v.size(), name);
                 for (auto&& mem : v)
-                    out += std::format("{}{}\n", ǰ׺, mem);
+                    out = std::format_to(out, "{:{}}{}\n", "", 缩进 + 内容缩进, mem);
                 }, m);
         }
 
-        return std::formatter<std::string>::format(out, ctx);
+        if (!c.nested.empty()) {
+            out = std::format_to(out, "{:{}}{} 个 嵌套类型:\n", "", 缩进 + 成员缩进, c.nested.size());
+            for (auto&& n : c.nested)
+                out = formatType(out, n, 缩进 + 内容缩进);
+        }
+        return out;
+    }
+
+private:
+    template <typename T>
+    static std::size_t lineSize(const T& m) {
+        std::size_t n = m.modifier.size() + m.type.size() + m.name.size() + 4;
+        if constexpr (requires { m.parameters; })
+            n += m.parameters.size() + 2;
+        if constexpr (requires { m.super; })
+            n += m.super.size();
+        return n;
+    }
+
+    static std::size_t typeSize(const BasicClassInfo<Str>& c, std::size_t 缩进) {
+        std::size_t n = 缩进 + lineSize(c.self);
+        for (auto&& [name, m] : c.members) {
+            std::visit([&](auto&& v) {
+                if (v.empty()) return;
+                n += 缩进 + 成员缩进 + name.size() + 16;
+                for (auto&& mem : v)
+                    n += 缩进 + 内容缩进 + lineSize(mem);
+            }, m);
+        }
+        if (!c.nested.empty())
+            n += 缩进 + 成员缩进 + 32;
+        for (auto&& nested : c.nested)
+            n += typeSize(nested, 缩进 + 内容缩进);
+        return n;
     }
 };
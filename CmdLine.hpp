@@ -0,0 +1,310 @@
+#pragma once
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <format>
+#include <stdexcept>
+#include <charconv>
+#include <thread>
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <ranges>
+
+namespace cli {
+
+    namespace fs = std::filesystem;
+
+    enum class Command {
+        Analyze,        // 默认：分析输入目录
+        Query,          // query：在符号索引中查找
+        Bench,          // bench：用合成语料（或回放输入目录）测量各阶段吞吐量
+        Metadata,       // dll：直接读取程序集元数据，不经反编译
+        Diff,           // diff：比较两个版本的 API
+        Serve,          // serve：常驻内存，经本地套接字回答查询
+        Client,         // client：向 serve 发一条请求并打印回应
+        Merge,          // merge：把各分片的结果合并成单机运行的结果
+    };
+
+    enum class Format {
+        Text,           // 默认：每个源文件一个 .out.txt
+        Ndjson,         // --format ndjson：每个类型、成员一行 JSON，写到一个文件或标准输出
+    };
+
+    enum class QueryMode {
+        Symbols,        // 默认：按全名或简单名查找符号，--prefix 时按全名前缀
+        Members,        // --members：列出类型的成员
+        Uses,           // --uses：列出引用了某个类型的成员与类型
+    };
+
+    struct Options {
+        Command command = Command::Analyze;
+        fs::path inputDir  = ".\\input";
+        fs::path outputDir = ".\\output";
+        std::string extension = ".cs";
+        Format format = Format::Text;       // ndjson 时 -o 为输出文件，- 或不指定为标准输出
+        unsigned jobs = 1;                  // 1 为串行，0 表示使用全部硬件线程
+        bool regex = false;                 // 使用旧的正则路径解析，便于与扫描器对照
+        unsigned regexWindow = 4096;        // 正则路径单次尝试的文本上限（字节），超出的声明改用扫描器
+        unsigned regexBudget = 2000;        // 正则路径每个文件的时限（毫秒），0 表示不限
+        fs::path regexStatsFile;            // 非空时写出各文件正则路径的耗时统计
+        bool full = false;                  // 忽略增量清单，全部重新分析
+        bool watch = false;                 // 首轮分析后常驻监视输入目录
+        unsigned debounce = 300;            // 监视模式下文件安静多少毫秒才视为写完
+        bool index = false;                 // 额外生成二进制符号索引 <输出目录>.idx
+        bool profile = false;               // 汇总各作用域耗时，结束时打印统计表
+        fs::path traceFile;                 // 非空时另写 Chrome trace_event JSON（隐含 profile）
+        unsigned shardIndex = 0;            // --shard i/N：只处理第 i 个分片（从 0 开始）
+        unsigned shardCount = 0;            // 分片总数，0 表示不分片
+        QueryMode queryMode = QueryMode::Symbols;
+        bool queryPrefix = false;           // 按前缀而非完整名字匹配
+        std::string query;                  // query 子命令要查找的名字
+
+        // bench 子命令
+        unsigned benchSize = 256;           // 合成语料大小（KB）
+        std::array<unsigned, 5> benchMix{ 6, 4, 4, 1, 1 };     // 方法,字段,属性,常量,事件 的比例
+        unsigned benchDepth = 2;            // 泛型嵌套层数
+        unsigned benchBody = 6;             // 成员体语句行数
+        unsigned benchReps = 10;            // 每项重复次数
+        unsigned benchSeed = 1;
+        bool benchReplay = false;           // 同时回放输入目录下的真实文件
+
+        std::vector<fs::path> assemblies;   // dll 子命令的程序集文件或所在目录
+
+        // diff 子命令
+        std::vector<fs::path> diffSides;    // 旧、新两个版本：索引文件、带索引的输出目录或源码目录
+        fs::path jsonFile;                  // 非空时另写机读的 JSON 报告
+
+        // serve / client 子命令
+        fs::path socketPath;                // 空时为输入目录旁的 <输入目录>.sock
+        std::string request;                // client 发送的请求行
+
+        // merge 子命令
+        std::vector<fs::path> shardOutputs; // 各分片的输出目录（NDJSON 时为输出文件）
+
+        // 命名空间列表，分析与 dll 子命令都可生成
+        fs::path namespaceDir;              // 非空时写出各组的命名空间与类型列表
+        fs::path rootNamespaceDir;          // 非空时写出各组的根命名空间列表
+        std::vector<std::string> namespaceFilters;      // 命名空间前缀，空表示全部
+        unsigned namespaceDepth = 1;        // 相对前缀展开的层数
+        unsigned rootDepth = 1;             // 根命名空间取前几段
+        bool namespaceAllKinds = false;     // 命名空间列表也列结构体与枚举
+
+        bool listsNamespaces() const noexcept { return !namespaceDir.empty() || !rootNamespaceDir.empty(); }
+    };
+
+    inline unsigned parseUnsigned(std::string_view opt, std::string_view text) {
+        unsigned value{};
+        auto [p, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (ec != std::errc{} || p != text.data() + text.size())
+            throw std::runtime_error(std::format("参数 {} 需要非负整数，实际为：{}", opt, text));
+        return value;
+    }
+
+    /// 形如 6,4,4,1,1 的五个比例
+    inline std::array<unsigned, 5> parseMix(std::string_view opt, std::string_view text) {
+        std::array<unsigned, 5> mix{};
+        for (std::size_t k = 0; k < mix.size(); ++k) {
+            auto comma = text.find(',');
+            if ((comma == std::string_view::npos) != (k + 1 == mix.size()))
+                throw std::runtime_error(std::format("参数 {} 需要 5 个以逗号分隔的比例，实际为：{}", opt, text));
+            mix[k] = parseUnsigned(opt, text.substr(0, comma));
+            text.remove_prefix(comma == std::string_view::npos ? text.size() : comma + 1);
+        }
+        if (std::ranges::all_of(mix, [](unsigned v) { return v == 0; }))
+            throw std::runtime_error(std::format("参数 {} 的比例不能全为 0", opt));
+        return mix;
+    }
+
+    /// 逗号分隔的列表，空项忽略
+    inline void appendList(std::vector<std::string>& out, std::string_view text) {
+        for (auto part : text | std::views::split(','))
+            if (!part.empty())
+                out.emplace_back(std::string_view(part));
+    }
+
+    /// 形如 2/8 的分片编号与总数，编号从 0 开始
+    inline void parseShard(std::string_view opt, std::string_view text, unsigned& index, unsigned& count) {
+        auto slash = text.find('/');
+        if (slash == std::string_view::npos)
+            throw std::runtime_error(std::format("参数 {} 需要 编号/总数，如 0/4，实际为：{}", opt, text));
+        index = parseUnsigned(opt, text.substr(0, slash));
+        count = parseUnsigned(opt, text.substr(slash + 1));
+        if (count == 0 || index >= count)
+            throw std::runtime_error(std::format("参数 {} 的编号需小于总数，实际为：{}", opt, text));
+    }
+
+    /// 解析命令行，未知参数直接抛异常；第一个参数为 query、bench、dll、diff、serve、client 或 merge 时进入对应子命令
+    inline Options parse(int argc, char* argv[]) {
+        Options opt;
+        int first = 1;
+        if (argc > 1 && std::string_view(argv[1]) == "query") {
+            opt.command = Command::Query;
+            first = 2;
+        }
+        else if (argc > 1 && std::string_view(argv[1]) == "bench") {
+            opt.command = Command::Bench;
+            first = 2;
+        }
+        else if (argc > 1 && std::string_view(argv[1]) == "dll") {
+            opt.command = Command::Metadata;
+            first = 2;
+        }
+        else if (argc > 1 && std::string_view(argv[1]) == "diff") {
+            opt.command = Command::Diff;
+            first = 2;
+        }
+        else if (argc > 1 && std::string_view(argv[1]) == "serve") {
+            opt.command = Command::Serve;
+            first = 2;
+        }
+        else if (argc > 1 && std::string_view(argv[1]) == "client") {
+            opt.command = Command::Client;
+            first = 2;
+        }
+        else if (argc > 1 && std::string_view(argv[1]) == "merge") {
+            opt.command = Command::Merge;
+            first = 2;
+        }
+        bool debounceSet = false;
+        const bool listing = opt.command == Command::Analyze || opt.command == Command::Metadata || opt.command == Command::Merge;     // 可生成命名空间列表
+        bool outputSet = false;
+        for (int i = first; i < argc; ++i) {
+            std::string_view arg = argv[i];
+            auto value = [&]() -> std::string_view {
+                if (i + 1 >= argc)
+                    throw std::runtime_error(std::format("参数 {} 缺少取值", arg));
+                return argv[++i];
+            };
+
+            if (arg == "--jobs" || arg == "-j")
+                opt.jobs = parseUnsigned(arg, value());
+            else if (arg == "--input" || arg == "-i")
+                opt.inputDir = value();
+            else if (arg == "--output" || arg == "-o") {
+                opt.outputDir = value();
+                outputSet = true;
+            }
+            else if (arg == "--ext")
+                opt.extension = value();
+            else if (arg == "--regex")
+                opt.regex = true;
+            else if (arg == "--regex-window")
+                opt.regexWindow = parseUnsigned(arg, value());
+            else if (arg == "--regex-budget")
+                opt.regexBudget = parseUnsigned(arg, value());
+            else if (opt.command == Command::Analyze && arg == "--regex-stats")
+                opt.regexStatsFile = value();
+            else if (opt.command == Command::Analyze && arg == "--full")
+                opt.full = true;
+            else if (opt.command == Command::Analyze && arg == "--watch")
+                opt.watch = true;
+            else if ((opt.command == Command::Analyze || opt.command == Command::Serve) && arg == "--debounce") {
+                opt.debounce = parseUnsigned(arg, value());
+                debounceSet = true;
+            }
+            else if ((opt.command == Command::Analyze || opt.command == Command::Merge) && arg == "--index")
+                opt.index = true;
+            else if (opt.command == Command::Analyze && arg == "--profile")
+                opt.profile = true;
+            else if (opt.command == Command::Analyze && arg == "--trace") {
+                opt.traceFile = value();
+                opt.profile = true;
+            }
+            else if (opt.command == Command::Analyze && arg == "--shard")
+                parseShard(arg, value(), opt.shardIndex, opt.shardCount);
+            else if ((opt.command == Command::Analyze || opt.command == Command::Merge) && arg == "--format") {
+                auto f = value();
+                if (f == "text")
+                    opt.format = Format::Text;
+                else if (f == "ndjson")
+                    opt.format = Format::Ndjson;
+                else
+                    throw std::runtime_error(std::format("--format 只支持 text 或 ndjson，实际为：{}", f));
+            }
+            else if (listing && arg == "--namespaces")
+                opt.namespaceDir = value();
+            else if (listing && arg == "--root-namespaces")
+                opt.rootNamespaceDir = value();
+            else if (listing && arg == "--ns-filter")
+                appendList(opt.namespaceFilters, value());
+            else if (listing && arg == "--ns-depth")
+                opt.namespaceDepth = parseUnsigned(arg, value());
+            else if (listing && arg == "--root-depth")
+                opt.rootDepth = parseUnsigned(arg, value());
+            else if (listing && arg == "--ns-all-kinds")
+                opt.namespaceAllKinds = true;
+            else if (opt.command == Command::Query && arg == "--prefix")
+                opt.queryPrefix = true;
+            else if (opt.command == Command::Query && arg == "--members")
+                opt.queryMode = QueryMode::Members;
+            else if (opt.command == Command::Query && arg == "--uses")
+                opt.queryMode = QueryMode::Uses;
+            else if (opt.command == Command::Bench && arg == "--size")
+                opt.benchSize = parseUnsigned(arg, value());
+            else if (opt.command == Command::Bench && arg == "--mix")
+                opt.benchMix = parseMix(arg, value());
+            else if (opt.command == Command::Bench && arg == "--depth")
+                opt.benchDepth = parseUnsigned(arg, value());
+            else if (opt.command == Command::Bench && arg == "--body")
+                opt.benchBody = parseUnsigned(arg, value());
+            else if (opt.command == Command::Bench && arg == "--reps")
+                opt.benchReps = parseUnsigned(arg, value());
+            else if (opt.command == Command::Bench && arg == "--seed")
+                opt.benchSeed = parseUnsigned(arg, value());
+            else if (opt.command == Command::Bench && arg == "--replay")
+                opt.benchReplay = true;
+            else if (opt.command == Command::Query && !arg.starts_with('-') && opt.query.empty())
+                opt.query = arg;
+            else if (opt.command == Command::Metadata && !arg.starts_with('-'))
+                opt.assemblies.emplace_back(arg);
+            else if (opt.command == Command::Diff && arg == "--json")
+                opt.jsonFile = value();
+            else if (opt.command == Command::Diff && !arg.starts_with('-') && opt.diffSides.size() < 2)
+                opt.diffSides.emplace_back(arg);
+            else if ((opt.command == Command::Serve || opt.command == Command::Client) && arg == "--socket")
+                opt.socketPath = value();
+            else if (opt.command == Command::Client && !arg.starts_with('-'))
+                opt.request += (opt.request.empty() ? "" : " ") + std::string(arg);
+            else if (opt.command == Command::Merge && !arg.starts_with('-'))
+                opt.shardOutputs.emplace_back(arg);
+            else
+                throw std::runtime_error(std::format("未知参数：{}", arg));
+        }
+
+        if (!opt.regexStatsFile.empty() && !opt.regex)
+            throw std::runtime_error("--regex-stats 需要与 --regex 一起使用");
+        if (opt.command == Command::Analyze && debounceSet && !opt.watch)
+            throw std::runtime_error("--debounce 需要与 --watch 一起使用");
+        if (opt.regexWindow == 0)
+            throw std::runtime_error("--regex-window 需要正整数");
+        if (opt.command == Command::Query && opt.query.empty())
+            throw std::runtime_error("query 需要要查找的名字");
+        if (opt.command == Command::Metadata && opt.assemblies.empty())
+            throw std::runtime_error("dll 需要程序集文件或所在目录");
+        if (opt.command == Command::Diff && opt.diffSides.size() != 2)
+            throw std::runtime_error("diff 需要旧、新两个版本（索引文件、输出目录或源码目录）");
+        if (opt.format == Format::Ndjson) {
+            if (opt.watch || opt.index || opt.full || opt.profile || opt.listsNamespaces())
+                throw std::runtime_error("--format ndjson 不支持 --watch、--index、--full、--profile、--trace 与命名空间列表");
+            if (!outputSet)
+                opt.outputDir = "-";
+        }
+        if (opt.shardCount) {
+            if (opt.watch)
+                throw std::runtime_error("--shard 不支持 --watch");
+            if (opt.format == Format::Ndjson && opt.outputDir == "-")
+                throw std::runtime_error("分片的 NDJSON 需要用 -o 指定输出文件，分片摘要写在它旁边");
+        }
+        if (opt.command == Command::Merge && opt.shardOutputs.empty())
+            throw std::runtime_error("merge 需要各分片的输出目录（NDJSON 时为输出文件）");
+        if (opt.command == Command::Client && opt.request.empty())
+            throw std::runtime_error("client 需要请求，如 type CharacterMainControl");
+        if (opt.queryPrefix && opt.queryMode == QueryMode::Members)
+            throw std::runtime_error("--members 不支持 --prefix");
+        if (opt.jobs == 0)
+            opt.jobs = std::max(std::thread::hardware_concurrency(), 1u);
+        return opt;
+    }
+
+} // namespace cli
@@ -0,0 +1,846 @@
+#pragma once
+#include <string_view>
+#include <array>
+#include <optional>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <span>
+
+// 手写的单遍 C# 声明扫描器，按 ClassInfo.hpp 中各正则的语义逐字符匹配，
+// 一次遍历产出全部成员，跳过注释和字符串字面量
+namespace cs {
+
+    enum class DeclKind : std::uint8_t {
+        ClassLike,
+        Method,
+        Field,
+        Property,
+        Constant,
+        Event,
+    };
+
+    inline constexpr std::size_t DeclKindCount = 6;
+
+    /// 一条声明，各字段均为指向源码的视图
+    struct Decl {
+        DeclKind kind{};
+        std::size_t begin = 0;         // 匹配起点（同正则的整组）
+        std::size_t end = 0;           // 匹配终点
+        std::string_view modifier;
+        std::string_view type;
+        std::string_view name;
+        std::string_view parameters;   // 仅 Method
+        std::string_view super;        // 仅 ClassLike
+    };
+
+    /// 声明层的一段连续源码 [begin, end)，不含注释、成员体与嵌套类型的内容
+    struct Span {
+        std::size_t begin = 0;
+        std::size_t end = 0;
+    };
+
+    /// 类型的作用域：声明头落在父作用域的 spans 中，自己的成员声明在 spans 中，嵌套类型各自成一层
+    struct TypeScope {
+        std::size_t header = 0;        // 声明头起点（上一条语句之后，可能含注释与特性）
+        std::size_t keyword = 0;       // class/struct/interface/enum/record 的位置
+        std::size_t open = 0;          // 类型体的 {
+        std::size_t close = 0;         // 与之匹配的 }
+        std::vector<Span> spans;
+        std::vector<TypeScope> nested;
+    };
+
+    /// 预扫描得到的文件结构
+    struct Outline {
+        std::vector<Span> spans;       // 文件层（含 namespace 块内）的声明文本
+        std::vector<TypeScope> types;  // 顶层类型
+        std::size_t visible = 0;       // 全部 spans 的总长度，即匹配器实际要看的文本量
+    };
+
+    namespace detail {
+        constexpr bool isWord(char c) noexcept {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+        }
+        constexpr bool isIdentStart(char c) noexcept {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+        }
+        constexpr bool isSpace(char c) noexcept {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+        }
+        // [\w<>.,\[\]\s?]
+        constexpr bool isTypeChar(char c) noexcept {
+            return isWord(c) || isSpace(c) || c == '<' || c == '>' || c == '.' || c == ','
+                || c == '[' || c == ']' || c == '?';
+        }
+        // [\w<>,\.\s]
+        constexpr bool isSuperChar(char c) noexcept {
+            return isWord(c) || isSpace(c) || c == '<' || c == '>' || c == ',' || c == '.';
+        }
+        // [\w,\s<>]
+        constexpr bool isGenericChar(char c) noexcept {
+            return isWord(c) || isSpace(c) || c == ',' || c == '<' || c == '>';
+        }
+
+        enum Kw : std::uint32_t {
+            KwNone      = 0,
+            KwNew       = 1u << 0,
+            KwPublic    = 1u << 1,
+            KwProtected = 1u << 2,
+            KwInternal  = 1u << 3,
+            KwPrivate   = 1u << 4,
+            KwStatic    = 1u << 5,
+            KwVirtual   = 1u << 6,
+            KwSealed    = 1u << 7,
+            KwOverride  = 1u << 8,
+            KwAbstract  = 1u << 9,
+            KwExtern    = 1u << 10,
+            KwReadonly  = 1u << 11,
+            KwUnsafe    = 1u << 12,
+            KwVolatile  = 1u << 13,
+            KwConst     = 1u << 14,
+            KwEvent     = 1u << 15,
+            KwClass     = 1u << 16,
+            KwStruct    = 1u << 17,
+            KwInterface = 1u << 18,
+            KwEnum      = 1u << 19,
+            KwNamespace = 1u << 20,
+        };
+
+        // 与 ClassInfo.hpp 中 *Modifier 正则的关键字集合一一对应
+        inline constexpr std::uint32_t AccessSet   = KwNew | KwPublic | KwProtected | KwInternal | KwPrivate;
+        inline constexpr std::uint32_t MemberSet   = AccessSet | KwStatic | KwVirtual | KwSealed | KwOverride
+                                                   | KwAbstract | KwExtern | KwReadonly | KwUnsafe;
+        inline constexpr std::uint32_t FieldSet    = AccessSet | KwStatic | KwReadonly | KwVolatile | KwUnsafe;
+        inline constexpr std::uint32_t ClassSet    = AccessSet | KwAbstract | KwSealed | KwStatic | KwUnsafe;
+        inline constexpr std::uint32_t ConstSet    = AccessSet;
+        inline constexpr std::uint32_t ClassTypes  = KwClass | KwStruct | KwInterface | KwEnum;
+        inline constexpr std::uint32_t Candidates  = MemberSet | FieldSet | ClassSet | KwConst;
+
+        constexpr Kw keyword(std::string_view w) noexcept {
+            switch (w.size()) {
+            case 3:
+                if (w == "new") return KwNew;
+                break;
+            case 4:
+                if (w == "enum") return KwEnum;
+                break;
+            case 5:
+                if (w == "const") return KwConst;
+                if (w == "event") return KwEvent;
+                if (w == "class") return KwClass;
+                break;
+            case 6:
+                if (w == "public") return KwPublic;
+                if (w == "static") return KwStatic;
+                if (w == "sealed") return KwSealed;
+                if (w == "extern") return KwExtern;
+                if (w == "unsafe") return KwUnsafe;
+                if (w == "struct") return KwStruct;
+                break;
+            case 7:
+                if (w == "private") return KwPrivate;
+                if (w == "virtual") return KwVirtual;
+                break;
+            case 8:
+                if (w == "internal") return KwInternal;
+                if (w == "override") return KwOverride;
+                if (w == "abstract") return KwAbstract;
+                if (w == "readonly") return KwReadonly;
+                if (w == "volatile") return KwVolatile;
+                break;
+            case 9:
+                if (w == "protected") return KwProtected;
+                if (w == "interface") return KwInterface;
+                if (w == "namespace") return KwNamespace;
+                break;
+            }
+            return KwNone;
+        }
+    } // namespace detail
+
+    class Scanner {
+    public:
+        explicit Scanner(std::string_view src) noexcept : src_(src) {}
+
+        /// 单遍扫描，每识别出一条声明就调用一次 sink(const Decl&)；声明按出现顺序给出且互不重叠
+        template <typename Sink>
+        void scan(Sink&& sink) {
+            Span all{ 0, src_.size() };
+            scan(std::span<const Span>(&all, 1), sink);
+        }
+
+        /// 只在给定的声明层文本中寻找声明起点，匹配本身仍可读到 span 之后的源码（如成员体的 { get）
+        template <typename Sink>
+        void scan(std::span<const Span> spans, Sink&& sink) {
+            std::size_t lastEnd = 0;
+            for (auto&& span : spans) {
+                lastEnd = std::max(lastEnd, span.begin);
+                scanRange(span.begin, std::min(span.end, src_.size()), lastEnd, sink);
+            }
+        }
+
+        /// 按花括号层次切出类型作用域与声明层文本：跳过注释、字面量和成员体，namespace 块视为透明
+        Outline outline() const {
+            Outline o;
+            for (std::size_t i = 0; i < src_.size(); ++i)    // 文件层多出来的 } 直接跳过
+                i = declLevel(i, o.spans, o.types, o.visible);
+            return o;
+        }
+
+        /// 直接从类型声明头取出 ClassLike，用于 ClassLike 规则匹配不上的写法（无修饰符、record、where 约束等）
+        Decl typeHeader(const TypeScope& t) const noexcept {
+            using namespace detail;
+            std::size_t s = t.header;
+            while (s < t.keyword) {
+                s = skipSpace(s);
+                if (commentAt(s))
+                    s = skipComment(s);
+                else if (at(s) == '[')
+                    s = closing(s, '[', ']') + 1;
+                else
+                    break;
+            }
+            s = std::min(s, t.keyword);
+
+            Decl d;
+            d.kind = DeclKind::ClassLike;
+            d.begin = s;
+            d.modifier = src_.substr(s, t.keyword - s);
+            std::size_t ke = wordEnd(t.keyword);
+            std::size_t p = skipSpace(ke);
+            if (src_.substr(t.keyword, ke - t.keyword) == "record" && (keywordAt(p) & ClassTypes)) {
+                ke = wordEnd(p);        // record struct / record class
+                p = skipSpace(ke);
+            }
+            d.type = src_.substr(t.keyword, ke - t.keyword);
+            std::size_t e = std::min(wordEnd(p), t.open);
+            if (at(e) == '<')
+                e = std::min(closing(e, '<', '>') + 1, t.open);
+            d.name = src_.substr(p, e - p);
+            std::size_t k = std::min(skipSpace(e), t.open);
+            d.super = src_.substr(k, t.open - k);    // 基类、主构造参数与约束原样保留
+            d.end = t.open + 1;
+            return d;
+        }
+
+        /// scan() 过程中遇到的第一个 namespace 名，语义同 ClassInfo::matchNamespace
+        std::optional<std::string_view> namespaceName() const noexcept { return namespace_; }
+
+    private:
+        std::string_view src_;
+        std::optional<std::string_view> namespace_;
+
+        bool commentAt(std::size_t i) const noexcept {
+            return at(i) == '/' && (at(i + 1) == '/' || at(i + 1) == '*');
+        }
+
+        bool literalAt(std::size_t i) const noexcept {
+            char c = at(i);
+            return c == '"' || c == '\''
+                || ((c == '@' || c == '$') && (at(i + 1) == '"' || at(i + 1) == '@' || at(i + 1) == '$'));
+        }
+
+        template <typename Sink>
+        void scanRange(std::size_t i, std::size_t n, std::size_t& lastEnd, Sink& sink) {
+            using namespace detail;
+            while (i < n) {
+                if (commentAt(i)) {
+                    i = skipComment(i);
+                    continue;
+                }
+                if (literalAt(i)) {
+                    i = skipLiteral(i);
+                    continue;
+                }
+                if (!isWord(src_[i])) {
+                    ++i;
+                    continue;
+                }
+
+                std::size_t we = wordEnd(i);
+                if (i > 0 && isWord(src_[i - 1])) {
+                    i = we;
+                    continue;
+                }
+
+                Kw kw = keyword(src_.substr(i, we - i));
+                if (kw & Candidates)
+                    tryAt(i, kw, lastEnd, sink);
+                else if (kw == KwNamespace && !namespace_)
+                    namespace_ = namespaceAt(we);
+                i = we;
+            }
+        }
+
+        // 从 i 处的 open 开始找匹配的 close，跳过注释与字面量；没有匹配时返回文件末尾
+        std::size_t closing(std::size_t i, char open, char close) const noexcept {
+            int depth = 0;
+            while (i < src_.size()) {
+                if (commentAt(i)) {
+                    i = skipComment(i);
+                    continue;
+                }
+                if (literalAt(i)) {
+                    i = skipLiteral(i);
+                    continue;
+                }
+                if (src_[i] == open)
+                    ++depth;
+                else if (src_[i] == close && --depth == 0)
+                    return i;
+                ++i;
+            }
+            return src_.size();
+        }
+
+        enum class Block { Body, Initializer, Type, Namespace };
+
+        // 根据 { 之前的声明头判断这对花括号是什么：类型体、namespace、初始化器（= 之后）还是成员体
+        std::pair<Block, std::size_t> classify(std::size_t b, std::size_t open) const noexcept {
+            using namespace detail;
+            int paren = 0, bracket = 0;
+            bool sawParen = false;
+            std::size_t i = b;
+            while (i < open) {
+                if (commentAt(i)) {
+                    i = skipComment(i);
+                    continue;
+                }
+                if (literalAt(i)) {
+                    i = skipLiteral(i);
+                    continue;
+                }
+                char c = src_[i];
+                if (c == '[')
+                    ++bracket;
+                else if (c == ']')
+                    --bracket;
+                else if (bracket > 0) {}            // 特性里的内容不参与判断
+                else if (c == '(') {
+                    ++paren;
+                    sawParen = true;
+                }
+                else if (c == ')')
+                    --paren;
+                else if (c == '=' && paren == 0)
+                    return { at(i + 1) == '>' ? Block::Body : Block::Initializer, 0 };
+                else if (isIdentStart(c) && (i == b || !isWord(src_[i - 1]))) {
+                    std::size_t e = wordEnd(i);
+                    auto w = src_.substr(i, e - i);
+                    if (w == "namespace")
+                        return { Block::Namespace, i };
+                    if (!sawParen && ((keyword(w) & ClassTypes) || w == "record"))
+                        return { Block::Type, i };
+                    i = e;
+                    continue;
+                }
+                ++i;
+            }
+            return { Block::Body, 0 };
+        }
+
+        // 成员体之后保留 { 与第一个单词，属性/事件的规则要看到 { get、{ add
+        std::size_t bodyPeek(std::size_t open) const noexcept {
+            return wordEnd(skipSpace(open + 1));
+        }
+
+        // 解析一层声明区，直到遇到不属于本层的 } 或文件末尾，返回该位置
+        std::size_t declLevel(std::size_t i, std::vector<Span>& spans, std::vector<TypeScope>& types, std::size_t& visible) const {
+            const std::size_t n = src_.size();
+            std::size_t spanBegin = i, header = i;
+            int namespaces = 0;
+            auto cut = [&](std::size_t end) {
+                if (end > spanBegin) {
+                    spans.push_back({ spanBegin, end });
+                    visible += end - spanBegin;
+                }
+            };
+
+            while (i < n) {
+                if (commentAt(i)) {
+                    cut(i);
+                    i = skipComment(i);
+                    spanBegin = i;
+                    continue;
+                }
+                if (literalAt(i)) {
+                    i = skipLiteral(i);
+                    continue;
+                }
+
+                char c = src_[i];
+                if (c == ';')
+                    header = i + 1;
+                else if (c == '}') {
+                    if (namespaces == 0) {
+                        cut(i);
+                        return i;
+                    }
+                    --namespaces;
+                    header = i + 1;
+                }
+                else if (c == '{') {
+                    auto [kind, kw] = classify(header, i);
+                    if (kind == Block::Namespace) {
+                        ++namespaces;
+                        header = i + 1;
+                    }
+                    else if (kind == Block::Initializer) {
+                        i = std::min(closing(i, '{', '}') + 1, n);
+                        continue;
+                    }
+                    else if (kind == Block::Type) {
+                        cut(i + 1);
+                        TypeScope t;
+                        t.header = header;
+                        t.keyword = kw;
+                        t.open = i;
+                        t.close = declLevel(i + 1, t.spans, t.nested, visible);
+                        types.push_back(std::move(t));
+                        i = spanBegin = header = std::min(types.back().close + 1, n);
+                        continue;
+                    }
+                    else {
+                        cut(bodyPeek(i));
+                        i = spanBegin = header = std::min(closing(i, '{', '}') + 1, n);
+                        continue;
+                    }
+                }
+                ++i;
+            }
+            cut(n);
+            return n;
+        }
+
+        char at(std::size_t i) const noexcept { return i < src_.size() ? src_[i] : '\0'; }
+
+        std::size_t skipSpace(std::size_t i) const noexcept {
+            while (i < src_.size() && detail::isSpace(src_[i]))
+                ++i;
+            return i;
+        }
+
+        std::size_t wordEnd(std::size_t i) const noexcept {
+            while (i < src_.size() && detail::isWord(src_[i]))
+                ++i;
+            return i;
+        }
+
+        detail::Kw keywordAt(std::size_t i) const noexcept {
+            return detail::keyword(src_.substr(i, wordEnd(i) - i));
+        }
+
+        std::size_t skipComment(std::size_t i) const noexcept {
+            if (src_[i + 1] == '/') {
+                auto e = src_.find('\n', i + 2);
+                return e == std::string_view::npos ? src_.size() : e;
+            }
+            auto e = src_.find("*/", i + 2);
+            return e == std::string_view::npos ? src_.size() : e + 2;
+        }
+
+        // 跳过字符/字符串字面量，支持 @"" 逐字、$"" 插值（含嵌套）与 """ 原始字符串
+        std::size_t skipLiteral(std::size_t i) const noexcept {
+            const std::size_t n = src_.size();
+            bool verbatim = false, interpolated = false;
+            while (i < n && (src_[i] == '@' || src_[i] == '$')) {
+                verbatim |= src_[i] == '@';
+                interpolated |= src_[i] == '$';
+                ++i;
+            }
+            if (i >= n)
+                return n;
+
+            char quote = src_[i];
+            if (quote == '"' && src_.substr(i, 3) == R"(""")") {
+                std::size_t q = i;
+                while (q < n && src_[q] == '"')
+                    ++q;
+                std::string_view fence = src_.substr(i, q - i);
+                auto e = src_.find(fence, q);
+                return e == std::string_view::npos ? n : e + fence.size();
+            }
+
+            ++i;
+            while (i < n) {
+                char c = src_[i];
+                if (c == quote) {
+                    if (verbatim && i + 1 < n && src_[i + 1] == quote) {
+                        i += 2;
+                        continue;
+                    }
+                    return i + 1;
+                }
+                if (c == '\\' && !verbatim) {
+                    i += 2;
+                    continue;
+                }
+                if (c == '\n' && !verbatim)
+                    return i;       // 未闭合的普通字面量止于行尾
+                if (interpolated && c == '{') {
+                    if (i + 1 < n && src_[i + 1] == '{') {
+                        i += 2;
+                        continue;
+                    }
+                    i = skipHole(i + 1);
+                    continue;
+                }
+                ++i;
+            }
+            return n;
+        }
+
+        // 插值表达式 {...}，内部可再出现字符串
+        std::size_t skipHole(std::size_t i) const noexcept {
+            const std::size_t n = src_.size();
+            int depth = 1;
+            while (i < n && depth > 0) {
+                char c = src_[i];
+                if (c == '"' || c == '\'' || ((c == '@' || c == '$') && i + 1 < n && (src_[i + 1] == '"' || src_[i + 1] == '@' || src_[i + 1] == '$'))) {
+                    i = skipLiteral(i);
+                    continue;
+                }
+                if (c == '{') ++depth;
+                else if (c == '}') --depth;
+                ++i;
+            }
+            return i;
+        }
+
+        std::optional<std::string_view> namespaceAt(std::size_t i) const noexcept {
+            std::size_t p = skipSpace(i);
+            if (p == i)
+                return std::nullopt;
+            std::size_t e = p;
+            while (e < src_.size() && (detail::isWord(src_[e]) || src_[e] == '.'))
+                ++e;
+            if (e == p)
+                return std::nullopt;
+            std::size_t t = skipSpace(e);
+            if (at(t) != '{' && at(t) != ';')
+                return std::nullopt;
+            return src_.substr(p, e - p);
+        }
+
+        struct Mods {
+            std::array<std::size_t, 16> ends{};   // 第 k 个修饰符（含其后空白）的结束位置
+            std::size_t count = 0;
+        };
+
+        // 等价于 (?:(?:kw1|kw2|...)\s+)+ 的贪婪匹配
+        Mods modifiers(std::size_t i, std::uint32_t set) const noexcept {
+            Mods m;
+            while (m.count < m.ends.size()) {
+                std::size_t e = wordEnd(i);
+                if (e == i || !(detail::keyword(src_.substr(i, e - i)) & set))
+                    break;
+                std::size_t s = skipSpace(e);
+                if (s == e)
+                    break;
+                m.ends[m.count++] = s;
+                i = s;
+            }
+            return m;
+        }
+
+        bool identFull(std::size_t p, std::size_t e) const noexcept {
+            if (p >= e || !detail::isIdentStart(src_[p]))
+                return false;
+            return wordEnd(p) == e;
+        }
+
+        // [A-Za-z_]\w*(?:<[\w,\s<>]+>)? 完整匹配 [p, e)
+        bool genericFull(std::size_t p, std::size_t e) const noexcept {
+            if (p >= e || !detail::isIdentStart(src_[p]))
+                return false;
+            std::size_t i = wordEnd(p);
+            if (i == e)
+                return true;
+            if (src_[i] != '<' || e < i + 3 || src_[e - 1] != '>')
+                return false;
+            for (std::size_t k = i + 1; k + 1 < e; ++k)
+                if (!detail::isGenericChar(src_[k]))
+                    return false;
+            return true;
+        }
+
+        // type\s+name，type 取最长；返回 type/name 之后第一个非类型字符的位置
+        std::size_t typeAndName(std::size_t q, bool antiConst, bool generic, Decl& d) const noexcept {
+            using namespace detail;
+            if (antiConst) {
+                auto kw = keywordAt(q);
+                if (kw == KwConst || kw == KwEvent)
+                    return std::string_view::npos;
+            }
+            std::size_t b = q;
+            while (b < src_.size() && isTypeChar(src_[b]))
+                ++b;
+            std::size_t bt = b;
+            while (bt > q && isSpace(src_[bt - 1]))
+                --bt;
+
+            for (std::size_t p = bt; p > q + 1; --p) {
+                if (!isSpace(src_[p - 1]) || isSpace(src_[p]))
+                    continue;
+                bool ok = generic ? genericFull(p, bt) : identFull(p, bt);
+                if (ok) {
+                    d.type = src_.substr(q, p - 1 - q);
+                    d.name = src_.substr(p, bt - p);
+                    return b;
+                }
+                if (!generic)
+                    break;          // 普通标识符不含空白，只能是最后一段
+            }
+            return std::string_view::npos;
+        }
+
+        // \s*(?:=[^>;]*)?;
+        std::size_t initializerTail(std::size_t b) const noexcept {
+            if (at(b) == '=') {
+                std::size_t i = b + 1;
+                while (i < src_.size() && src_[i] != '>' && src_[i] != ';')
+                    ++i;
+                return at(i) == ';' ? i + 1 : std::string_view::npos;
+            }
+            return at(b) == ';' ? b + 1 : std::string_view::npos;
+        }
+
+        // \{\s*(?:w1|w2|w3)\b|=>
+        std::size_t accessorTail(std::size_t b, std::string_view w1, std::string_view w2, std::string_view w3 = {}) const noexcept {
+            if (at(b) == '=' && at(b + 1) == '>')
+                return b + 2;
+            if (at(b) != '{')
+                return std::string_view::npos;
+            std::size_t i = skipSpace(b + 1);
+            std::size_t e = wordEnd(i);
+            auto w = src_.substr(i, e - i);
+            if (!w.empty() && (w == w1 || w == w2 || w == w3))
+                return e;
+            return std::string_view::npos;
+        }
+
+        bool method(std::size_t s, Decl& d) const noexcept {
+            auto m = modifiers(s, detail::MemberSet);
+            for (std::size_t k = m.count; k >= 1; --k) {
+                std::size_t q = m.ends[k - 1];
+                std::size_t b = typeAndName(q, true, true, d);
+                if (b == std::string_view::npos || at(b) != '(')
+                    continue;
+                auto close = src_.find(')', b + 1);
+                if (close == std::string_view::npos)
+                    continue;
+                std::size_t t = skipSpace(close + 1);
+                std::size_t e = at(t) == '{' || at(t) == ';' ? t + 1
+                              : at(t) == '=' && at(t + 1) == '>' ? t + 2
+                              : std::string_view::npos;
+                if (e == std::string_view::npos)
+                    continue;
+                d.modifier = src_.substr(s, q - s);
+                d.parameters = src_.substr(b + 1, close - b - 1);
+                d.end = e;
+                return true;
+            }
+            return false;
+        }
+
+        bool field(std::size_t s, Decl& d) const noexcept {
+            auto m = modifiers(s, detail::FieldSet);
+            for (std::size_t k = m.count; k >= 1; --k) {
+                std::size_t q = m.ends[k - 1];
+                std::size_t b = typeAndName(q, true, false, d);
+                if (b == std::string_view::npos)
+                    continue;
+                std::size_t e = initializerTail(b);
+                if (e == std::string_view::npos)
+                    continue;
+                d.modifier = src_.substr(s, q - s);
+                d.end = e;
+                return true;
+            }
+            return false;
+        }
+
+        bool property(std::size_t s, Decl& d) const noexcept {
+            auto m = modifiers(s, detail::MemberSet);
+            for (std::size_t k = m.count; k >= 1; --k) {
+                std::size_t q = m.ends[k - 1];
+                std::size_t b = typeAndName(q, true, false, d);
+                if (b == std::string_view::npos)
+                    continue;
+                std::size_t e = accessorTail(b, "get", "set", "init");
+                if (e == std::string_view::npos)
+                    continue;
+                d.modifier = src_.substr(s, q - s);
+                d.end = e;
+                return true;
+            }
+            return false;
+        }
+
+        // (?:(?:new|public|protected|internal|private)\s+)*\s*const\s+，modBegin 可能落在 const 之前的空白上
+        bool constant(std::size_t s, std::size_t modBegin, Decl& d) const noexcept {
+            auto m = modifiers(s, detail::ConstSet);
+            std::size_t c = m.count ? m.ends[m.count - 1] : s;
+            std::size_t ce = wordEnd(c);
+            if (keywordAt(c) != detail::KwConst)
+                return false;
+            std::size_t q = skipSpace(ce);
+            if (q == ce)
+                return false;
+            std::size_t b = typeAndName(q, false, false, d);
+            if (b == std::string_view::npos)
+                return false;
+            std::size_t e = initializerTail(b);
+            if (e == std::string_view::npos)
+                return false;
+            d.begin = modBegin;
+            d.modifier = src_.substr(modBegin, q - modBegin);
+            d.end = e;
+            return true;
+        }
+
+        bool event(std::size_t s, Decl& d) const noexcept {
+            auto m = modifiers(s, detail::FieldSet);
+            if (m.count == 0)
+                return false;
+            std::size_t c = m.ends[m.count - 1];
+            if (keywordAt(c) != detail::KwEvent)
+                return false;
+            std::size_t ce = wordEnd(c);
+            std::size_t q = skipSpace(ce);
+            if (q == ce)
+                return false;
+            std::size_t b = typeAndName(q, false, false, d);
+            if (b == std::string_view::npos)
+                return false;
+            std::size_t e = accessorTail(b, "add", "remove");
+            if (e == std::string_view::npos)
+                return false;
+            d.modifier = src_.substr(s, q - s);
+            d.end = e;
+            return true;
+        }
+
+        // \s*(?:\s*:\s*[\w<>,\.\s]*)?\s*\{
+        std::size_t classTail(std::size_t nameEnd, Decl& d) const noexcept {
+            std::size_t k = skipSpace(nameEnd);
+            if (at(k) == ':') {
+                std::size_t i = k + 1;
+                while (i < src_.size() && detail::isSuperChar(src_[i]))
+                    ++i;
+                if (at(i) != '{')
+                    return std::string_view::npos;
+                d.super = src_.substr(k, i - k);
+                return i + 1;
+            }
+            if (at(k) != '{')
+                return std::string_view::npos;
+            d.super = {};
+            return k + 1;
+        }
+
+        bool classLike(std::size_t s, Decl& d) const noexcept {
+            using namespace detail;
+            auto m = modifiers(s, ClassSet);
+            if (m.count == 0)
+                return false;
+            std::size_t q = m.ends[m.count - 1];
+            if (!(keywordAt(q) & ClassTypes))
+                return false;
+            std::size_t te = wordEnd(q);
+            std::size_t p = skipSpace(te);
+            if (p == te || !isIdentStart(at(p)))
+                return false;
+
+            std::size_t ie = wordEnd(p);
+            std::size_t e = std::string_view::npos;
+            std::size_t nameEnd = ie;
+            if (at(ie) == '<') {
+                std::size_t j = ie + 1;
+                while (j < src_.size() && isGenericChar(src_[j]))
+                    ++j;
+                for (std::size_t c = j; c > ie + 2; --c) {
+                    if (src_[c - 1] != '>')
+                        continue;
+                    e = classTail(c, d);
+                    if (e != std::string_view::npos) {
+                        nameEnd = c;
+                        break;
+                    }
+                }
+            }
+            if (e == std::string_view::npos)
+                e = classTail(ie, d);
+            if (e == std::string_view::npos)
+                return false;
+
+            d.modifier = src_.substr(s, q - s);
+            d.type = src_.substr(q, te - q);
+            d.name = src_.substr(p, nameEnd - p);
+            d.end = e;
+            return true;
+        }
+
+        // 常量的匹配起点：无修饰符时正则会从 const 前的空白开始
+        std::size_t constantBegin(std::size_t i, std::size_t floor) const noexcept {
+            std::size_t b = i;
+            while (b > floor && detail::isSpace(src_[b - 1]))
+                --b;
+            return b;
+        }
+
+        // 与 FusedRegex 相同的重叠策略：起点最靠左者胜出，同一起点按 ClassLike、Constant、Event、Method、Property、Field 的顺序优先，
+        // 已被上一条声明消耗的文本不再尝试
+        template <typename Sink>
+        void tryAt(std::size_t i, detail::Kw kw, std::size_t& lastEnd, Sink& sink) {
+            using namespace detail;
+            if (kw == KwConst) {   // 裸 const 的声明从前面的空白开始，比同一位置的其他种类更靠左
+                tryConstant(i, true, lastEnd, sink);
+                return;
+            }
+            if (i < lastEnd)
+                return;
+
+            auto attempt = [&](DeclKind kind, auto&& matcher) {
+                Decl d;
+                d.kind = kind;
+                d.begin = i;
+                if (!matcher(d))
+                    return false;
+                lastEnd = d.end;
+                sink(static_cast<const Decl&>(d));
+                return true;
+            };
+
+            if ((kw & ClassSet)  && attempt(DeclKind::ClassLike, [&](Decl& d) { return classLike(i, d); }))
+                return;
+            if ((kw & ConstSet)  && tryConstant(i, false, lastEnd, sink))
+                return;
+            if ((kw & FieldSet)  && attempt(DeclKind::Event,     [&](Decl& d) { return event(i, d); }))
+                return;
+            if ((kw & MemberSet) && attempt(DeclKind::Method,    [&](Decl& d) { return method(i, d); }))
+                return;
+            if ((kw & MemberSet) && attempt(DeclKind::Property,  [&](Decl& d) { return property(i, d); }))
+                return;
+            if (kw & FieldSet)
+                attempt(DeclKind::Field, [&](Decl& d) { return field(i, d); });
+        }
+
+        template <typename Sink>
+        bool tryConstant(std::size_t i, bool bare, std::size_t& lastEnd, Sink& sink) {
+            std::size_t begin = bare ? constantBegin(i, lastEnd) : i;
+            if (begin < lastEnd)
+                return false;
+            Decl d;
+            d.kind = DeclKind::Constant;
+            if (!constant(i, begin, d))
+                return false;
+            lastEnd = d.end;
+            sink(static_cast<const Decl&>(d));
+            return true;
+        }
+    };
+
+} // namespace cs
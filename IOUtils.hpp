@@ -5,30 +5,421 @@
 #include <vector>
 #include <format>
 #include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <cstdint>
+#include <cstring>
+#include <bit>
+#include <map>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <atomic>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef NOGDI
+#define NOGDI       // wingdi.h 的 ERROR 宏会和 simplelog::Level::ERROR 冲突
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace IOUtils {
 
     namespace fs = std::filesystem;
     using namespace std::string_literals;
 
-    /// ȡļַ
+    /// 读取整个文件到字符串
     inline std::string read_file(const fs::path& path) {
-        std::ifstream file(path, std::ios::binary);
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
         if (!file)
-            throw std::runtime_error(std::format("޷ļ{}", path.string()));
-        return std::string(std::istreambuf_iterator<char>(file), {});
+            throw std::runtime_error(std::format("无法打开文件：{}", path.string()));
+        std::string content(static_cast<std::size_t>(file.tellg()), '\0');
+        file.seekg(0);
+        file.read(content.data(), static_cast<std::streamsize>(content.size()));
+        return content;
     }
 
-    /// дַļԶĿ¼
-    inline void write_file(const fs::path& path, const std::string& content) {
-        fs::create_directories(path.parent_path());
-        std::ofstream file(path, std::ios::binary);
-        if (!file)
-            throw std::runtime_error(std::format("޷дļ{}", path.string()));
-        file << content;
+    /// 本地代码页的窄字符串转成 UTF-8：源文件按 GBK 保存、未加 /utf-8 编译，Windows 上的字符串字面量与 path::string()
+    /// 都是本地代码页，写给只认 UTF-8 的工具（如 trace JSON）前转换一次；其他平台本来就是 UTF-8，原样返回
+    inline std::string to_utf8(std::string_view s) {
+#if defined(_WIN32)
+        if (s.empty())
+            return {};
+        int wide = MultiByteToWideChar(CP_ACP, 0, s.data(), static_cast<int>(s.size()), nullptr, 0);
+        std::wstring w(static_cast<std::size_t>(wide), L'\0');
+        MultiByteToWideChar(CP_ACP, 0, s.data(), static_cast<int>(s.size()), w.data(), wide);
+        int bytes = WideCharToMultiByte(CP_UTF8, 0, w.data(), wide, nullptr, 0, nullptr, nullptr);
+        std::string out(static_cast<std::size_t>(bytes), '\0');
+        WideCharToMultiByte(CP_UTF8, 0, w.data(), wide, out.data(), bytes, nullptr, nullptr);
+        return out;
+#else
+        return std::string(s);
+#endif
+    }
+
+    /// 把一个码点按 UTF-8 编码追加到 out
+    inline void append_utf8(std::string& out, char32_t c) {
+        if (c < 0x80)
+            out += static_cast<char>(c);
+        else if (c < 0x800) {
+            out += static_cast<char>(0xC0 | (c >> 6));
+            out += static_cast<char>(0x80 | (c & 0x3F));
+        }
+        else if (c < 0x10000) {
+            out += static_cast<char>(0xE0 | (c >> 12));
+            out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (c & 0x3F));
+        }
+        else {
+            out += static_cast<char>(0xF0 | (c >> 18));
+            out += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (c & 0x3F));
+        }
+    }
+
+    /// 快速的 64 位内容哈希，每次吃 8 字节，只用于判断内容是否变化，不抗碰撞攻击
+    inline std::uint64_t hash_bytes(std::string_view data) noexcept {
+        constexpr std::uint64_t k1 = 0x9E3779B97F4A7C15ull, k2 = 0xC2B2AE3D27D4EB4Full;
+        auto mix = [](std::uint64_t h) {
+            h ^= h >> 33; h *= 0xFF51AFD7ED558CCDull;
+            h ^= h >> 33; h *= 0xC4CEB9FE1A85EC53ull;
+            return h ^ (h >> 33);
+        };
+
+        std::uint64_t h = k1 ^ data.size();
+        std::size_t i = 0;
+        for (; i + 8 <= data.size(); i += 8) {
+            std::uint64_t w;
+            std::memcpy(&w, data.data() + i, 8);
+            h = std::rotl(h ^ (w * k2), 31) * k1;
+        }
+        std::uint64_t tail = 0;
+        std::memcpy(&tail, data.data() + i, data.size() - i);
+        return mix(h ^ (tail * k2));
+    }
+
+    /// 只读内存映射整个文件，view() 在对象存活期间有效；空文件得到空视图
+    class MappedFile {
+    public:
+        explicit MappedFile(const fs::path& path) {
+#if defined(_WIN32)
+            // 允许其他进程同时改写、删除或替换该文件（ilspycmd 重写输入、write_file 替换 .idx），被替换时映射仍指向旧文件
+            file_ = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                                OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (file_ == INVALID_HANDLE_VALUE)
+                throw std::runtime_error(std::format("无法打开文件：{}", path.string()));
+            LARGE_INTEGER size{};
+            if (!GetFileSizeEx(file_, &size)) {
+                close();
+                throw std::runtime_error(std::format("无法获取文件大小：{}", path.string()));
+            }
+            size_ = static_cast<std::size_t>(size.QuadPart);
+            if (size_ == 0)
+                return;
+            mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping_)
+                data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+#else
+            fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd_ < 0)
+                throw std::runtime_error(std::format("无法打开文件：{}", path.string()));
+            struct stat st{};
+            if (::fstat(fd_, &st) != 0) {
+                close();
+                throw std::runtime_error(std::format("无法获取文件大小：{}", path.string()));
+            }
+            size_ = static_cast<std::size_t>(st.st_size);
+            if (size_ == 0)
+                return;
+            void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+            if (p != MAP_FAILED) {
+                data_ = static_cast<const char*>(p);
+                ::madvise(p, size_, MADV_SEQUENTIAL);
+            }
+#endif
+            if (!data_) {
+                close();
+                throw std::runtime_error(std::format("无法映射文件：{}", path.string()));
+            }
+        }
+
+        MappedFile(MappedFile&& other) noexcept { swap(other); }
+        MappedFile& operator=(MappedFile&& other) noexcept {
+            MappedFile(std::move(other)).swap(*this);
+            return *this;
+        }
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile() { close(); }
+
+        std::string_view view() const noexcept { return { data_ ? data_ : "", size_ }; }
+        std::size_t size() const noexcept { return size_; }
+
+    private:
+        const char* data_ = nullptr;
+        std::size_t size_ = 0;
+#if defined(_WIN32)
+        HANDLE file_ = INVALID_HANDLE_VALUE;
+        HANDLE mapping_ = nullptr;
+#else
+        int fd_ = -1;
+#endif
+
+        void swap(MappedFile& other) noexcept {
+            std::swap(data_, other.data_);
+            std::swap(size_, other.size_);
+#if defined(_WIN32)
+            std::swap(file_, other.file_);
+            std::swap(mapping_, other.mapping_);
+#else
+            std::swap(fd_, other.fd_);
+#endif
+        }
+
+        void close() noexcept {
+#if defined(_WIN32)
+            if (data_)
+                UnmapViewOfFile(data_);
+            if (mapping_)
+                CloseHandle(mapping_);
+            if (file_ != INVALID_HANDLE_VALUE)
+                CloseHandle(file_);
+            mapping_ = nullptr;
+            file_ = INVALID_HANDLE_VALUE;
+#else
+            if (data_)
+                ::munmap(const_cast<char*>(data_), size_);
+            if (fd_ >= 0)
+                ::close(fd_);
+            fd_ = -1;
+#endif
+            data_ = nullptr;
+        }
+    };
+
+    /// path 旁的临时文件名，带进程号与计数器，多个进程或线程同时写同一路径时互不覆盖
+    inline fs::path temp_path(const fs::path& path) {
+        static std::atomic<unsigned> counter{ 0 };
+#if defined(_WIN32)
+        const auto pid = GetCurrentProcessId();
+#else
+        const auto pid = getpid();
+#endif
+        auto tmp = path;
+        tmp += std::format(".{}.{}.tmp", pid, counter.fetch_add(1, std::memory_order_relaxed));
+        return tmp;
+    }
+
+    /// 内容与磁盘上的文件完全相同时不写并返回 false；否则先写临时文件再改名替换，中途失败不会留下半个文件
+    inline bool write_atomic(const fs::path& path, std::string_view content) {
+        std::error_code ec;
+        if (fs::file_size(path, ec) == content.size() && !ec) {
+            if (content.empty())
+                return false;
+            MappedFile old(path);
+            if (old.view() == content)
+                return false;
+        }
+
+        const auto tmp = temp_path(path);
+        try {
+            {
+                std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+                if (!file || !file.write(content.data(), static_cast<std::streamsize>(content.size())))
+                    throw std::runtime_error(std::format("无法写入文件：{}", tmp.string()));
+            }
+            fs::rename(tmp, path);
+        } catch (...) {
+            fs::remove(tmp, ec);
+            throw;
+        }
+        return true;
+    }
+
+    /// 写字符串到文件（自动创建父目录），同 write_atomic
+    inline bool write_file(const fs::path& path, std::string_view content) {
+        if (path.has_parent_path())
+            fs::create_directories(path.parent_path());
+        return write_atomic(path, content);
+    }
+
+    /// 两个文件的内容是否逐字节相同
+    inline bool same_content(const fs::path& a, const fs::path& b) {
+        return MappedFile(a).view() == MappedFile(b).view();
+    }
+
+    /// 让 dst 成为 src 的硬链接；文件系统不支持（跨卷、FAT 等）时退回复制。
+    /// 先建到临时名再改名覆盖，已有的 dst 不会出现半截内容；之后改写任一方都是写新文件再改名，不会波及另一方。
+    /// 返回是否真的建了硬链接
+    inline bool link_or_copy(const fs::path& src, const fs::path& dst) {
+        std::error_code ec;
+        if (fs::equivalent(src, dst, ec))
+            return true;
+
+        fs::create_directories(dst.parent_path());
+        const auto tmp = temp_path(dst);
+        fs::create_hard_link(src, tmp, ec);
+        bool linked = !ec;
+        try {
+            if (!linked)
+                fs::copy_file(src, tmp, fs::copy_options::overwrite_existing);
+            fs::rename(tmp, dst);
+        } catch (...) {
+            fs::remove(tmp, ec);
+            throw;
+        }
+        return linked;
+    }
+
+    /// 后台单线程写出文件：处理线程只把内容放进队列，队列按字节数限流；
+    /// 建过的目录记下来不再重复 create_directories，同一批里同一路径只写最后一份
+    class AsyncWriter {
+    public:
+        struct Stats {
+            std::size_t written = 0;       // 实际写出的文件数
+            std::size_t unchanged = 0;     // 内容与磁盘相同而跳过的文件数
+        };
+
+        explicit AsyncWriter(std::size_t maxPendingBytes = 64u << 20) : maxPending_(maxPendingBytes) {
+            thread_ = std::jthread([this] { run(); });
+        }
+
+        /// 写完队列中剩余的文件后退出；此时的错误无法再抛出，需要结果的调用方应先 flush()
+        ~AsyncWriter() {
+            {
+                std::lock_guard lock(mutex_);
+                stopping_ = true;
+            }
+            workCv_.notify_one();
+        }
+
+        AsyncWriter(const AsyncWriter&) = delete;
+        AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+        /// 取一块写完回收的缓冲区（已清空、保留容量），没有时返回空串；配合 submit 循环使用可避免反复分配
+        std::string acquire() {
+            std::lock_guard lock(mutex_);
+            if (spare_.empty())
+                return {};
+            auto buf = std::move(spare_.back());
+            spare_.pop_back();
+            return buf;
+        }
+
+        /// 排队写出，积压超过上限时阻塞到后台线程写完一批
+        void submit(fs::path path, std::string content) {
+            std::unique_lock lock(mutex_);
+            doneCv_.wait(lock, [&] { return pending_ == 0 || pending_ + content.size() <= maxPending_; });
+            pending_ += content.size();
+            queue_.push_back({ std::move(path), std::move(content) });
+            lock.unlock();
+            workCv_.notify_one();
+        }
+
+        /// 等待已提交的文件全部落盘，返回累计统计；后台写出失败时在这里重新抛出第一个异常
+        Stats flush() {
+            std::unique_lock lock(mutex_);
+            doneCv_.wait(lock, [&] { return queue_.empty() && !busy_; });
+            if (auto e = std::exchange(error_, nullptr))
+                std::rethrow_exception(e);
+            return stats_;
+        }
+
+    private:
+        struct Job {
+            fs::path path;
+            std::string content;
+        };
+
+        static constexpr std::size_t MaxSpare = 64;
+
+        std::size_t maxPending_;
+        std::mutex mutex_;
+        std::condition_variable workCv_, doneCv_;
+        std::vector<Job> queue_;
+        std::size_t pending_ = 0;          // 队列与正在写的批次共占用的字节数
+        bool busy_ = false;
+        bool stopping_ = false;
+        Stats stats_;
+        std::exception_ptr error_;
+        std::vector<std::string> spare_;   // 写完的缓冲区，留给 acquire()
+        std::set<fs::path> dirs_;          // 只在后台线程访问
+        std::jthread thread_;              // 最后声明，析构时先汇合线程
+
+        void run() {
+            std::unique_lock lock(mutex_);
+            while (true) {
+                workCv_.wait(lock, [&] { return !queue_.empty() || stopping_; });
+                if (queue_.empty())
+                    return;
+                auto batch = std::exchange(queue_, {});
+                busy_ = true;
+                lock.unlock();
+
+                std::map<fs::path, std::size_t> last;
+                for (std::size_t i = 0; i < batch.size(); ++i)
+                    last[batch[i].path] = i;
+
+                Stats delta;
+                std::size_t bytes = 0;
+                std::exception_ptr error;
+                for (std::size_t i = 0; i < batch.size(); ++i) {
+                    bytes += batch[i].content.size();
+                    if (last[batch[i].path] != i)
+                        continue;
+                    try {
+                        auto dir = batch[i].path.parent_path();
+                        if (!dir.empty() && !dirs_.contains(dir)) {
+                            fs::create_directories(dir);
+                            dirs_.insert(std::move(dir));
+                        }
+                        ++(write_atomic(batch[i].path, batch[i].content) ? delta.written : delta.unchanged);
+                    }
+                    catch (...) {
+                        if (!error)
+                            error = std::current_exception();
+                    }
+                }
+
+                lock.lock();
+                for (auto& job : batch) {
+                    if (spare_.size() >= MaxSpare)
+                        break;
+                    job.content.clear();
+                    spare_.push_back(std::move(job.content));
+                }
+                stats_.written += delta.written;
+                stats_.unchanged += delta.unchanged;
+                if (error && !error_)
+                    error_ = error;
+                pending_ -= bytes;
+                busy_ = false;
+                doneCv_.notify_all();
+            }
+        }
+    };
+
+    /// 输出目录旁的同名附属文件，例如 (output, ".manifest") -> output.manifest
+    inline fs::path sibling_path(const fs::path& dir, std::string_view suffix) {
+        auto abs = fs::absolute(dir).lexically_normal();
+        if (!abs.has_filename())
+            abs = abs.parent_path();
+        return abs.parent_path() / (abs.filename().string() + std::string(suffix));
     }
 
-    /// ɨĿ¼ָչļĬ `.cs`
+    /// 扫描目录下所有指定扩展名的文件（默认 `.cs`）
     template <bool Recursive = true>
     inline std::vector<fs::path> list_files(
         const fs::path& root,
@@ -36,7 +427,7 @@ namespace IOUtils {
     {
         std::vector<fs::path> results;
         if (!fs::exists(root))
-            throw std::runtime_error(std::format("·ڣ{}", root.string()));
+            throw std::runtime_error(std::format("路径不存在：{}", root.string()));
 
         using DirIter = std::conditional_t<Recursive, fs::recursive_directory_iterator, fs::directory_iterator>;
         for (const auto& entry : DirIter(root)) {
@@ -47,7 +438,7 @@ namespace IOUtils {
         return results;
     }
 
-    /// ļ·ļ·ֲ㼶
+    /// 根据输入文件路径生成输出文件路径（保持层级）
     inline fs::path make_output_path(
         const fs::path& inputFile,
         const fs::path& inputRoot,
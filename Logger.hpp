@@ -2,15 +2,18 @@
 #include <iostream>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <format>
 #include <chrono>
 #include <ctime>
 #include <atomic>
+#include <array>
+#include <thread>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
 #include <stacktrace>
 #include <source_location>
-#include <sstream>
-#include <iomanip>
-#include <filesystem>
 
 namespace simplelog {
     enum class Level {
@@ -22,41 +25,123 @@ namespace simplelog {
         FATAL
     };
 
-#define LOG_LEVEL Level::DEBUG     // ʼӡĵȼ
-#define ST_LEVEL  Level::ERROR     // ӡջٵʼȼ
+#define LOG_LEVEL Level::DEBUG     // 开始打印的等级
+#define ST_LEVEL  Level::ERROR     // 打印栈踪的起始等级
+
+    // 编译期最低等级，低于它的 LOG_* 整条语句被丢弃，参数也不会求值；可在编译选项中覆盖，如 /DLOG_COMPILE_LEVEL=INFO
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL DEBUG
+#endif
+    inline constexpr Level CompileLevel = Level::LOG_COMPILE_LEVEL;
 
     enum class FunctionFormat {
-        None,   // ʾ
-        Short,  // ֻʾ
-        Full    // ǩĬϣ
+        None,   // 不显示函数名
+        Short,  // 只显示函数名
+        Full    // 完整函数签名（默认）
     };
 
     struct LogConfig {
         bool show_time = true;
         bool show_location = true;
         bool show_level = true;
-        bool short_path = true;   // ʾļ·
+        bool short_path = true;   // 仅显示文件名，不含路径
         FunctionFormat function_format = FunctionFormat::Short;
     };
 
     inline constexpr std::string_view toString(Level lvl) noexcept {
         switch (lvl) {
-        case Level::TRACE: return "׷";
-        case Level::DEBUG: return "";
-        case Level::INFO:  return "Ϣ";
-        case Level::WARN:  return "";
-        case Level::ERROR: return "";
-        case Level::FATAL: return "";
-        }
-        return "δ֪";
+        case Level::TRACE: return "追踪";
+        case Level::DEBUG: return "调试";
+        case Level::INFO:  return "信息";
+        case Level::WARN:  return "警告";
+        case Level::ERROR: return "错误";
+        case Level::FATAL: return "致命";
+        }
+        return "未知";
     }
 
+    /// 有界多生产者多消费者无锁环形队列（Vyukov），每个槽位用序号区分空/满，满时 push 直接失败
+    template <typename T, std::size_t N>
+    class MpmcRing {
+        static_assert((N & (N - 1)) == 0, "容量必须是 2 的幂");
+    public:
+        MpmcRing() {
+            for (std::size_t i = 0; i < N; ++i)
+                cells_[i].seq.store(i, std::memory_order_relaxed);
+        }
+
+        bool try_push(T&& value) {
+            auto pos = head_.load(std::memory_order_relaxed);
+            while (true) {
+                auto& cell = cells_[pos & (N - 1)];
+                auto seq = cell.seq.load(std::memory_order_acquire);
+                auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+                if (diff == 0) {
+                    if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        cell.value = std::move(value);
+                        cell.seq.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                    return false;
+                else
+                    pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+
+        bool try_pop(T& out) {
+            auto pos = tail_.load(std::memory_order_relaxed);
+            while (true) {
+                auto& cell = cells_[pos & (N - 1)];
+                auto seq = cell.seq.load(std::memory_order_acquire);
+                auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+                if (diff == 0) {
+                    if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        out = std::move(cell.value);
+                        cell.seq.store(pos + N, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                    return false;
+                else
+                    pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        struct Cell {
+            std::atomic<std::size_t> seq;
+            T value;
+        };
+
+        std::array<Cell, N> cells_;
+        alignas(64) std::atomic<std::size_t> head_{ 0 };
+        alignas(64) std::atomic<std::size_t> tail_{ 0 };
+    };
+
+    /// 调用线程只负责格式化并放进无锁队列，由后台线程统一写出，顺序与调用顺序一致。
+    /// 队列满时 INFO 及以上等待后台线程腾出槽位，TRACE/DEBUG 丢弃并计数；ERROR 及以上入队后等到写出才返回
     class Logger {
     public:
         Logger(std::ostream& os = std::clog)
             : out(os), minLevel(LOG_LEVEL), printStacktraceFrom(ST_LEVEL) {
+            sink_ = std::thread([this] { drainLoop(); });
+        }
+
+        ~Logger() {
+            stopping_.store(true);
+            wake();
+            if (sink_.joinable())
+                sink_.join();
+            if (auto n = dropped_.load())
+                out << std::format("[LoggerWarning] 日志队列已满，共丢弃 {} 条\n", n) << std::flush;
         }
 
+        Logger(const Logger&) = delete;
+        Logger& operator=(const Logger&) = delete;
+
         void setMinLevel(Level lvl) noexcept {
             minLevel.store(lvl, std::memory_order_relaxed);
         }
@@ -70,12 +155,28 @@ namespace simplelog {
             config_ = cfg;
         }
 
-        // 
+        // 警惕悬垂
         void setOutput(std::ostream& newOut) noexcept {
+            flush();
             std::lock_guard lock(mutex_);
             out.rdbuf(newOut.rdbuf());
         }
 
+        /// 编译期与运行期等级都通过时才需要格式化
+        bool enabled(Level lvl) const noexcept {
+            return lvl >= CompileLevel && lvl >= minLevel.load(std::memory_order_relaxed);
+        }
+
+        /// 因队列满而丢弃的 TRACE/DEBUG 条数
+        std::uint64_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+
+        /// 等待此前入队的日志全部写出
+        void flush() noexcept {
+            auto target = pushed_.load();
+            for (auto done = written_.load(); done < target; done = written_.load())
+                written_.wait(done);
+        }
+
         template <typename... Args>
         void log(Level lvl,
             std::string_view fmt,
@@ -83,53 +184,31 @@ namespace simplelog {
             Args&&... args
         ) noexcept
         {
-            if (lvl < minLevel.load(std::memory_order_relaxed))
+            if (!enabled(lvl))
                 return;
 
             try {
-                std::ostringstream prefix;
-                if (config_.show_time) {
-                    auto now = std::chrono::system_clock::now();
-                    auto t = std::chrono::system_clock::to_time_t(now);
-                    std::tm tm{};
-#if defined(_WIN32)
-                    localtime_s(&tm, &t);
-#else
-                    localtime_r(&t, &tm);
-#endif
-                    prefix << std::put_time(&tm, "[%H:%M:%S] ");
-                }
-
-                if (config_.show_level)
-                    prefix << std::format("[{}] ", toString(lvl));
-
-                if (config_.show_location) {
-                    std::string file = config_.short_path
-                        ? std::filesystem::path{ loc.file_name() }.filename().string()
-                        : std::string{ loc.file_name() };
-                    prefix << file << ':' << loc.line();
-                    if (config_.function_format != FunctionFormat::None) {
-                        if (config_.function_format == FunctionFormat::Full) {
-                            prefix << ' ' << loc.function_name();
-                        }
-                        else {
-                            prefix << ' ' << extractShortFunction(loc.function_name());
-                        }
-                    }
-                    prefix << ": ";
-                }
-
-                std::string msg = std::vformat(fmt, std::make_format_args(args...));
+                std::string output = prefix(lvl, loc);
+                std::vformat_to(std::back_inserter(output), fmt, std::make_format_args(args...));
+                output += '\n';
+                if (lvl >= printStacktraceFrom.load(std::memory_order_relaxed))
+                    output += std::format("---- Stacktrace ----\n{}\n", std::to_string(std::stacktrace::current()));
 
-                // С
-                std::string output = prefix.str() + msg + '\n';
-                {
-                    std::lock_guard<std::mutex> lock(mutex_);
-                    out << output;
-                    if (lvl >= printStacktraceFrom.load()) {
-                        out << "---- Stacktrace ----\n" << std::stacktrace::current() << '\n';
+                // 先取写出计数再尝试入队，等待期间后台线程写出的批次不会被漏掉
+                auto done = written_.load();
+                while (!queue_.try_push(std::move(output))) {
+                    if (lvl < Level::INFO) {
+                        dropped_.fetch_add(1, std::memory_order_relaxed);
+                        return;
                     }
+                    wake();
+                    written_.wait(done);
+                    done = written_.load();
                 }
+                pushed_.fetch_add(1);
+                wake();
+                if (lvl >= Level::ERROR)
+                    flush();        // 之前排队的日志与这一条都已写出
             }
             catch (const std::exception& e) {
                 std::cerr << "[LoggerError] Failed to format log message: " << e.what()
@@ -139,50 +218,141 @@ namespace simplelog {
 
     private:
         std::ostream& out;
-        std::mutex mutex_;
+        std::mutex mutex_;          // 只保护输出流与配置
         LogConfig config_;
         std::atomic<Level> minLevel;
         std::atomic<Level> printStacktraceFrom;
 
-        // ǩȡ
-        inline std::string extractShortFunction(std::string_view fullName) noexcept {
-            // ҵһ '('
+        MpmcRing<std::string, 8192> queue_;
+        std::atomic<std::uint64_t> pushed_{ 0 };
+        std::atomic<std::uint64_t> written_{ 0 };
+        std::atomic<std::uint64_t> dropped_{ 0 };
+        std::atomic<std::uint32_t> signal_{ 0 };    // 每次入队自增，后台线程在它上面等待
+        std::atomic<bool> sleeping_{ false };
+        std::atomic<bool> stopping_{ false };
+        std::thread sink_;
+
+        // 后台线程睡着时才需要系统调用唤醒
+        void wake() noexcept {
+            signal_.fetch_add(1);
+            if (sleeping_.load())
+                signal_.notify_one();
+        }
+
+        void drainLoop() {
+            std::string msg;
+            while (true) {
+                auto seen = signal_.load();
+                std::uint64_t n = 0;
+                {
+                    std::lock_guard lock(mutex_);
+                    while (queue_.try_pop(msg)) {
+                        out << msg;
+                        ++n;
+                    }
+                    if (n)
+                        out.flush();
+                }
+                if (n) {
+                    written_.fetch_add(n);
+                    written_.notify_all();
+                    continue;
+                }
+                if (stopping_.load())
+                    return;
+                sleeping_.store(true);
+                if (signal_.load() == seen)
+                    signal_.wait(seen);
+                sleeping_.store(false);
+            }
+        }
+
+        // 同一秒内复用已格式化的时间
+        static std::string_view clockText() {
+            thread_local std::time_t cached = -1;
+            thread_local char text[16]{};
+            auto t = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+            if (t != cached) {
+                std::tm tm{};
+#if defined(_WIN32)
+                localtime_s(&tm, &t);
+#else
+                localtime_r(&t, &tm);
+#endif
+                *std::format_to_n(text, sizeof(text) - 1, "[{:02}:{:02}:{:02}] ", tm.tm_hour, tm.tm_min, tm.tm_sec).out = '\0';
+                cached = t;
+            }
+            return text;
+        }
+
+        std::string prefix(Level lvl, const std::source_location& loc) const {
+            std::string p;
+            if (config_.show_time)
+                p += clockText();
+
+            if (config_.show_level)
+                std::format_to(std::back_inserter(p), "[{}] ", toString(lvl));
+
+            if (config_.show_location) {
+                std::string_view file = loc.file_name();
+                if (config_.short_path)
+                    file = file.substr(file.find_last_of("/\\") + 1);
+                std::format_to(std::back_inserter(p), "{}:{}", file, loc.line());
+                if (config_.function_format != FunctionFormat::None) {
+                    p += ' ';
+                    p += config_.function_format == FunctionFormat::Full
+                        ? std::string_view(loc.function_name())
+                        : extractShortFunction(loc.function_name());
+                }
+                p += ": ";
+            }
+            return p;
+        }
+
+        // 从完整函数签名中提取函数名
+        static std::string_view extractShortFunction(std::string_view fullName) noexcept {
+            // 找到第一个 '('
             size_t paren = fullName.find('(');
             if (paren == std::string_view::npos)
                 paren = fullName.size();
 
-            //  '(' ǰɨ裬ո*&:
+            // 从 '(' 向前扫描，跳过空格、*、&、:
             size_t end = paren;
             size_t i = end;
-            while (i > 0 && (std::isspace((unsigned char)fullName[i - 1]) ||
-                fullName[i - 1] == '*' || fullName[i - 1] == '&' ||
+            while (i > 0 && (fullName[i - 1] == ' ' || fullName[i - 1] == '*' || fullName[i - 1] == '&' ||
                 fullName[i - 1] == ':'))
                 --i;
 
-            // ʱ i ָĩβ
+            // 此时 i 指向函数名末尾
             size_t j = i;
-            while (j > 0 && (std::isalnum((unsigned char)fullName[j - 1]) || fullName[j - 1] == '_'))
+            while (j > 0 && ((fullName[j - 1] >= 'a' && fullName[j - 1] <= 'z') || (fullName[j - 1] >= 'A' && fullName[j - 1] <= 'Z') ||
+                (fullName[j - 1] >= '0' && fullName[j - 1] <= '9') || fullName[j - 1] == '_'))
                 --j;
 
             if (i > j)
-                return std::string(fullName.substr(j, i - j));
+                return fullName.substr(j, i - j);
 
-            // fallbackδƥԭ
-            return std::string(fullName);
+            // fallback：未匹配则原样返回
+            return fullName;
         }
     };
 
-    // ȫĬ logger
+    // 全局默认 logger
     inline Logger& defaultLogger() {
         static Logger logger{};
         return logger;
     }
 
 
-    // װԶ source_location
+    // 宏封装（自动捕获 source_location）；低于编译期等级的整条丢弃，低于运行期等级的不求值参数
 // TRACE
 #define LOG_IMPL(lvl, fmt, ...) \
-    ::simplelog::defaultLogger().log(lvl, fmt, std::source_location::current() __VA_OPT__(,) __VA_ARGS__)
+    do { \
+        if constexpr ((lvl) >= ::simplelog::CompileLevel) { \
+            if (auto& logger_ = ::simplelog::defaultLogger(); logger_.enabled(lvl)) \
+                logger_.log(lvl, fmt, std::source_location::current() __VA_OPT__(,) __VA_ARGS__); \
+        } \
+    } while (0)
 
 #define LOG_TRACE(fmt, ...) LOG_IMPL(::simplelog::Level::TRACE, fmt __VA_OPT__(,) __VA_ARGS__)
 #define LOG_DEBUG(fmt, ...) LOG_IMPL(::simplelog::Level::DEBUG, fmt __VA_OPT__(,) __VA_ARGS__)
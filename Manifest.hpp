@@ -0,0 +1,98 @@
+#pragma once
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <map>
+#include <format>
+#include <charconv>
+#include <cstdint>
+#include <system_error>
+#include <stdexcept>
+#include <iterator>
+
+#include "IOUtils.hpp"
+
+/// 增量分析用的清单：按输入文件的相对路径记录内容哈希、大小与修改时间，
+/// 头部的版本戳覆盖工具版本与匹配规则，任一变化都会使整份清单失效
+class Manifest {
+public:
+    struct Entry {
+        std::uint64_t hash = 0;
+        std::uintmax_t size = 0;
+        std::int64_t mtime = 0;
+
+        bool operator==(const Entry&) const = default;
+    };
+
+    explicit Manifest(std::uint64_t stamp = 0) : stamp_(stamp) {}
+
+    /// 清单放在输出目录旁边，例如 output -> output.manifest，避免被当作输出清理
+    static std::filesystem::path pathFor(const std::filesystem::path& outputDir) {
+        return IOUtils::sibling_path(outputDir, ".manifest");
+    }
+
+    /// 文件不存在、格式不对或版本戳不符时返回空清单，相当于全量分析
+    static Manifest load(const std::filesystem::path& file, std::uint64_t stamp) {
+        Manifest m(stamp);
+        std::ifstream in(file, std::ios::binary);
+        std::string line;
+        if (!in || !std::getline(in, line) || line != header(stamp))
+            return m;
+
+        while (std::getline(in, line)) {
+            Entry e;
+            const char* p = line.data();
+            const char* end = p + line.size();
+            auto field = [&](auto& value, int base) {
+                auto [q, ec] = std::from_chars(p, end, value, base);
+                if (ec != std::errc{} || q == end || *q != ' ')
+                    return false;
+                p = q + 1;
+                return true;
+            };
+            if (!field(e.hash, 16) || !field(e.size, 10) || !field(e.mtime, 10))
+                return Manifest(stamp);     // 损坏的清单整体作废
+            m.entries_.emplace(std::string(p, end), e);
+        }
+        return m;
+    }
+
+    /// 经 IOUtils::write_atomic 先写临时文件再替换，中途失败不会留下半份清单
+    void save(const std::filesystem::path& file) const {
+        std::string buf = header(stamp_) + '\n';
+        for (auto&& [key, e] : entries_)
+            std::format_to(std::back_inserter(buf), "{:016x} {} {} {}\n", e.hash, e.size, e.mtime, key);
+        IOUtils::write_atomic(file, buf);
+    }
+
+    const Entry* find(const std::string& key) const {
+        auto it = entries_.find(key);
+        return it == entries_.end() ? nullptr : &it->second;
+    }
+
+    void set(std::string key, const Entry& e) { entries_.insert_or_assign(std::move(key), e); }
+    void erase(const std::string& key) { entries_.erase(key); }
+
+    std::uint64_t stamp() const noexcept { return stamp_; }
+
+    const std::map<std::string, Entry>& entries() const noexcept { return entries_; }
+
+    /// 清单中的键：相对输入目录的路径，统一用 '/' 分隔
+    static std::string keyFor(const std::filesystem::path& file, const std::filesystem::path& inputRoot) {
+        auto u8 = std::filesystem::relative(file, inputRoot).generic_u8string();
+        return std::string(u8.begin(), u8.end());
+    }
+
+    static std::int64_t mtimeOf(const std::filesystem::path& file, std::error_code& ec) {
+        return static_cast<std::int64_t>(std::filesystem::last_write_time(file, ec).time_since_epoch().count());
+    }
+
+private:
+    std::uint64_t stamp_;
+    std::map<std::string, Entry> entries_;
+
+    static std::string header(std::uint64_t stamp) {
+        return std::format("AnalyzeCsClass manifest {:016x}", stamp);
+    }
+};
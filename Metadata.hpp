@@ -0,0 +1,1259 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <span>
+#include <format>
+#include <filesystem>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <initializer_list>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+#include "IOUtils.hpp"
+#include "ClassInfo.hpp"
+
+/// 直接读取 .NET 程序集（ECMA-335）的元数据表与签名，得到与分析反编译文本相同的 ClassInfo，
+/// 不再需要先用 ilspycmd 反编译；成员的写法按 ILSpy 输出的 C# 习惯拼出
+namespace clr {
+
+    namespace fs = std::filesystem;
+
+    /// 元数据表编号（II.22）
+    enum class Tab : std::uint8_t {
+        Module, TypeRef, TypeDef, FieldPtr, Field, MethodPtr, MethodDef, ParamPtr, Param, InterfaceImpl,
+        MemberRef, Constant, CustomAttribute, FieldMarshal, DeclSecurity, ClassLayout, FieldLayout, StandAloneSig,
+        EventMap, EventPtr, Event, PropertyMap, PropertyPtr, Property, MethodSemantics, MethodImpl, ModuleRef,
+        TypeSpec, ImplMap, FieldRVA, EncLog, EncMap, Assembly, AssemblyProcessor, AssemblyOS, AssemblyRef,
+        AssemblyRefProcessor, AssemblyRefOS, File, ExportedType, ManifestResource, NestedClass, GenericParam,
+        MethodSpec, GenericParamConstraint,
+        Count,
+    };
+
+    inline constexpr std::size_t TableCount = static_cast<std::size_t>(Tab::Count);
+
+    /// 编码索引的种类（II.24.2.6）
+    enum class Coded : std::uint8_t {
+        TypeDefOrRef, HasConstant, HasCustomAttribute, HasFieldMarshal, HasDeclSecurity, MemberRefParent,
+        HasSemantics, MethodDefOrRef, MemberForwarded, Implementation, CustomAttributeType, ResolutionScope,
+        TypeOrMethodDef,
+        Count,
+    };
+
+    namespace detail {
+        inline constexpr std::uint8_t NoTable = 0xFF;
+
+        struct CodedDef {
+            std::uint8_t bits = 0;
+            std::array<std::uint8_t, 22> tables{};
+            std::uint8_t count = 0;
+        };
+
+        constexpr CodedDef coded(std::uint8_t bits, std::initializer_list<int> tables) {
+            CodedDef d{ bits };
+            for (int t : tables)
+                d.tables[d.count++] = t < 0 ? NoTable : static_cast<std::uint8_t>(t);
+            return d;
+        }
+
+        constexpr int T(Tab t) { return static_cast<int>(t); }
+
+        inline constexpr std::array<CodedDef, static_cast<std::size_t>(Coded::Count)> CodedDefs{ {
+            coded(2, { T(Tab::TypeDef), T(Tab::TypeRef), T(Tab::TypeSpec) }),
+            coded(2, { T(Tab::Field), T(Tab::Param), T(Tab::Property) }),
+            coded(5, { T(Tab::MethodDef), T(Tab::Field), T(Tab::TypeRef), T(Tab::TypeDef), T(Tab::Param), T(Tab::InterfaceImpl),
+                       T(Tab::MemberRef), T(Tab::Module), T(Tab::DeclSecurity), T(Tab::Property), T(Tab::Event), T(Tab::StandAloneSig),
+                       T(Tab::ModuleRef), T(Tab::TypeSpec), T(Tab::Assembly), T(Tab::AssemblyRef), T(Tab::File), T(Tab::ExportedType),
+                       T(Tab::ManifestResource), T(Tab::GenericParam), T(Tab::GenericParamConstraint), T(Tab::MethodSpec) }),
+            coded(1, { T(Tab::Field), T(Tab::Param) }),
+            coded(2, { T(Tab::TypeDef), T(Tab::MethodDef), T(Tab::Assembly) }),
+            coded(3, { T(Tab::TypeDef), T(Tab::TypeRef), T(Tab::ModuleRef), T(Tab::MethodDef), T(Tab::TypeSpec) }),
+            coded(1, { T(Tab::Event), T(Tab::Property) }),
+            coded(1, { T(Tab::MethodDef), T(Tab::MemberRef) }),
+            coded(1, { T(Tab::Field), T(Tab::MethodDef) }),
+            coded(2, { T(Tab::File), T(Tab::AssemblyRef), T(Tab::ExportedType) }),
+            coded(3, { -1, -1, T(Tab::MethodDef), T(Tab::MemberRef), -1 }),
+            coded(2, { T(Tab::Module), T(Tab::ModuleRef), T(Tab::AssemblyRef), T(Tab::TypeRef) }),
+            coded(1, { T(Tab::TypeDef), T(Tab::MethodDef) }),
+        } };
+
+        enum class Col : std::uint8_t { U16, U32, Str, Guid, Blob, Idx, Coded };
+
+        struct ColDef {
+            Col kind;
+            std::uint8_t arg = 0;       // Idx 为表号，Coded 为编码索引种类
+        };
+
+        struct TableDef {
+            std::array<ColDef, 9> cols{};
+            std::uint8_t count = 0;
+        };
+
+        constexpr TableDef row(std::initializer_list<ColDef> cols) {
+            TableDef d;
+            for (auto c : cols)
+                d.cols[d.count++] = c;
+            return d;
+        }
+
+        inline constexpr ColDef u16{ Col::U16 }, u32{ Col::U32 }, str{ Col::Str }, guid{ Col::Guid }, blob{ Col::Blob };
+        constexpr ColDef idx(Tab t) { return { Col::Idx, static_cast<std::uint8_t>(t) }; }
+        constexpr ColDef cod(Coded c) { return { Col::Coded, static_cast<std::uint8_t>(c) }; }
+
+        // 各表的列（II.22.2 起），Constant 的 Type 与填充字节合读为一个 u16
+        inline constexpr std::array<TableDef, TableCount> Schema{ {
+            row({ u16, str, guid, guid, guid }),                                        // Module
+            row({ cod(Coded::ResolutionScope), str, str }),                             // TypeRef
+            row({ u32, str, str, cod(Coded::TypeDefOrRef), idx(Tab::Field), idx(Tab::MethodDef) }),   // TypeDef
+            row({ idx(Tab::Field) }),                                                   // FieldPtr
+            row({ u16, str, blob }),                                                    // Field
+            row({ idx(Tab::MethodDef) }),                                               // MethodPtr
+            row({ u32, u16, u16, str, blob, idx(Tab::Param) }),                         // MethodDef
+            row({ idx(Tab::Param) }),                                                   // ParamPtr
+            row({ u16, u16, str }),                                                     // Param
+            row({ idx(Tab::TypeDef), cod(Coded::TypeDefOrRef) }),                       // InterfaceImpl
+            row({ cod(Coded::MemberRefParent), str, blob }),                            // MemberRef
+            row({ u16, cod(Coded::HasConstant), blob }),                                // Constant
+            row({ cod(Coded::HasCustomAttribute), cod(Coded::CustomAttributeType), blob }),   // CustomAttribute
+            row({ cod(Coded::HasFieldMarshal), blob }),                                 // FieldMarshal
+            row({ u16, cod(Coded::HasDeclSecurity), blob }),                            // DeclSecurity
+            row({ u16, u32, idx(Tab::TypeDef) }),                                       // ClassLayout
+            row({ u32, idx(Tab::Field) }),                                              // FieldLayout
+            row({ blob }),                                                              // StandAloneSig
+            row({ idx(Tab::TypeDef), idx(Tab::Event) }),                                // EventMap
+            row({ idx(Tab::Event) }),                                                   // EventPtr
+            row({ u16, str, cod(Coded::TypeDefOrRef) }),                                // Event
+            row({ idx(Tab::TypeDef), idx(Tab::Property) }),                             // PropertyMap
+            row({ idx(Tab::Property) }),                                                // PropertyPtr
+            row({ u16, str, blob }),                                                    // Property
+            row({ u16, idx(Tab::MethodDef), cod(Coded::HasSemantics) }),                // MethodSemantics
+            row({ idx(Tab::TypeDef), cod(Coded::MethodDefOrRef), cod(Coded::MethodDefOrRef) }),   // MethodImpl
+            row({ str }),                                                               // ModuleRef
+            row({ blob }),                                                              // TypeSpec
+            row({ u16, cod(Coded::MemberForwarded), str, idx(Tab::ModuleRef) }),        // ImplMap
+            row({ u32, idx(Tab::Field) }),                                              // FieldRVA
+            row({ u32, u32 }),                                                          // EncLog
+            row({ u32 }),                                                               // EncMap
+            row({ u32, u16, u16, u16, u16, u32, blob, str, str }),                      // Assembly
+            row({ u32 }),                                                               // AssemblyProcessor
+            row({ u32, u32, u32 }),                                                     // AssemblyOS
+            row({ u16, u16, u16, u16, u32, blob, str, str, blob }),                     // AssemblyRef
+            row({ u32, idx(Tab::AssemblyRef) }),                                        // AssemblyRefProcessor
+            row({ u32, u32, u32, idx(Tab::AssemblyRef) }),                              // AssemblyRefOS
+            row({ u32, str, blob }),                                                    // File
+            row({ u32, u32, str, str, cod(Coded::Implementation) }),                    // ExportedType
+            row({ u32, u32, str, cod(Coded::Implementation) }),                         // ManifestResource
+            row({ idx(Tab::TypeDef), idx(Tab::TypeDef) }),                              // NestedClass
+            row({ u16, u16, cod(Coded::TypeOrMethodDef), str }),                        // GenericParam
+            row({ cod(Coded::MethodDefOrRef), blob }),                                  // MethodSpec
+            row({ idx(Tab::GenericParam), cod(Coded::TypeDefOrRef) }),                  // GenericParamConstraint
+        } };
+    } // namespace detail
+
+    /// 编码索引解出的 (表, 行号)，行号从 1 开始，0 表示空引用
+    struct Token {
+        Tab table{};
+        std::uint32_t row = 0;
+
+        explicit operator bool() const noexcept { return row != 0; }
+    };
+
+    /// 程序集文件的元数据：PE 头 -> CLI 头 -> 元数据根 -> 各个流，表按行直接从映射里读，不做整体解码
+    class Metadata {
+    public:
+        explicit Metadata(const fs::path& path) : path_(path), file_(path) {
+            data_ = file_.view();
+            parsePe();
+        }
+
+        const fs::path& path() const noexcept { return path_; }
+
+        std::uint32_t rows(Tab t) const noexcept { return tables_[index(t)].rows; }
+
+        /// 第 row 行（从 1 开始）第 col 列的原始值
+        std::uint32_t get(Tab t, std::uint32_t row, std::size_t col) const {
+            auto& tab = tables_[index(t)];
+            if (row == 0 || row > tab.rows)
+                fail(std::format("{} 表的行号 {} 越界", index(t), row));
+            const char* p = tab.base + static_cast<std::size_t>(row - 1) * tab.rowSize + tab.offset[col];
+            return tab.width[col] == 2 ? read<std::uint16_t>(p) : read<std::uint32_t>(p);
+        }
+
+        Token coded(Tab t, std::uint32_t row, std::size_t col) const {
+            auto& def = detail::CodedDefs[detail::Schema[index(t)].cols[col].arg];
+            auto v = get(t, row, col);
+            auto tag = v & ((1u << def.bits) - 1);
+            if (tag >= def.count || def.tables[tag] == detail::NoTable)
+                fail(std::format("无效的编码索引 0x{:X}", v));
+            return { static_cast<Tab>(def.tables[tag]), v >> def.bits };
+        }
+
+        std::string_view string(std::uint32_t offset) const {
+            if (offset >= strings_.size())
+                fail("#Strings 偏移越界");
+            auto s = strings_.substr(offset);
+            return s.substr(0, s.find('\0'));
+        }
+
+        std::string_view blob(std::uint32_t offset) const {
+            if (offset >= blobs_.size())
+                fail("#Blob 偏移越界");
+            auto b = blobs_.substr(offset);
+            std::size_t pos = 0;
+            auto size = uncompress(b, pos);
+            if (pos + size > b.size())
+                fail("#Blob 长度越界");
+            return b.substr(pos, size);
+        }
+
+        std::string_view string(Tab t, std::uint32_t row, std::size_t col) const { return string(get(t, row, col)); }
+        std::string_view blob(Tab t, std::uint32_t row, std::size_t col) const { return blob(get(t, row, col)); }
+
+        /// 列表列（如 TypeDef.FieldList）给出的连续行范围 [first, last)，最后一行的范围到目标表末尾
+        std::pair<std::uint32_t, std::uint32_t> range(Tab t, std::uint32_t row, std::size_t col, Tab target) const {
+            std::uint32_t first = get(t, row, col);
+            std::uint32_t last = row < rows(t) ? get(t, row + 1, col) : rows(target) + 1;
+            return { first, std::max(first, std::min(last, rows(target) + 1)) };
+        }
+
+        /// 未优化的 #- 流中成员列表经 *Ptr 表间接引用
+        std::uint32_t indirect(Tab ptr, std::uint32_t i) const {
+            return rows(ptr) ? get(ptr, i, 0) : i;
+        }
+
+        /// 签名与常量 blob 中的压缩无符号整数（II.23.2）
+        static std::uint32_t uncompress(std::string_view b, std::size_t& pos) {
+            auto at = [&](std::size_t k) {
+                if (pos + k >= b.size())
+                    throw std::runtime_error("元数据中的压缩整数越界");
+                return static_cast<std::uint8_t>(b[pos + k]);
+            };
+            std::uint8_t first = at(0);
+            if ((first & 0x80) == 0) {
+                pos += 1;
+                return first;
+            }
+            if ((first & 0xC0) == 0x80) {
+                std::uint32_t v = ((first & 0x3Fu) << 8) | at(1);
+                pos += 2;
+                return v;
+            }
+            std::uint32_t v = ((first & 0x1Fu) << 24) | (static_cast<std::uint32_t>(at(1)) << 16)
+                            | (static_cast<std::uint32_t>(at(2)) << 8) | at(3);
+            pos += 4;
+            return v;
+        }
+
+        [[noreturn]] void fail(std::string_view what) const {
+            throw std::runtime_error(std::format("{}：{}", path_.string(), what));
+        }
+
+    private:
+        struct TableInfo {
+            const char* base = nullptr;
+            std::uint32_t rows = 0;
+            std::uint32_t rowSize = 0;
+            std::array<std::uint8_t, 9> offset{};
+            std::array<std::uint8_t, 9> width{};
+        };
+
+        static constexpr std::size_t index(Tab t) noexcept { return static_cast<std::size_t>(t); }
+
+        template <typename T>
+        static T read(const char* p) noexcept {
+            T v;
+            std::memcpy(&v, p, sizeof v);
+            return v;
+        }
+
+        template <typename T>
+        T at(std::size_t off) const {
+            if (off + sizeof(T) > data_.size())
+                fail("不是有效的 .NET 程序集（文件过短）");
+            return read<T>(data_.data() + off);
+        }
+
+        std::size_t rvaToOffset(std::uint32_t rva) const {
+            for (std::uint16_t i = 0; i < sectionCount_; ++i) {
+                std::size_t s = sections_ + i * 40u;
+                auto vsize = at<std::uint32_t>(s + 8), vaddr = at<std::uint32_t>(s + 12);
+                auto rawSize = at<std::uint32_t>(s + 16), rawPtr = at<std::uint32_t>(s + 20);
+                if (rva >= vaddr && rva < vaddr + std::max(vsize, rawSize))
+                    return static_cast<std::size_t>(rawPtr) + (rva - vaddr);
+            }
+            fail(std::format("RVA 0x{:X} 不在任何节中", rva));
+        }
+
+        // II.25：DOS 头 -> PE 头 -> 可选头中的 CLI 头目录 -> 元数据根
+        void parsePe() {
+            if (data_.size() < 0x40 || data_.substr(0, 2) != "MZ")
+                fail("不是 PE 文件");
+            auto pe = at<std::uint32_t>(0x3C);
+            if (at<std::uint32_t>(pe) != 0x00004550)
+                fail("缺少 PE 签名");
+            std::size_t coff = pe + 4;
+            sectionCount_ = at<std::uint16_t>(coff + 2);
+            auto optSize = at<std::uint16_t>(coff + 16);
+            std::size_t opt = coff + 20;
+            auto magic = at<std::uint16_t>(opt);
+            std::size_t dirs = opt + (magic == 0x20B ? 112 : 96);
+            sections_ = opt + optSize;
+            auto cliRva = at<std::uint32_t>(dirs + 14 * 8);
+            if (cliRva == 0)
+                fail("不是 .NET 程序集（没有 CLI 头）");
+            auto cli = rvaToOffset(cliRva);
+            auto root = rvaToOffset(at<std::uint32_t>(cli + 8));
+
+            if (at<std::uint32_t>(root) != 0x424A5342)
+                fail("元数据签名错误");
+            auto versionLength = at<std::uint32_t>(root + 12);
+            std::size_t p = root + 16 + versionLength;
+            auto streams = at<std::uint16_t>(p + 2);
+            p += 4;
+            std::string_view tables;
+            for (std::uint16_t i = 0; i < streams; ++i) {
+                auto offset = at<std::uint32_t>(p), size = at<std::uint32_t>(p + 4);
+                p += 8;
+                std::size_t end = data_.find('\0', p);
+                if (end == std::string_view::npos)
+                    fail("流名称未结束");
+                auto name = data_.substr(p, end - p);
+                p = (end + 4) & ~std::size_t{ 3 };
+                if (root + offset + size > data_.size())
+                    fail(std::format("流 {} 越界", name));
+                auto body = data_.substr(root + offset, size);
+                if (name == "#~" || name == "#-")
+                    tables = body;
+                else if (name == "#Strings")
+                    strings_ = body;
+                else if (name == "#Blob")
+                    blobs_ = body;
+            }
+            if (tables.empty())
+                fail("缺少元数据表流");
+            parseTables(tables);
+        }
+
+        // II.24.2.6：各表行数在前，表数据紧随其后；索引列宽度取决于堆大小与被引用表的行数
+        void parseTables(std::string_view s) {
+            auto need = [&](std::size_t n) {
+                if (n > s.size())
+                    fail("元数据表流过短");
+            };
+            need(24);
+            auto heapSizes = static_cast<std::uint8_t>(s[6]);
+            auto valid = read<std::uint64_t>(s.data() + 8);
+            std::size_t p = 24;
+            for (std::size_t t = 0; t < 64; ++t) {
+                if (!(valid >> t & 1))
+                    continue;
+                need(p + 4);
+                auto n = read<std::uint32_t>(s.data() + p);
+                p += 4;
+                if (t < TableCount)
+                    tables_[t].rows = n;
+                else
+                    fail(std::format("不认识的元数据表 0x{:X}", t));
+            }
+            if (heapSizes & 0x40)       // 未公开的额外数据
+                p += 4;
+
+            auto indexWidth = [&](std::size_t t) -> std::uint8_t { return tables_[t].rows < 0x10000 ? 2 : 4; };
+            auto codedWidth = [&](const detail::CodedDef& d) -> std::uint8_t {
+                std::uint32_t most = 0;
+                for (std::uint8_t k = 0; k < d.count; ++k)
+                    if (d.tables[k] != detail::NoTable)
+                        most = std::max(most, tables_[d.tables[k]].rows);
+                return most < (1u << (16 - d.bits)) ? 2 : 4;
+            };
+            for (std::size_t t = 0; t < TableCount; ++t) {
+                auto& tab = tables_[t];
+                auto& def = detail::Schema[t];
+                std::uint32_t offset = 0;
+                for (std::uint8_t c = 0; c < def.count; ++c) {
+                    std::uint8_t w = 0;
+                    switch (def.cols[c].kind) {
+                    case detail::Col::U16:   w = 2; break;
+                    case detail::Col::U32:   w = 4; break;
+                    case detail::Col::Str:   w = heapSizes & 0x01 ? 4 : 2; break;
+                    case detail::Col::Guid:  w = heapSizes & 0x02 ? 4 : 2; break;
+                    case detail::Col::Blob:  w = heapSizes & 0x04 ? 4 : 2; break;
+                    case detail::Col::Idx:   w = indexWidth(def.cols[c].arg); break;
+                    case detail::Col::Coded: w = codedWidth(detail::CodedDefs[def.cols[c].arg]); break;
+                    }
+                    tab.offset[c] = static_cast<std::uint8_t>(offset);
+                    tab.width[c] = w;
+                    offset += w;
+                }
+                tab.rowSize = offset;
+                need(p + static_cast<std::size_t>(tab.rows) * tab.rowSize);
+                tab.base = s.data() + p;
+                p += static_cast<std::size_t>(tab.rows) * tab.rowSize;
+            }
+        }
+
+        fs::path path_;
+        IOUtils::MappedFile file_;
+        std::string_view data_, strings_, blobs_;
+        std::size_t sections_ = 0;
+        std::uint16_t sectionCount_ = 0;
+        std::array<TableInfo, TableCount> tables_{};
+    };
+
+    /// 程序集中的一个顶层类型，path 为相对程序集输出目录的 .out.txt 路径（命名空间逐段作为子目录）
+    struct TypeListing {
+        fs::path path;
+        ClassInfo info;
+    };
+
+    /// 把元数据还原为 ILSpy 风格的声明文本，组装成 ClassInfo；编译器生成的类型与成员、构造函数、
+    /// 运算符、索引器与显式接口实现和文本路径一样不列出，接口成员、字段式事件与枚举值则照实列出
+    class Describer {
+    public:
+        explicit Describer(const Metadata& md) : md_(md) { buildMaps(); }
+
+        /// 程序集名，取不到时用文件名
+        std::string assemblyName() const {
+            if (md_.rows(Tab::Assembly))
+                return std::string(md_.string(Tab::Assembly, 1, 7));
+            return md_.path().stem().string();
+        }
+
+        std::vector<TypeListing> types() const {
+            std::vector<TypeListing> out;
+            std::unordered_map<std::string, std::size_t> seen;
+            for (std::uint32_t t = 1; t <= md_.rows(Tab::TypeDef); ++t) {
+                if (enclosing_.contains(t) || hidden(t))
+                    continue;
+                TypeListing l;
+                l.info = describeType(t);
+                l.info.namespaceName = std::string(md_.string(Tab::TypeDef, t, 2));
+
+                fs::path dir;
+                for (auto ns = std::string_view(l.info.namespaceName); !ns.empty();) {
+                    auto dot = ns.find('.');
+                    dir /= std::string(ns.substr(0, dot));
+                    ns.remove_prefix(dot == std::string_view::npos ? ns.size() : dot + 1);
+                }
+                // 只有泛型元数不同的同名类型（Foo 与 Foo`1）保留反引号区分
+                auto raw = md_.string(Tab::TypeDef, t, 1);
+                auto file = std::string(stripArity(raw));
+                auto key = (dir / file).generic_string();
+                if (seen[key]++)
+                    file = std::string(raw);
+                l.path = dir / (file + ".out.txt");
+                out.push_back(std::move(l));
+            }
+            return out;
+        }
+
+    private:
+        // 类型与方法各自的泛型参数名，VAR/MVAR 按序号取；scope 为当前所在类型，嵌套在它或其外层里的类型只写简单名
+        struct GenericContext {
+            std::span<const std::string> type;
+            std::span<const std::string> method;
+            std::uint32_t scope = 0;
+        };
+
+        struct Accessors {
+            std::uint32_t getter = 0, setter = 0, adder = 0;
+        };
+
+        static constexpr std::uint32_t Interface = 0x20, Abstract = 0x80, Sealed = 0x100;
+
+        static std::string_view stripArity(std::string_view name) {
+            return name.substr(0, name.find('`'));
+        }
+
+        static std::size_t arity(std::string_view name) {
+            auto tick = name.find('`');
+            std::size_t n = 0;
+            if (tick != std::string_view::npos)
+                for (char c : name.substr(tick + 1))
+                    n = n * 10 + static_cast<std::size_t>(c - '0');
+            return n;
+        }
+
+        static bool generated(std::string_view name) {
+            return name.find('<') != std::string_view::npos;
+        }
+
+        // ---------- 预先建立的反查表 ----------
+
+        void buildMaps() {
+            for (std::uint32_t r = 1; r <= md_.rows(Tab::NestedClass); ++r)
+                enclosing_[md_.get(Tab::NestedClass, r, 0)] = md_.get(Tab::NestedClass, r, 1);
+            for (auto&& [inner, outer] : enclosing_)
+                nested_[outer].push_back(inner);
+            for (auto&& [outer, list] : nested_)
+                std::ranges::sort(list);
+
+            for (std::uint32_t r = 1; r <= md_.rows(Tab::InterfaceImpl); ++r)
+                interfaces_[md_.get(Tab::InterfaceImpl, r, 0)].push_back(md_.coded(Tab::InterfaceImpl, r, 1));
+
+            std::unordered_map<std::uint32_t, std::vector<std::pair<std::uint16_t, std::string>>> typeGp, methodGp;
+            for (std::uint32_t r = 1; r <= md_.rows(Tab::GenericParam); ++r) {
+                auto owner = md_.coded(Tab::GenericParam, r, 2);
+                auto& list = owner.table == Tab::TypeDef ? typeGp[owner.row] : methodGp[owner.row];
+                list.emplace_back(static_cast<std::uint16_t>(md_.get(Tab::GenericParam, r, 0)), std::string(md_.string(Tab::GenericParam, r, 3)));
+            }
+            auto flatten = [](auto& from, auto& to) {
+                for (auto&& [owner, list] : from) {
+                    std::ranges::sort(list);
+                    auto& names = to[owner];
+                    for (auto&& [n, name] : list)
+                        names.push_back(std::move(name));
+                }
+            };
+            flatten(typeGp, typeGenerics_);
+            flatten(methodGp, methodGenerics_);
+
+            for (std::uint32_t r = 1; r <= md_.rows(Tab::MethodSemantics); ++r) {
+                auto semantics = md_.get(Tab::MethodSemantics, r, 0);
+                auto method = md_.get(Tab::MethodSemantics, r, 1);
+                auto assoc = md_.coded(Tab::MethodSemantics, r, 2);
+                accessorMethods_.insert(method);
+                auto& a = assoc.table == Tab::Property ? propertyAccessors_[assoc.row] : eventAccessors_[assoc.row];
+                if (semantics & 0x02) a.getter = method;
+                if (semantics & 0x01) a.setter = method;
+                if (semantics & 0x08) a.adder = method;
+            }
+
+            for (std::uint32_t r = 1; r <= md_.rows(Tab::Constant); ++r) {
+                auto parent = md_.coded(Tab::Constant, r, 1);
+                if (parent.table == Tab::Param)
+                    paramConstants_[parent.row] = r;
+                else if (parent.table == Tab::Field)
+                    fieldConstants_[parent.row] = r;
+            }
+
+            for (std::uint32_t t = 1; t <= md_.rows(Tab::TypeDef); ++t) {
+                auto [first, last] = md_.range(Tab::TypeDef, t, 5, Tab::MethodDef);
+                for (auto i = first; i < last; ++i)
+                    methodOwner_[md_.indirect(Tab::MethodPtr, i)] = t;
+            }
+            for (std::uint32_t r = 1; r <= md_.rows(Tab::PropertyMap); ++r)
+                propertyMap_[md_.get(Tab::PropertyMap, r, 0)] = r;
+            for (std::uint32_t r = 1; r <= md_.rows(Tab::EventMap); ++r)
+                eventMap_[md_.get(Tab::EventMap, r, 0)] = r;
+
+            for (std::uint32_t r = 1; r <= md_.rows(Tab::CustomAttribute); ++r) {
+                auto parent = md_.coded(Tab::CustomAttribute, r, 0);
+                auto name = attributeName(md_.coded(Tab::CustomAttribute, r, 1));
+                if (parent.table == Tab::Param && name == "System.ParamArrayAttribute")
+                    paramArrays_.insert(parent.row);
+                else if (parent.table == Tab::MethodDef && name == "System.Runtime.CompilerServices.ExtensionAttribute")
+                    extensions_.insert(parent.row);
+            }
+        }
+
+        std::string attributeName(Token ctor) const {
+            Token type{};
+            if (ctor.table == Tab::MemberRef)
+                type = md_.coded(Tab::MemberRef, ctor.row, 0);
+            else if (ctor.table == Tab::MethodDef)
+                type = { Tab::TypeDef, ownerOf(ctor.row) };
+            if (type.table == Tab::TypeRef)
+                return std::format("{}.{}", md_.string(Tab::TypeRef, type.row, 2), md_.string(Tab::TypeRef, type.row, 1));
+            if (type.table == Tab::TypeDef && type.row)
+                return std::format("{}.{}", md_.string(Tab::TypeDef, type.row, 2), md_.string(Tab::TypeDef, type.row, 1));
+            return {};
+        }
+
+        std::uint32_t ownerOf(std::uint32_t method) const {
+            auto it = methodOwner_.find(method);
+            return it != methodOwner_.end() ? it->second : 0;
+        }
+
+        // ---------- 类型名 ----------
+
+        /// 基类的全名（命名空间.名字），只用于判断 enum/struct/委托
+        std::string baseName(std::uint32_t type) const {
+            auto base = md_.coded(Tab::TypeDef, type, 3);
+            if (!base)
+                return {};
+            if (base.table == Tab::TypeRef)
+                return std::format("{}.{}", md_.string(Tab::TypeRef, base.row, 2), md_.string(Tab::TypeRef, base.row, 1));
+            if (base.table == Tab::TypeDef)
+                return std::format("{}.{}", md_.string(Tab::TypeDef, base.row, 2), md_.string(Tab::TypeDef, base.row, 1));
+            return {};
+        }
+
+        std::uint32_t enclosingOf(std::uint32_t type) const {
+            auto it = enclosing_.find(type);
+            return it != enclosing_.end() ? it->second : 0;
+        }
+
+        bool hidden(std::uint32_t type) const {
+            return type == 1 || generated(md_.string(Tab::TypeDef, type, 1));     // 第 1 行是 <Module>
+        }
+
+        /// 外层在前的名字链，泛型实参按各层元数依次分配
+        std::string named(Token t, std::span<const std::string> args, std::uint32_t scope = 0) const {
+            std::vector<std::pair<std::string_view, std::string_view>> chain;     // (命名空间, 名字)
+            std::uint32_t parent = 0;       // 定义在本程序集的嵌套类型的直接外层
+            for (Token cur = t; cur;) {
+                if (cur.table == Tab::TypeDef) {
+                    chain.emplace_back(md_.string(Tab::TypeDef, cur.row, 2), md_.string(Tab::TypeDef, cur.row, 1));
+                    if (chain.size() == 2)
+                        parent = cur.row;
+                    auto it = enclosing_.find(cur.row);
+                    cur = it != enclosing_.end() ? Token{ Tab::TypeDef, it->second } : Token{};
+                }
+                else if (cur.table == Tab::TypeRef) {
+                    chain.emplace_back(md_.string(Tab::TypeRef, cur.row, 2), md_.string(Tab::TypeRef, cur.row, 1));
+                    auto scope = md_.coded(Tab::TypeRef, cur.row, 0);
+                    cur = scope.table == Tab::TypeRef ? scope : Token{};
+                }
+                else if (cur.table == Tab::TypeSpec) {
+                    GenericContext none;
+                    auto sig = md_.blob(Tab::TypeSpec, cur.row, 0);
+                    std::size_t pos = 0;
+                    return decode(sig, pos, none);
+                }
+                else
+                    break;
+            }
+            if (chain.empty())
+                return "?";
+            std::ranges::reverse(chain);
+
+            if (chain.size() == 1 && chain[0].first == "System") {
+                if (auto k = keywordFor(chain[0].second); !k.empty())
+                    return std::string(k);
+                if (chain[0].second == "Nullable`1" && args.size() == 1)
+                    return args[0] + "?";
+                if (chain[0].second.starts_with("ValueTuple`") && args.size() >= 2)
+                    return tuple(args);
+            }
+
+            // 在外层类型（或更外层）之内引用时省去外层名，外层的泛型实参照样跳过
+            std::size_t skip = 0;
+            for (auto s = scope; parent && s && !skip; s = enclosingOf(s))
+                if (s == parent)
+                    skip = chain.size() - 1;
+
+            std::string out;
+            std::size_t used = 0;
+            for (std::size_t level = 0; level < chain.size(); ++level) {
+                auto name = chain[level].second;
+                auto n = std::min(arity(name), args.size() - used);
+                if (level < skip) {
+                    used += n;
+                    continue;
+                }
+                if (!out.empty())
+                    out += '.';
+                out += stripArity(name);
+                if (n == 0)
+                    continue;
+                out += '<';
+                for (std::size_t i = 0; i < n; ++i)
+                    out += (i ? ", " : "") + args[used + i];
+                out += '>';
+                used += n;
+            }
+            return out;
+        }
+
+        static std::string tuple(std::span<const std::string> args) {
+            // ValueTuple`8 的第 8 个实参是装剩余元素的元组，已被拼成 (a, b) 形式，摊平到外层
+            std::string out = "(";
+            for (std::size_t i = 0; i < args.size(); ++i) {
+                std::string_view a = args[i];
+                if (i == 7 && a.starts_with('(') && a.ends_with(')'))
+                    a = a.substr(1, a.size() - 2);
+                out += i ? ", " : "";
+                out += a;
+            }
+            return out + ")";
+        }
+
+        static std::string_view keywordFor(std::string_view name) {
+            static constexpr std::pair<std::string_view, std::string_view> table[] = {
+                { "Object", "object" }, { "String", "string" }, { "Void", "void" }, { "Boolean", "bool" },
+                { "Char", "char" }, { "SByte", "sbyte" }, { "Byte", "byte" }, { "Int16", "short" },
+                { "UInt16", "ushort" }, { "Int32", "int" }, { "UInt32", "uint" }, { "Int64", "long" },
+                { "UInt64", "ulong" }, { "Single", "float" }, { "Double", "double" }, { "Decimal", "decimal" },
+            };
+            for (auto&& [clr, cs] : table)
+                if (clr == name)
+                    return cs;
+            return {};
+        }
+
+        // ---------- 签名（II.23.2） ----------
+
+        Token typeDefOrRef(std::string_view sig, std::size_t& pos) const {
+            auto v = Metadata::uncompress(sig, pos);
+            static constexpr Tab tags[] = { Tab::TypeDef, Tab::TypeRef, Tab::TypeSpec, Tab::Module };
+            return { tags[v & 3], v >> 2 };
+        }
+
+        std::uint8_t next(std::string_view sig, std::size_t& pos) const {
+            if (pos >= sig.size())
+                md_.fail("签名越界");
+            return static_cast<std::uint8_t>(sig[pos++]);
+        }
+
+        /// 解出一个类型；valueType 非空时记下它是否为值类型（决定默认值写成 null 还是 default(T)）
+        std::string decode(std::string_view sig, std::size_t& pos, const GenericContext& ctx, bool* valueType = nullptr) const {
+            auto e = next(sig, pos);
+            if (valueType)
+                *valueType = (e >= 0x02 && e <= 0x0d) || e == 0x11 || e == 0x18 || e == 0x19;
+            switch (e) {
+            case 0x01: return "void";
+            case 0x02: return "bool";
+            case 0x03: return "char";
+            case 0x04: return "sbyte";
+            case 0x05: return "byte";
+            case 0x06: return "short";
+            case 0x07: return "ushort";
+            case 0x08: return "int";
+            case 0x09: return "uint";
+            case 0x0a: return "long";
+            case 0x0b: return "ulong";
+            case 0x0c: return "float";
+            case 0x0d: return "double";
+            case 0x0e: return "string";
+            case 0x16: return "TypedReference";
+            case 0x18: return "IntPtr";
+            case 0x19: return "UIntPtr";
+            case 0x1c: return "object";
+            case 0x0f: return decode(sig, pos, ctx) + "*";
+            case 0x10: return "ref " + decode(sig, pos, ctx);
+            case 0x11:
+            case 0x12: return named(typeDefOrRef(sig, pos), {}, ctx.scope);
+            case 0x13:
+            case 0x1e: {
+                auto n = Metadata::uncompress(sig, pos);
+                auto names = e == 0x13 ? ctx.type : ctx.method;
+                return n < names.size() ? names[n] : std::format("{}{}", e == 0x13 ? "T" : "M", n);
+            }
+            case 0x14: {
+                auto elem = decode(sig, pos, ctx);
+                auto rank = Metadata::uncompress(sig, pos);
+                for (auto k = Metadata::uncompress(sig, pos); k; --k)
+                    Metadata::uncompress(sig, pos);
+                for (auto k = Metadata::uncompress(sig, pos); k; --k)
+                    Metadata::uncompress(sig, pos);
+                return elem + "[" + std::string(rank ? rank - 1 : 0, ',') + "]";
+            }
+            case 0x15: {
+                auto kind = next(sig, pos);
+                if (valueType)
+                    *valueType = kind == 0x11;
+                auto generic = typeDefOrRef(sig, pos);
+                std::vector<std::string> args(Metadata::uncompress(sig, pos));
+                for (auto& a : args)
+                    a = decode(sig, pos, ctx);
+                auto text = named(generic, args, ctx.scope);
+                if (valueType && text.ends_with('?'))
+                    *valueType = false;         // Nullable<T> 的默认值写 null
+                return text;
+            }
+            case 0x1b: {
+                auto m = methodSig(sig, pos, ctx);
+                std::string out = "delegate*<";
+                for (auto&& p : m.params)
+                    out += p + ", ";
+                return out + m.ret + ">";
+            }
+            case 0x1d: return decode(sig, pos, ctx) + "[]";
+            case 0x1f:
+            case 0x20:
+                typeDefOrRef(sig, pos);
+                return decode(sig, pos, ctx, valueType);
+            case 0x41:
+            case 0x45: return decode(sig, pos, ctx, valueType);
+            }
+            md_.fail(std::format("不认识的签名元素 0x{:02X}", e));
+        }
+
+        struct MethodSig {
+            std::string ret;
+            std::vector<std::string> params;
+            std::vector<bool> valueTypes;
+            std::vector<Token> valueTokens;     // 参数为具名值类型时的类型，用于把枚举默认值写成成员名
+        };
+
+        MethodSig methodSig(std::string_view sig, std::size_t& pos, const GenericContext& ctx) const {
+            auto conv = next(sig, pos);
+            if (conv & 0x10)
+                Metadata::uncompress(sig, pos);
+            MethodSig m;
+            m.params.resize(Metadata::uncompress(sig, pos));
+            m.valueTypes.resize(m.params.size());
+            m.valueTokens.resize(m.params.size());
+            m.ret = decode(sig, pos, ctx);
+            for (std::size_t i = 0; i < m.params.size(); ++i) {
+                bool vt = false;
+                if (pos + 1 < sig.size() && static_cast<std::uint8_t>(sig[pos]) == 0x11) {
+                    std::size_t p = pos + 1;
+                    m.valueTokens[i] = typeDefOrRef(sig, p);
+                }
+                m.params[i] = decode(sig, pos, ctx, &vt);
+                m.valueTypes[i] = vt;
+            }
+            return m;
+        }
+
+        // 字段签名里 modreq(IsVolatile) 对应 volatile
+        bool isVolatile(std::string_view sig) const {
+            std::size_t pos = 1;
+            while (pos < sig.size() && static_cast<std::uint8_t>(sig[pos]) == 0x1f) {
+                ++pos;
+                auto mod = typeDefOrRef(sig, pos);
+                if (mod.table == Tab::TypeRef && md_.string(Tab::TypeRef, mod.row, 1) == "IsVolatile")
+                    return true;
+            }
+            return false;
+        }
+
+        // ---------- 修饰符 ----------
+
+        static std::string_view access(std::uint32_t flags) {
+            switch (flags & 0x7) {
+            case 1: return "private ";
+            case 2: return "private protected ";
+            case 3: return "internal ";
+            case 4: return "protected ";
+            case 5: return "protected internal ";
+            case 6: return "public ";
+            }
+            return "";
+        }
+
+        // 接口成员不写修饰符，与 ILSpy 一致
+        std::string methodModifier(std::uint32_t method, bool inInterface) const {
+            auto flags = md_.get(Tab::MethodDef, method, 2);
+            auto impl = md_.get(Tab::MethodDef, method, 1);
+            if (inInterface && (flags & 0x400))
+                return {};
+            std::string m(access(flags));
+            if (flags & 0x10)
+                m += "static ";
+            bool newSlot = flags & 0x100, final = flags & 0x20;
+            if (flags & 0x400)
+                m += newSlot ? "abstract " : "abstract override ";
+            else if (flags & 0x40) {
+                if (!newSlot)
+                    m += final ? "sealed override " : "override ";
+                else if (!final)
+                    m += "virtual ";
+            }
+            bool bodyless = md_.get(Tab::MethodDef, method, 0) == 0 && !(flags & 0x400) && !inInterface;
+            if ((flags & 0x2000) || (impl & 0x1000) || bodyless)
+                m += "extern ";
+            return m;
+        }
+
+        std::string typeModifier(std::uint32_t type, std::string_view kind) const {
+            auto flags = md_.get(Tab::TypeDef, type, 0);
+            static constexpr std::string_view vis[] = {
+                "internal ", "public ", "public ", "private ", "protected ", "internal ", "private protected ", "protected internal ",
+            };
+            std::string m(vis[flags & 0x7]);
+            if (kind == "class") {
+                if ((flags & Abstract) && (flags & Sealed))
+                    m += "static ";
+                else if (flags & Abstract)
+                    m += "abstract ";
+                else if (flags & Sealed)
+                    m += "sealed ";
+            }
+            return m;
+        }
+
+        std::string_view kindOf(std::uint32_t type) const {
+            if (md_.get(Tab::TypeDef, type, 0) & Interface)
+                return "interface";
+            auto base = baseName(type);
+            if (base == "System.Enum")
+                return "enum";
+            if (base == "System.ValueType")
+                return "struct";
+            if (base == "System.MulticastDelegate")
+                return "delegate";
+            return "class";
+        }
+
+        // ---------- 成员 ----------
+
+        /// 名字加上末尾 n 个泛型参数；嵌套类型在元数据里重复声明了外层的泛型参数，只取自己那几个
+        static std::string genericName(std::string_view name, std::span<const std::string> params, std::size_t n) {
+            std::string out(name);
+            n = std::min(n, params.size());
+            if (n == 0)
+                return out;
+            out += '<';
+            for (std::size_t i = params.size() - n; i < params.size(); ++i)
+                out += (i + n == params.size() ? "" : ", ") + params[i];
+            return out + '>';
+        }
+
+        static std::string genericName(std::string_view raw, std::span<const std::string> params) {
+            return genericName(stripArity(raw), params, arity(raw));
+        }
+
+        static std::span<const std::string> genericsOf(const std::unordered_map<std::uint32_t, std::vector<std::string>>& map, std::uint32_t key) {
+            auto it = map.find(key);
+            return it != map.end() ? std::span<const std::string>(it->second) : std::span<const std::string>{};
+        }
+
+        /// 常量 blob 按 C# 字面量写出；hint 为参数类型，整数写进非基本类型（枚举）时加强制转换
+        std::string literal(std::uint32_t constant, std::string_view hint, bool valueType, Token enumType) const {
+            auto kind = md_.get(Tab::Constant, constant, 0) & 0xFF;
+            auto v = md_.blob(Tab::Constant, constant, 2);
+            if (enumType.table == Tab::TypeDef && enumType.row && kindOf(enumType.row) == "enum") {
+                auto [first, last] = md_.range(Tab::TypeDef, enumType.row, 4, Tab::Field);
+                for (auto i = first; i < last; ++i) {
+                    auto f = md_.indirect(Tab::FieldPtr, i);
+                    auto c = fieldConstants_.find(f);
+                    if (c != fieldConstants_.end() && md_.blob(Tab::Constant, c->second, 2) == v)
+                        return std::format("{}.{}", hint, md_.string(Tab::Field, f, 1));
+                }
+            }
+            auto num = [&]<typename T>(T) {
+                T x{};
+                std::memcpy(&x, v.data(), std::min(sizeof x, v.size()));
+                return x;
+            };
+            auto integral = [&](auto x) {
+                static constexpr std::string_view builtins[] = {
+                    "sbyte", "byte", "short", "ushort", "int", "uint", "long", "ulong", "char", "float", "double", "decimal", "object",
+                };
+                auto text = std::format("{}", x);
+                bool builtin = std::ranges::find(builtins, hint) != std::end(builtins) || hint.ends_with('?');
+                return builtin ? text : std::format("({}){}", hint, text);
+            };
+            auto real = [](auto x, std::string_view type, std::string_view suffix) -> std::string {
+                if (std::isnan(x))
+                    return std::format("{}.NaN", type);
+                if (std::isinf(x))
+                    return std::format("{}.{}Infinity", type, x > 0 ? "Positive" : "Negative");
+                auto text = std::format("{}", x);
+                if (suffix.empty() && text.find_first_of(".e") == std::string::npos)
+                    text += ".0";
+                return text + std::string(suffix);
+            };
+            switch (kind) {
+            case 0x02: return num(std::uint8_t{}) ? "true" : "false";
+            case 0x03: {
+                auto c = num(char16_t{});
+                if (c == '\'' || c == '\\')
+                    return std::format("'\\{}'", static_cast<char>(c));
+                return c >= 0x20 && c < 0x7F ? std::format("'{}'", static_cast<char>(c)) : std::format("'\\u{:04X}'", static_cast<unsigned>(c));
+            }
+            case 0x04: return integral(static_cast<int>(num(std::int8_t{})));
+            case 0x05: return integral(static_cast<unsigned>(num(std::uint8_t{})));
+            case 0x06: return integral(num(std::int16_t{}));
+            case 0x07: return integral(num(std::uint16_t{}));
+            case 0x08: return integral(num(std::int32_t{}));
+            case 0x09: return integral(num(std::uint32_t{}));
+            case 0x0a: return integral(num(std::int64_t{}));
+            case 0x0b: return integral(num(std::uint64_t{}));
+            case 0x0c: return real(num(float{}), "float", "f");
+            case 0x0d: return real(num(double{}), "double", "");
+            case 0x0e: return quoted(v);
+            }
+            return valueType ? std::format("default({})", hint) : "null";
+        }
+
+        // UTF-16LE 转 UTF-8 并转义
+        static std::string quoted(std::string_view utf16) {
+            std::string out = "\"";
+            for (std::size_t i = 0; i + 1 < utf16.size(); i += 2) {
+                std::uint32_t c = static_cast<std::uint8_t>(utf16[i]) | (static_cast<std::uint8_t>(utf16[i + 1]) << 8);
+                if (c >= 0xD800 && c < 0xDC00 && i + 3 < utf16.size()) {
+                    std::uint32_t lo = static_cast<std::uint8_t>(utf16[i + 2]) | (static_cast<std::uint8_t>(utf16[i + 3]) << 8);
+                    c = 0x10000 + ((c - 0xD800) << 10) + (lo - 0xDC00);
+                    i += 2;
+                }
+                switch (c) {
+                case '"':  out += "\\\""; continue;
+                case '\\': out += "\\\\"; continue;
+                case '\n': out += "\\n"; continue;
+                case '\r': out += "\\r"; continue;
+                case '\t': out += "\\t"; continue;
+                case 0:    out += "\\0"; continue;
+                }
+                IOUtils::append_utf8(out, c);
+            }
+            return out + "\"";
+        }
+
+        /// 参数列表：ref/out/in、params、扩展方法的 this 与默认值
+        std::string parameters(std::uint32_t method, const MethodSig& sig) const {
+            std::vector<std::uint32_t> rows(sig.params.size() + 1);
+            auto [first, last] = md_.range(Tab::MethodDef, method, 5, Tab::Param);
+            for (auto i = first; i < last; ++i) {
+                auto p = md_.indirect(Tab::ParamPtr, i);
+                auto seq = md_.get(Tab::Param, p, 1);
+                if (seq < rows.size())
+                    rows[seq] = p;
+            }
+
+            std::string out;
+            for (std::size_t i = 0; i < sig.params.size(); ++i) {
+                auto row = rows[i + 1];
+                auto flags = row ? md_.get(Tab::Param, row, 0) : 0;
+                std::string_view type = sig.params[i];
+                if (i)
+                    out += ", ";
+                if (i == 0 && extensions_.contains(method))
+                    out += "this ";
+                if (type.starts_with("ref ")) {
+                    bool in = flags & 0x1, outParam = flags & 0x2;
+                    out += outParam && !in ? "out " : in && !outParam ? "in " : "ref ";
+                    type.remove_prefix(4);
+                }
+                if (row && paramArrays_.contains(row))
+                    out += "params ";
+                out += type;
+                out += ' ';
+                auto name = row ? md_.string(Tab::Param, row, 2) : std::string_view{};
+                out += name.empty() ? std::format("P_{}", i) : std::string(name);
+                if (row && (flags & 0x1000)) {
+                    auto c = paramConstants_.find(row);
+                    if (c != paramConstants_.end())
+                        out += " = " + literal(c->second, type, sig.valueTypes[i], sig.valueTokens[i]);
+                }
+            }
+            return out;
+        }
+
+        ClassInfo describeType(std::uint32_t type) const {
+            ClassInfo info;
+            auto kind = kindOf(type);
+            auto raw = md_.string(Tab::TypeDef, type, 1);
+            auto typeParams = genericsOf(typeGenerics_, type);
+            GenericContext ctx{ typeParams, {}, type };
+
+            info.self.modifier = typeModifier(type, kind);
+            info.self.name = genericName(raw, typeParams);
+            if (kind == "delegate") {
+                // 顶层委托整体写在类型这一行：public delegate void Foo(int x)
+                auto d = delegateMethod(type, ctx);
+                info.self.type = std::move(d.type);
+                info.self.super = std::format("({})", d.parameters);
+                return info;
+            }
+            info.self.type = std::string(kind);
+            info.self.super = superList(type, kind, ctx);
+
+            std::vector<Method> methods;
+            std::vector<Field> fields;
+            std::vector<Property> properties;
+            std::vector<Constant> constants;
+            std::vector<Event> events;
+            bool inInterface = kind == "interface";
+
+            std::unordered_set<std::string_view> eventNames;
+            for (auto e : listOf(Tab::EventMap, Tab::EventPtr, Tab::Event, type))
+                eventNames.insert(md_.string(Tab::Event, e, 1));
+
+            auto [mFirst, mLast] = md_.range(Tab::TypeDef, type, 5, Tab::MethodDef);
+            for (auto i = mFirst; i < mLast; ++i) {
+                auto m = md_.indirect(Tab::MethodPtr, i);
+                auto flags = md_.get(Tab::MethodDef, m, 2);
+                auto name = md_.string(Tab::MethodDef, m, 3);
+                if (accessorMethods_.contains(m) || (flags & 0x800) || generated(name) || name.find('.') != std::string_view::npos)
+                    continue;       // 访问器、构造函数与运算符（SpecialName）、编译器生成、显式接口实现
+                auto methodParams = genericsOf(methodGenerics_, m);
+                GenericContext mctx{ typeParams, methodParams, type };
+                auto sigBlob = md_.blob(Tab::MethodDef, m, 4);
+                std::size_t pos = 0;
+                auto sig = methodSig(sigBlob, pos, mctx);
+                if (name == "Finalize" && sig.params.empty() && !(flags & 0x100) && (flags & 0x40))
+                    continue;       // 析构函数
+                Method method;
+                method.modifier = methodModifier(m, inInterface);
+                method.type = sig.ret;
+                method.name = genericName(name, methodParams, methodParams.size());
+                method.parameters = parameters(m, sig);
+                methods.push_back(std::move(method));
+            }
+
+            auto [fFirst, fLast] = md_.range(Tab::TypeDef, type, 4, Tab::Field);
+            for (auto i = fFirst; i < fLast; ++i) {
+                auto f = md_.indirect(Tab::FieldPtr, i);
+                auto flags = md_.get(Tab::Field, f, 0);
+                auto name = md_.string(Tab::Field, f, 1);
+                if ((flags & 0x400) || generated(name) || eventNames.contains(name))
+                    continue;       // value__、自动属性与字段式事件的后备字段
+                auto sigBlob = md_.blob(Tab::Field, f, 2);
+                std::size_t pos = 1;
+                auto text = decode(sigBlob, pos, ctx);
+                if (flags & 0x40) {
+                    Constant c;
+                    c.modifier = std::format("{}const ", access(flags));
+                    c.type = kind == "enum" ? std::string(stripArity(raw)) : std::move(text);
+                    c.name = std::string(name);
+                    constants.push_back(std::move(c));
+                    continue;
+                }
+                Field field;
+                field.modifier = access(flags);
+                if (flags & 0x10) field.modifier += "static ";
+                if (flags & 0x20) field.modifier += "readonly ";
+                if (isVolatile(sigBlob)) field.modifier += "volatile ";
+                field.type = std::move(text);
+                field.name = std::string(name);
+                fields.push_back(std::move(field));
+            }
+
+            for (auto p : listOf(Tab::PropertyMap, Tab::PropertyPtr, Tab::Property, type)) {
+                auto name = md_.string(Tab::Property, p, 1);
+                auto sigBlob = md_.blob(Tab::Property, p, 2);
+                std::size_t pos = 1;
+                auto count = Metadata::uncompress(sigBlob, pos);
+                if (count || generated(name) || name.find('.') != std::string_view::npos)
+                    continue;       // 索引器与显式接口实现
+                auto text = decode(sigBlob, pos, ctx);
+                auto it = propertyAccessors_.find(p);
+                Property prop;
+                if (it != propertyAccessors_.end())
+                    prop.modifier = accessorModifier(it->second.getter, it->second.setter, inInterface);
+                prop.type = std::move(text);
+                prop.name = std::string(name);
+                properties.push_back(std::move(prop));
+            }
+
+            for (auto e : listOf(Tab::EventMap, Tab::EventPtr, Tab::Event, type)) {
+                auto name = md_.string(Tab::Event, e, 1);
+                if (generated(name) || name.find('.') != std::string_view::npos)
+                    continue;
+                Event ev;
+                auto it = eventAccessors_.find(e);
+                if (it != eventAccessors_.end() && it->second.adder)
+                    ev.modifier = methodModifier(it->second.adder, inInterface);
+                ev.modifier += "event ";
+                ev.type = reference(md_.coded(Tab::Event, e, 2), ctx);
+                ev.name = std::string(name);
+                events.push_back(std::move(ev));
+            }
+
+            if (auto it = nested_.find(type); it != nested_.end()) {
+                for (auto n : it->second) {
+                    if (hidden(n))
+                        continue;
+                    if (kindOf(n) == "delegate") {
+                        auto nestedParams = genericsOf(typeGenerics_, n);
+                        auto d = delegateMethod(n, { nestedParams, {}, n });
+                        d.modifier = typeModifier(n, "delegate");
+                        d.name = genericName(md_.string(Tab::TypeDef, n, 1), nestedParams);
+                        methods.push_back(std::move(d));
+                        continue;
+                    }
+                    info.nested.push_back(describeType(n));
+                }
+            }
+
+            info.members = MemberArr{
+                std::pair{    "Method"sv, std::move(methods)    },
+                std::pair{     "Field"sv, std::move(fields)     },
+                std::pair{  "Property"sv, std::move(properties) },
+                std::pair{  "Constant"sv, std::move(constants)  },
+                std::pair{     "Event"sv, std::move(events)     },
+            };
+            return info;
+        }
+
+        // 属性取两个访问器中可见性更高的那个的修饰符
+        std::string accessorModifier(std::uint32_t getter, std::uint32_t setter, bool inInterface) const {
+            auto visibility = [&](std::uint32_t m) { return m ? md_.get(Tab::MethodDef, m, 2) & 0x7 : 0; };
+            auto m = visibility(getter) >= visibility(setter) ? getter : setter;
+            return m ? methodModifier(m, inInterface) : std::string{};
+        }
+
+        /// 委托的 Invoke 签名，写成 delegate 返回类型 + 参数
+        Method delegateMethod(std::uint32_t type, const GenericContext& ctx) const {
+            Method d;
+            auto [first, last] = md_.range(Tab::TypeDef, type, 5, Tab::MethodDef);
+            for (auto i = first; i < last; ++i) {
+                auto m = md_.indirect(Tab::MethodPtr, i);
+                if (md_.string(Tab::MethodDef, m, 3) != "Invoke")
+                    continue;
+                auto blob = md_.blob(Tab::MethodDef, m, 4);
+                std::size_t pos = 0;
+                auto sig = methodSig(blob, pos, ctx);
+                d.type = "delegate " + sig.ret;
+                d.parameters = parameters(m, sig);
+                break;
+            }
+            return d;
+        }
+
+        /// 基类与接口列表，形如 ": Base, IFoo"；enum 只在底层类型不是 int 时写出
+        std::string superList(std::uint32_t type, std::string_view kind, const GenericContext& ctx) const {
+            std::vector<std::string> parts;
+            if (kind == "enum") {
+                auto [first, last] = md_.range(Tab::TypeDef, type, 4, Tab::Field);
+                for (auto i = first; i < last; ++i) {
+                    auto f = md_.indirect(Tab::FieldPtr, i);
+                    if (!(md_.get(Tab::Field, f, 0) & 0x400))
+                        continue;
+                    auto sig = md_.blob(Tab::Field, f, 2);
+                    std::size_t pos = 1;
+                    auto underlying = decode(sig, pos, ctx);
+                    if (underlying != "int")
+                        parts.push_back(std::move(underlying));
+                }
+            }
+            else if (kind == "class") {
+                auto base = md_.coded(Tab::TypeDef, type, 3);
+                if (base && baseName(type) != "System.Object")
+                    parts.push_back(reference(base, ctx));
+            }
+            if (auto it = interfaces_.find(type); it != interfaces_.end())
+                for (auto i : it->second)
+                    parts.push_back(reference(i, ctx));
+
+            std::string out;
+            for (auto&& p : parts)
+                out += (out.empty() ? ": " : ", ") + p;
+            return out;
+        }
+
+        // 基类、接口与事件类型处的 TypeDefOrRef；TypeSpec 需要在本类型的泛型上下文里解
+        std::string reference(Token t, const GenericContext& ctx) const {
+            if (t.table != Tab::TypeSpec)
+                return named(t, {}, ctx.scope);
+            auto sig = md_.blob(Tab::TypeSpec, t.row, 0);
+            std::size_t pos = 0;
+            return decode(sig, pos, ctx);
+        }
+
+        /// PropertyMap/EventMap 中某个类型拥有的属性或事件行
+        std::vector<std::uint32_t> listOf(Tab map, Tab ptr, Tab target, std::uint32_t type) const {
+            std::vector<std::uint32_t> out;
+            auto& rows = map == Tab::PropertyMap ? propertyMap_ : eventMap_;
+            auto it = rows.find(type);
+            if (it == rows.end())
+                return out;
+            auto [first, last] = md_.range(map, it->second, 1, target);
+            for (auto i = first; i < last; ++i)
+                out.push_back(md_.indirect(ptr, i));
+            return out;
+        }
+
+        const Metadata& md_;
+        std::unordered_map<std::uint32_t, std::uint32_t> enclosing_;                     // 嵌套类型 -> 外层类型
+        std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> nested_;           // 外层类型 -> 嵌套类型
+        std::unordered_map<std::uint32_t, std::vector<Token>> interfaces_;
+        std::unordered_map<std::uint32_t, std::vector<std::string>> typeGenerics_, methodGenerics_;
+        std::unordered_set<std::uint32_t> accessorMethods_;
+        std::unordered_map<std::uint32_t, Accessors> propertyAccessors_, eventAccessors_;
+        std::unordered_map<std::uint32_t, std::uint32_t> paramConstants_, fieldConstants_;      // Param/Field -> Constant
+        std::unordered_set<std::uint32_t> paramArrays_, extensions_;
+        std::unordered_map<std::uint32_t, std::uint32_t> methodOwner_;
+        std::unordered_map<std::uint32_t, std::uint32_t> propertyMap_, eventMap_;      // 类型 -> PropertyMap/EventMap 行
+    };
+
+} // namespace clr
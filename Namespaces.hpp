@@ -0,0 +1,240 @@
+#pragma once
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <span>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <ranges>
+#include <format>
+#include <iterator>
+#include <stdexcept>
+#include <cstdint>
+
+#include "ClassInfo.hpp"
+#include "SymbolIndex.hpp"
+#include "IOUtils.hpp"
+
+/// 命名空间列表：解析时顺手记下每个文件的顶层类型（种类 + 全名），按组汇总成
+/// Export-DuckovDlls.ps1 与 ListRootNamespaces.ps1 的两种输出，不必再为每个 DLL 多跑两遍 ilspycmd。
+/// 组即输入目录下的第一层子目录（ilspycmd 导出的各程序集），dll 子命令下为程序集名
+namespace nslist {
+
+    namespace fs = std::filesystem;
+
+    enum class TypeKind : char {
+        Class = 'c',
+        Interface = 'i',
+        Struct = 's',
+        Enum = 'e',
+    };
+
+    inline constexpr std::string_view kindLabel(TypeKind k) noexcept {
+        switch (k) {
+        case TypeKind::Interface: return "Interface";
+        case TypeKind::Struct:    return "Struct";
+        case TypeKind::Enum:      return "Enum";
+        default:                  return "Class";
+        }
+    }
+
+    /// class/struct/interface/enum/record 等关键字对应的种类，委托等不算类型，返回 false
+    inline bool kindOf(std::string_view keyword, TypeKind& kind) noexcept {
+        if (keyword.starts_with("record"))
+            keyword = keyword.ends_with("struct") ? "struct" : "class";
+        if (keyword == "class")          kind = TypeKind::Class;
+        else if (keyword == "interface") kind = TypeKind::Interface;
+        else if (keyword == "struct")    kind = TypeKind::Struct;
+        else if (keyword == "enum")      kind = TypeKind::Enum;
+        else
+            return false;
+        return true;
+    }
+
+    struct TypeName {
+        TypeKind kind{};
+        std::string fullName;          // 命名空间.类型名，不含泛型参数；没有命名空间时只有类型名
+
+        bool operator==(const TypeName&) const = default;
+    };
+
+    /// 收集一个文件的顶层类型，嵌套类型不单列
+    template <typename Str>
+    std::vector<TypeName> collectTypes(const BasicClassInfo<Str>& info) {
+        std::vector<TypeName> out;
+        auto add = [&](const BasicClassInfo<Str>& t) {
+            TypeName n;
+            auto name = symidx::keyName(t.self.name);
+            if (name.empty() || !kindOf(t.self.type, n.kind))
+                return;
+            n.fullName = info.namespaceName.empty() ? std::string(name) : std::format("{}.{}", info.namespaceName, name);
+            out.push_back(std::move(n));
+        };
+        add(info);
+        for (auto&& t : info.others)
+            add(t);
+        return out;
+    }
+
+    struct Filter {
+        std::vector<std::string> prefixes;     // 只列这些命名空间前缀下的类型，空表示全部
+        unsigned depth = 1;                     // 相对前缀再展开几层
+        unsigned rootDepth = 1;                 // 根命名空间列表取前几段
+        bool allKinds = false;                  // 命名空间列表也列结构体与枚举，默认同脚本只列类与接口
+    };
+
+    namespace detail {
+        // PowerShell 的 Sort-Object 不区分大小写，列表保持同样的顺序
+        inline bool lessIgnoreCase(std::string_view a, std::string_view b) noexcept {
+            auto lower = [](char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c; };
+            auto cmp = std::lexicographical_compare_three_way(a.begin(), a.end(), b.begin(), b.end(),
+                [&](char x, char y) { return lower(x) <=> lower(y); });
+            return cmp != 0 ? cmp < 0 : a < b;
+        }
+
+        inline std::string joined(const std::set<std::string, bool(*)(std::string_view, std::string_view)>& lines) {
+            std::string out = "\xEF\xBB\xBF";       // 与脚本 Out-File -Encoding UTF8 一样带 BOM
+            for (auto&& l : lines)
+                out.append(l).push_back('\n');
+            return out;
+        }
+
+        inline std::size_t segments(std::string_view name) noexcept {
+            return name.empty() ? 0 : static_cast<std::size_t>(std::ranges::count(name, '.')) + 1;
+        }
+
+        // 前 n 段：Duckov.UI.Foo, 2 -> Duckov.UI
+        inline std::string_view leading(std::string_view name, std::size_t n) noexcept {
+            std::size_t end = 0;
+            for (std::size_t k = 0; k < n; ++k) {
+                end = name.find('.', k ? end + 1 : 0);
+                if (end == std::string_view::npos)
+                    return name;
+            }
+            return name.substr(0, end);
+        }
+    }
+
+    /// 同 Export-DuckovDlls.ps1：匹配最长的前缀，列出前缀往下 depth 层内的命名空间与类型；
+    /// 脚本只看类与接口，结构体与枚举（连同只含它们的命名空间）要 allKinds 才列出
+    inline std::string namespaceListing(std::span<const TypeName> types, const Filter& filter) {
+        auto prefixes = filter.prefixes.empty() ? std::vector<std::string>{ "" } : filter.prefixes;
+        std::ranges::stable_sort(prefixes, std::ranges::greater{}, &std::string::size);
+
+        std::set<std::string, bool(*)(std::string_view, std::string_view)> lines(detail::lessIgnoreCase);
+        for (auto&& t : types) {
+            if (!filter.allKinds && t.kind != TypeKind::Class && t.kind != TypeKind::Interface)
+                continue;
+            std::string_view full = t.fullName;
+            auto it = std::ranges::find_if(prefixes, [&](std::string_view p) {
+                return p.empty() || full == p || (full.starts_with(p) && full[p.size()] == '.');
+            });
+            if (it == prefixes.end())
+                continue;
+
+            auto parts = detail::segments(full);
+            auto max = detail::segments(*it) + filter.depth;
+            for (auto i = std::max<std::size_t>(detail::segments(*it), 1); i < parts && i <= max; ++i)
+                lines.insert(std::format("Namespace {}", detail::leading(full, i)));
+            if (parts <= max)
+                lines.insert(std::format("{} {}", kindLabel(t.kind), full));
+        }
+        return detail::joined(lines);
+    }
+
+    /// 同 ListRootNamespaces.ps1：各类型所在命名空间的前 rootDepth 段，没有命名空间的记为 <Global Namespace>
+    inline std::string rootListing(std::span<const TypeName> types, const Filter& filter) {
+        std::set<std::string, bool(*)(std::string_view, std::string_view)> lines(detail::lessIgnoreCase);
+        for (auto&& t : types) {
+            auto dot = t.fullName.rfind('.');
+            if (dot == std::string::npos)
+                lines.insert("<Global Namespace>");
+            else
+                lines.emplace(detail::leading(std::string_view(t.fullName).substr(0, dot), std::max(filter.rootDepth, 1u)));
+        }
+        return detail::joined(lines);
+    }
+
+    /// 增量分析时未变化的文件不会重新解析，各文件的类型记在输出目录旁的 <输出目录>.types 里，
+    /// 格式同清单：版本戳一行，之后每行 相对路径\t种类全名\t...
+    class Catalog {
+    public:
+        explicit Catalog(std::uint64_t stamp = 0) : stamp_(stamp) {}
+
+        static fs::path pathFor(const fs::path& outputDir) {
+            return IOUtils::sibling_path(outputDir, ".types");
+        }
+
+        /// 文件不存在或版本戳不符时返回空目录，缺的记录由调用方重新解析补齐
+        static Catalog load(const fs::path& file, std::uint64_t stamp) {
+            Catalog c(stamp);
+            std::ifstream in(file, std::ios::binary);
+            std::string line;
+            if (!in || !std::getline(in, line) || line != header(stamp))
+                return c;
+            while (std::getline(in, line)) {
+                auto fields = line | std::views::split('\t');
+                auto it = fields.begin();
+                if (it == fields.end())
+                    continue;
+                auto& types = c.entries_[std::string(std::string_view(*it))];
+                for (++it; it != fields.end(); ++it) {
+                    std::string_view f(*it);
+                    TypeName t;
+                    if (f.size() < 2 || !std::string_view("cise").contains(f[0]))
+                        return Catalog(stamp);      // 损坏的目录整体作废
+                    t.kind = static_cast<TypeKind>(f[0]);
+                    t.fullName = f.substr(1);
+                    types.push_back(std::move(t));
+                }
+            }
+            return c;
+        }
+
+        void save(const fs::path& file) const {
+            std::string buf = header(stamp_) + '\n';
+            for (auto&& [key, types] : entries_) {
+                buf += key;
+                for (auto&& t : types)
+                    std::format_to(std::back_inserter(buf), "\t{}{}", static_cast<char>(t.kind), t.fullName);
+                buf += '\n';
+            }
+            IOUtils::write_file(file, buf);
+        }
+
+        const std::vector<TypeName>* find(const std::string& key) const {
+            auto it = entries_.find(key);
+            return it == entries_.end() ? nullptr : &it->second;
+        }
+
+        void set(std::string key, std::vector<TypeName> types) { entries_.insert_or_assign(std::move(key), std::move(types)); }
+        void erase(const std::string& key) { entries_.erase(key); }
+
+        const std::map<std::string, std::vector<TypeName>>& entries() const noexcept { return entries_; }
+
+    private:
+        std::uint64_t stamp_;
+        std::map<std::string, std::vector<TypeName>> entries_;
+
+        static std::string header(std::uint64_t stamp) {
+            return std::format("AnalyzeCsClass types {:016x}", stamp);
+        }
+    };
+
+    /// 把各组的两种列表写到 <目录>/<组>.txt，目录为空的一种不写；内容未变的不重写。返回写出的文件数
+    inline std::size_t writeListings(const std::map<std::string, std::vector<TypeName>>& groups, const Filter& filter,
+                                     const fs::path& namespaceDir, const fs::path& rootDir) {
+        std::size_t written = 0;
+        for (auto&& [group, types] : groups) {
+            if (!namespaceDir.empty())
+                written += IOUtils::write_file(namespaceDir / (group + ".txt"), namespaceListing(types, filter));
+            if (!rootDir.empty())
+                written += IOUtils::write_file(rootDir / (group + ".txt"), rootListing(types, filter));
+        }
+        return written;
+    }
+
+} // namespace nslist
@@ -0,0 +1,331 @@
+#pragma once
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <charconv>
+#include <format>
+#include <stdexcept>
+#include <system_error>
+#include <cerrno>
+
+#if defined(_WIN32)
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+#include "ClassInfo.hpp"
+#include "SymbolIndex.hpp"
+
+/// --format ndjson：每个类型、每个成员各一行 JSON，供 jq 等工具直接消费，不必再用正则解析 .out.txt。
+/// 序列化直接追加到调用方复用的缓冲区里，字段都取自 ClassInfoView 指向的源文本，不产生临时字符串
+namespace ndjson {
+
+    namespace fs = std::filesystem;
+
+    /// 写出目标：文件或标准输出（路径为 -），带缓冲，大块直接写
+    class Sink {
+    public:
+        explicit Sink(const fs::path& path) {
+            if (path == "-") {
+#if defined(_WIN32)
+                _setmode(_fileno(stdout), _O_BINARY);      // 换行保持 \n
+#endif
+                file_ = stdout;
+            }
+            else {
+                if (path.has_parent_path())
+                    fs::create_directories(path.parent_path());
+#if defined(_WIN32)
+                file_ = _wfopen(path.c_str(), L"wb");
+#else
+                file_ = std::fopen(path.c_str(), "wb");
+#endif
+                if (!file_)
+                    throw std::system_error(errno, std::generic_category(), std::format("无法写入 {}", path.string()));
+                owned_ = true;
+            }
+            buf_.reserve(Capacity);
+        }
+
+        ~Sink() {
+            try {
+                flush();
+            }
+            catch (...) {}
+            if (owned_)
+                std::fclose(file_);
+        }
+
+        Sink(const Sink&) = delete;
+        Sink& operator=(const Sink&) = delete;
+
+        void write(std::string_view s) {
+            if (buf_.size() + s.size() > Capacity) {
+                flush();
+                if (s.size() >= Capacity) {
+                    put(s);
+                    return;
+                }
+            }
+            buf_.append(s);
+        }
+
+        void flush() {
+            put(buf_);
+            buf_.clear();
+            if (std::fflush(file_) != 0)
+                throw std::system_error(errno, std::generic_category(), "写出 NDJSON");
+        }
+
+    private:
+        static constexpr std::size_t Capacity = 1 << 20;
+
+        std::FILE* file_ = nullptr;
+        bool owned_ = false;
+        std::string buf_;
+
+        void put(std::string_view s) {
+            if (!s.empty() && std::fwrite(s.data(), 1, s.size(), file_) != s.size())
+                throw std::system_error(errno, std::generic_category(), "写出 NDJSON");
+        }
+    };
+
+    namespace detail {
+        inline constexpr char Hex[] = "0123456789abcdef";
+
+        // 需要转义的字符：引号、反斜杠与控制字符
+        inline constexpr bool plain(char c) noexcept {
+            return c != '"' && c != '\\' && static_cast<unsigned char>(c) >= 0x20;
+        }
+
+        inline void escapeChar(std::string& out, char c) {
+            switch (c) {
+            case '"':  out.append("\\\""); break;
+            case '\\': out.append("\\\\"); break;
+            case '\n': out.append("\\n"); break;
+            case '\r': out.append("\\r"); break;
+            case '\t': out.append("\\t"); break;
+            default: {
+                const char u[] = { '\\', 'u', '0', '0', Hex[(c >> 4) & 0xF], Hex[c & 0xF] };
+                out.append(u, sizeof(u));
+            }
+            }
+        }
+    } // namespace detail
+
+    /// 把字符串转义后追加进 out，成段拷贝不需要转义的部分
+    inline void escape(std::string& out, std::string_view s) {
+        std::size_t run = 0;
+        for (std::size_t i = 0; i < s.size(); ++i) {
+            if (detail::plain(s[i]))
+                continue;
+            out.append(s.data() + run, i - run);
+            detail::escapeChar(out, s[i]);
+            run = i + 1;
+        }
+        out.append(s.data() + run, s.size() - run);
+    }
+
+    /// 同 escape，但把连续空白压成一个空格并去掉首尾空白，跨行的声明写成单行（同 symidx::squeeze）
+    inline void escapeSqueezed(std::string& out, std::string_view s) {
+        bool space = false, any = false;
+        for (char c : s) {
+            if (cs::detail::isSpace(c)) {
+                space = any;
+                continue;
+            }
+            if (space && out.back() != '(')
+                out.push_back(' ');
+            space = false;
+            any = true;
+            if (detail::plain(c))
+                out.push_back(c);
+            else
+                detail::escapeChar(out, c);
+        }
+    }
+
+    /// 一个文件的全部记录。类型行：record、file、namespace、kind（class/struct/...）、modifiers、name、super、owner（外层类型的全名，顶层为 null）；
+    /// 成员行：record、file、namespace、kind（method/field/...）、modifiers、type、name、parameters（仅方法）、owner
+    class Writer {
+    public:
+        /// out 与 scope 由调用方复用，容量够了之后不再分配
+        Writer(std::string& out, std::string& scope) : out_(out), scope_(scope) {}
+
+        template <typename Str>
+        void file(std::string_view path, const BasicClassInfo<Str>& info) {
+            path_ = path;
+            ns_ = info.namespaceName;
+            scope_.assign(ns_);
+            type(info);
+            for (auto&& other : info.others)
+                type(other);
+        }
+
+    private:
+        std::string& out_;
+        std::string& scope_;        // 当前类型的全名，进出嵌套类型时追加、截断
+        std::string_view path_, ns_;
+
+        static constexpr std::string_view MemberKinds[] = { "method", "field", "property", "constant", "event" };
+
+        void key(std::string_view k) {
+            if (out_.back() != '{')
+                out_.push_back(',');
+            out_.push_back('"');
+            out_.append(k);
+            out_.append("\":");
+        }
+
+        void string(std::string_view k, std::string_view v, bool squeezed = true) {
+            key(k);
+            out_.push_back('"');
+            squeezed ? escapeSqueezed(out_, v) : escape(out_, v);
+            out_.push_back('"');
+        }
+
+        // 所在类型的全名；顶层类型与文件层零散的声明为 null
+        void owner() {
+            if (scope_.size() == ns_.size()) {
+                key("owner");
+                out_.append("null");
+            }
+            else
+                string("owner", scope_, false);
+        }
+
+        void begin(std::string_view record) {
+            out_.push_back('{');
+            string("record", record, false);
+            string("file", path_, false);
+            string("namespace", ns_, false);
+        }
+
+        // 父类列表去掉开头的冒号
+        static std::string_view superOf(std::string_view s) {
+            while (!s.empty() && (cs::detail::isSpace(s.front()) || s.front() == ':'))
+                s.remove_prefix(1);
+            return s;
+        }
+
+        template <typename Str>
+        void type(const BasicClassInfo<Str>& c) {
+            auto name = symidx::keyName(c.self.name);
+            const auto outer = scope_.size();
+            if (!name.empty()) {
+                begin("type");
+                string("kind", c.self.type);
+                string("modifiers", c.self.modifier);
+                string("name", c.self.name);
+                string("super", superOf(c.self.super));
+                owner();
+                out_.append("}\n");
+                if (!scope_.empty())
+                    scope_.push_back('.');
+                scope_.append(name);
+            }
+
+            for (std::size_t k = 0; k < c.members.size(); ++k) {
+                std::visit([&](auto&& v) {
+                    for (auto&& m : v) {
+                        begin("member");
+                        string("kind", MemberKinds[k], false);
+                        string("modifiers", m.modifier);
+                        string("type", m.type);
+                        string("name", m.name);
+                        if constexpr (requires { m.parameters; })
+                            string("parameters", m.parameters);
+                        owner();
+                        out_.append("}\n");
+                    }
+                }, c.members[k].second);
+            }
+            for (auto&& n : c.nested)
+                type(n);
+            scope_.resize(outer);
+        }
+    };
+
+    /// 记录的 file 字段（还原转义后的相对路径）；不是本工具写出的记录时返回 false
+    inline bool fileOf(std::string_view line, std::string& out) {
+        constexpr std::string_view key = ",\"file\":\"";
+        auto p = line.find(key);
+        if (p == std::string_view::npos)
+            return false;
+        out.clear();
+        for (p += key.size(); p < line.size(); ++p) {
+            char c = line[p];
+            if (c == '"')
+                return true;
+            if (c != '\\' || ++p == line.size()) {
+                out.push_back(c);
+                continue;
+            }
+            switch (line[p]) {
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            case 't': out.push_back('\t'); break;
+            case 'u': {     // 只会是 \u00XX
+                unsigned char v = 0;
+                if (p + 4 >= line.size() || line.substr(p + 1, 2) != "00")
+                    return false;
+                auto [q, ec] = std::from_chars(line.data() + p + 3, line.data() + p + 5, v, 16);
+                if (ec != std::errc{} || q != line.data() + p + 5)
+                    return false;
+                out.push_back(static_cast<char>(v));
+                p += 4;
+                break;
+            }
+            default: out.push_back(line[p]);
+            }
+        }
+        return false;
+    }
+
+    /// 把各分片按路径排好序的流归并成一条，同一文件的记录保持连续，结果与单机写出的流相同；返回记录数
+    inline std::size_t merge(const std::vector<fs::path>& inputs, Sink& out) {
+        struct Input {
+            std::ifstream in;
+            std::string line, file;
+            bool more = false;
+
+            void next(const fs::path& path) {
+                more = static_cast<bool>(std::getline(in, line));
+                if (more && !fileOf(line, file))
+                    throw std::runtime_error(std::format("{} 中有无法识别的记录：{}", path.string(), line.substr(0, 80)));
+            }
+        };
+        std::vector<Input> parts(inputs.size());
+        for (std::size_t k = 0; k < inputs.size(); ++k) {
+            parts[k].in.open(inputs[k], std::ios::binary);
+            if (!parts[k].in)
+                throw std::runtime_error(std::format("无法读取 {}", inputs[k].string()));
+            parts[k].next(inputs[k]);
+        }
+
+        std::size_t records = 0;
+        std::string file;
+        while (true) {
+            Input* least = nullptr;
+            for (auto&& p : parts)
+                if (p.more && (!least || p.file < least->file))
+                    least = &p;
+            if (!least)
+                break;
+            file = least->file;
+            auto k = static_cast<std::size_t>(least - parts.data());
+            do {
+                out.write(least->line);
+                out.write("\n");
+                ++records;
+                least->next(inputs[k]);
+            } while (least->more && least->file == file);
+        }
+        return records;
+    }
+
+} // namespace ndjson
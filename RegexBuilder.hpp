@@ -1,109 +1,377 @@
 #pragma once
 #include <regex>
 #include <string>
-#include <vector>
+#include <string_view>
+#include <array>
 #include <optional>
-#include <sstream>
-#include <functional>
+#include <stdexcept>
+#include <format>
 #include <ranges>
+#include <utility>
 #include <algorithm>
+#include <chrono>
 
-#include "Logger.hpp"
 using namespace std::literals;
 
+/// 编译期拼接用的定长字符串，超出容量时常量求值直接报错
+template <std::size_t N>
+struct FixedString {
+    std::array<char, N> data{};
+    std::size_t size = 0;
+
+    constexpr void append(std::string_view s) {
+        if (size + s.size() > N)
+            throw std::length_error("FixedString 容量不足");
+        for (char c : s)
+            data[size++] = c;
+    }
+
+    constexpr std::string_view view() const noexcept { return { data.data(), size }; }
+    constexpr operator std::string_view() const noexcept { return view(); }
+};
+
+template <std::size_t N>
+struct std::formatter<FixedString<N>> : std::formatter<std::string_view> {
+    auto format(const FixedString<N>& s, std::format_context& ctx) const {
+        return std::formatter<std::string_view>::format(s.view(), ctx);
+    }
+};
+
 template <typename  T, typename Member = std::string>
     requires std::is_assignable_v<Member&, const Member&>
 struct RegexPart {
-    std::string_view pattern;      // ʵʵ
-    std::string_view suffix;       // ׺?+
+    std::string_view pattern;      // 实际的正则内容
+    std::string_view suffix;       // 后缀，如?、+等
 
-    bool grouped;      // Ƿӷ
+    bool grouped;      // 是否加分组
 
     using FieldType = std::remove_cvref_t<Member>;
-    std::optional<FieldType T::*> member; // Ŀ
+    std::optional<FieldType T::*> member; // 捕获的目标
 
-    template<typename B>    // ֹconst char*ƥ䵽bool
+    template<typename B>    // 防止const char*匹配到bool
         requires std::is_same_v<std::remove_cvref_t<B>, bool>
-    RegexPart(std::string_view pattern, B grouped)
-        : pattern(pattern), grouped(grouped) {
-        LOG_TRACE("ù1pattern = {}, grouped = {}", pattern, grouped);
-    }
+    constexpr RegexPart(std::string_view pattern, B grouped)
+        : pattern(pattern), grouped(grouped) {}
 
-    // Ҫ׺߲һ
-    RegexPart(std::string_view pattern, std::string_view suffix = ""sv)
+    // 如果需要后缀，则一定加分组
+    constexpr RegexPart(std::string_view pattern, std::string_view suffix = ""sv)
         : RegexPart(pattern, true) {
-        LOG_TRACE("ù2pattern = {}, suffix = {}", pattern, suffix.size() ? suffix : ""sv);
         this->suffix = suffix;
     }
 
-    RegexPart(Member T::* mem, std::string_view pattern, std::string_view suffix = ""sv)
+    constexpr RegexPart(Member T::* mem, std::string_view pattern, std::string_view suffix = ""sv)
         : RegexPart(pattern, suffix) {
-        LOG_TRACE("ù3pattern = {}, suffix = {}", pattern, suffix.size() ? suffix : ""sv);
         member = mem;
     }
 
-    std::string toRegex()const {
-        if (!grouped)
-            return std::string(pattern);
-
-        return "("s
-             + (capturing() ? "" : "?:")
-             + std::string(pattern)
-             + ")"
-             + std::string(suffix);
+    template <std::size_t N>
+    constexpr void appendTo(FixedString<N>& out) const {
+        if (!grouped) {
+            out.append(pattern);
+            return;
+        }
+        out.append(capturing() ? "("sv : "(?:"sv);
+        out.append(pattern);
+        out.append(")"sv);
+        out.append(suffix);
     }
 
-    bool capturing()const noexcept {
+    constexpr bool capturing()const noexcept {
         return member.has_value();
     }
-
-    void assign(T& obj, const Member& value) const noexcept {
-        if (member)
-            obj.*(*member) = value;
-    }
 };
 
-template <typename T>
+/// 编译期描述一条正则：模式串与“第 i 个捕获组 -> 成员”的映射都在常量求值中拼好
+template <typename T, std::size_t Capacity = 512, std::size_t MaxCaptures = 8>
 class RegexBuilder {
-    std::vector<RegexPart<T>> parts;
-    std::regex re;
-    std::string default_delimiter;
+    std::string_view default_delimiter;
 public:
-    std::string pattern;
-    // ǰ׺
-    RegexBuilder(std::string_view prefix = ""sv, std::string_view default_delimiter = ""sv)
-        : pattern(prefix), default_delimiter(default_delimiter) {}
+    using value_type = T;
+    using string_type = typename T::string_type;
+    using MemberPtr = string_type T::*;
+
+    FixedString<Capacity> pattern;
+    std::array<MemberPtr, MaxCaptures> members{};
+    std::size_t captures = 0;
+
+    // 可以前缀
+    constexpr RegexBuilder(std::string_view prefix = ""sv, std::string_view default_delimiter = ""sv)
+        : default_delimiter(default_delimiter) {
+        pattern.append(prefix);
+    }
 
     template <typename... Val>
         requires(sizeof...(Val) >= 1)
-    RegexBuilder& join_with(std::string_view pre, Val&&... val) {
-        LOG_TRACE("join_withpre = {}", pre.size() ? pre : ""sv);
-        parts.emplace_back(std::forward<Val>(val)...);
-        pattern += std::string(pre) + parts.back().toRegex();
+    constexpr RegexBuilder& join_with(std::string_view pre, Val&&... val) {
+        RegexPart<T, string_type> part(std::forward<Val>(val)...);
+        pattern.append(pre);
+        part.appendTo(pattern);
+        if (part.capturing()) {
+            if (captures == MaxCaptures)
+                throw std::length_error("捕获组过多");
+            members[captures++] = *part.member;
+        }
         return *this;
     }
 
     template <typename... Val>
-    RegexBuilder& join(Val&&... val) {
+    constexpr RegexBuilder& join(Val&&... val) {
         return join_with(default_delimiter, std::forward<Val>(val)...);
     }
 
-    RegexBuilder& build() {
-        re = std::regex(pattern);
+    // 正则改为首次匹配时才编译，保留以兼容原有的链式写法
+    constexpr RegexBuilder& build() {
         return *this;
     }
+};
+
+/// 匹配可能的起点范围 [begin, last]，由预筛给出；各窗口按 begin 升序，不要求互不重叠
+struct AnchorWindow {
+    std::size_t begin = 0;
+    std::size_t last = 0;
+};
+
+/// 只在候选窗口内逐个位置尝试 match_continuous，结果与 regex_iterator 整段扫描一致，前提是
+/// 窗口覆盖了所有可能的匹配起点且正则不会匹配空串：最左起点的匹配必定最先被试到，同一起点的分支优先级不变。
+/// windows(fn) 按顺序对每个窗口调用 fn，fn 返回 false 时应停止；onMatch 返回 false 时结束搜索
+template <typename Windows, typename OnMatch>
+void searchAnchored(std::string_view code, const std::regex& re, Windows&& windows, OnMatch&& onMatch) {
+    const char* const first = code.data();
+    const char* const last = code.data() + code.size();
+    std::size_t from = 0;       // 之前的位置都已试过或已被匹配消耗
+    std::cmatch m;
+    windows([&](AnchorWindow w) {
+        for (std::size_t p = std::max(w.begin, from); p <= w.last && p < code.size(); ++p) {
+            auto flags = std::regex_constants::match_continuous;
+            if (p > 0)
+                flags |= std::regex_constants::match_prev_avail;
+            from = p + 1;
+            if (!std::regex_search(first + p, last, m, re, flags))
+                continue;
+            from = std::max(from, p + static_cast<std::size_t>(m.length(0)));
+            return static_cast<bool>(onMatch(m));
+        }
+        return true;
+    });
+}
+
+/// 正则路径的限额。std::regex 回溯的代价随文本长度增长，libstdc++ 的实现还是递归的，过长的文本会耗尽栈
+struct RegexBudget {
+    std::size_t window = 4096;                      // 单次尝试的文本上限（字节）
+    std::chrono::milliseconds perFile{ 2000 };      // 每个文件的匹配时限，0 表示不限
+};
+
+/// 一个文件在正则路径上的统计，分支编号同 FusedRegex 的模板参数顺序
+struct RegexStats {
+    using clock = std::chrono::steady_clock;
+    static constexpr std::size_t MaxBranches = 8;
+
+    struct Cost {
+        std::size_t count = 0;
+        clock::duration time{};
+
+        void add(clock::duration d) noexcept { ++count; time += d; }
+    };
+
+    std::array<Cost, MaxBranches> matched{};    // 各分支匹配成功的尝试
+    Cost missed;                                // 没有匹配的尝试
+    std::size_t longDecls = 0;                  // 超过窗口上限的声明
+    std::size_t errors = 0;                     // 正则库抛出的 regex_error（如 error_complexity、error_stack）
+    std::size_t fallbacks = 0;                  // 改由扫描器处理的声明层文本段数
+    bool timedOut = false;
+
+    clock::duration total() const noexcept {
+        auto t = missed.time;
+        for (auto&& c : matched)
+            t += c.time;
+        return t;
+    }
+
+    bool degraded() const noexcept { return fallbacks > 0; }
+};
+
+/// 一个文件的限额与统计，由 searchBounded 逐次检查
+struct RegexGuard {
+    RegexBudget budget;
+    RegexStats& stats;
+    RegexStats::clock::time_point deadline;
+
+    RegexGuard(const RegexBudget& budget, RegexStats& stats)
+        : budget(budget), stats(stats),
+          deadline(budget.perFile.count() > 0 ? RegexStats::clock::now() + budget.perFile : RegexStats::clock::time_point::max()) {}
+};
+
+/// 从 p 开始的一条声明的范围：到第一个不在括号里的 ; 为止（含），没有则到文本末尾；超过 limit 字节时返回 npos。
+/// 成员正则里能越过 ; 的只有参数列表 [^)]*，而它总在括号里，所以只在这个范围内匹配结果不变
+inline std::size_t declarationEnd(std::string_view code, std::size_t p, std::size_t limit) noexcept {
+    const auto n = std::min(code.size(), p + limit);
+    int depth = 0;
+    for (auto i = p; i < n; ++i) {
+        switch (code[i]) {
+        case '(': ++depth; break;
+        case ')': depth -= depth > 0; break;
+        case ';':
+            if (depth == 0)
+                return i + 1;
+            break;
+        }
+    }
+    return n == code.size() ? n : std::string_view::npos;
+}
+
+/// searchAnchored 的限额版本：每次尝试只在 declarationEnd 给出的范围内进行，耗时按 onMatch 返回的分支号记入统计。
+/// 声明超过窗口上限、超出时限或正则库报错时返回 false，已交出的结果由调用方丢弃
+template <typename Windows, typename OnMatch>
+bool searchBounded(std::string_view code, const std::regex& re, Windows&& windows, RegexGuard& guard, OnMatch&& onMatch) {
+    using clock = RegexStats::clock;
+    const char* const first = code.data();
+    std::size_t from = 0;
+    bool ok = true;
+    std::cmatch m;
+    windows([&](AnchorWindow w) {
+        for (std::size_t p = std::max(w.begin, from); p <= w.last && p < code.size(); ++p) {
+            auto start = clock::now();
+            if (start > guard.deadline) {
+                guard.stats.timedOut = true;
+                return ok = false;
+            }
+            auto end = declarationEnd(code, p, guard.budget.window);
+            if (end == std::string_view::npos) {
+                ++guard.stats.longDecls;
+                return ok = false;
+            }
+
+            auto flags = std::regex_constants::match_continuous;
+            if (p > 0)
+                flags |= std::regex_constants::match_prev_avail;
+            from = p + 1;
+            bool found;
+            try {
+                found = std::regex_search(first + p, first + end, m, re, flags);
+            }
+            catch (const std::regex_error&) {
+                ++guard.stats.errors;
+                return ok = false;
+            }
+            if (!found) {
+                guard.stats.missed.add(clock::now() - start);
+                continue;
+            }
+            from = std::max(from, p + static_cast<std::size_t>(m.length(0)));
+            std::size_t branch = onMatch(m);
+            guard.stats.matched[std::min(branch, RegexStats::MaxBranches - 1)].add(clock::now() - start);
+            return true;
+        }
+        return true;
+    });
+    return ok;
+}
+
+/// 按结构体特化的匹配器，描述来自 T::builder() 的常量求值，正则在第一次匹配时才编译
+template <typename T>
+class StaticRegex {
+public:
+    static constexpr auto spec = T::builder();
+    static constexpr std::string_view pattern = spec.pattern.view();
+
+    static const std::regex& regex() {
+        static const std::regex re(pattern.begin(), pattern.end());
+        return re;
+    }
 
-    // ƥıòĲȥ
-    auto match(const std::string& code) const {
-        std::sregex_iterator beg(code.cbegin(), code.cend(), re), end;
+    // 匹配文本，并把捕获的部分存进去；捕获组数量是常量，赋值在编译期展开
+    static auto match(std::string_view code) {
+        std::cregex_iterator beg(code.data(), code.data() + code.size(), regex()), end;
         return std::ranges::subrange(beg, end)
-             | std::views::transform([&](const auto& m) {
-                 T obj;
-                 for (auto&& [i, p] : parts | std::views::filter([](auto&& p) { return p.capturing(); })
-                                            | std::views::enumerate) {
-                     p.assign(obj, m[i + 1]); // 0Ϊ
-                 }
-                 return obj;
-             });
+             | std::views::transform([](const std::cmatch& m) { return assign(m); });
+    }
+
+    // 同 match，只在预筛给出的候选窗口里尝试，每个结果交给 sink
+    template <typename Windows, typename Sink>
+    static void scan(std::string_view code, Windows&& windows, Sink&& sink) {
+        searchAnchored(code, regex(), windows, [&](const std::cmatch& m) {
+            sink(assign(m));
+            return true;
+        });
+    }
+
+    // base 为本条正则整体所在的分组号，单独使用时为 0，合并进 FusedRegex 时为所在分支的分组号
+    // 成员为 string_view 时直接指向被匹配的文本
+    static T assign(const std::cmatch& m, std::size_t base = 0) {
+        using Str = typename T::string_type;
+        T obj;
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            ((obj.*spec.members[I] = Str(m[base + I + 1].first, static_cast<std::size_t>(m[base + I + 1].length()))), ...);
+        }(std::make_index_sequence<spec.captures>{});
+        return obj;
+    }
+};
+
+/// 把多条 StaticRegex 合成一条交替正则 (P0)|(P1)|...，从左到右扫描一遍即可得到所有种类的匹配
+/// 重叠策略：起点最靠左者胜出；起点相同时按模板参数顺序优先；已被匹配消耗的文本不再参与后续匹配
+template <typename... Ts>
+class FusedRegex {
+    static constexpr std::size_t capacity = ((StaticRegex<Ts>::pattern.size() + 3) + ...);
+
+    static constexpr auto makePattern() {
+        FixedString<capacity> out;
+        bool first = true;
+        ((out.append(first ? "("sv : "|("sv), out.append(StaticRegex<Ts>::pattern), out.append(")"sv), first = false), ...);
+        return out;
+    }
+
+    // 第 K 个分支整体的分组号，其内部捕获组紧随其后
+    static constexpr auto makeGroups() {
+        std::array<std::size_t, sizeof...(Ts)> groups{};
+        std::size_t next = 1, k = 0;
+        ((groups[k++] = next, next += StaticRegex<Ts>::spec.captures + 1), ...);
+        return groups;
+    }
+
+public:
+    static constexpr auto fused = makePattern();
+    static constexpr std::string_view pattern = fused.view();
+    static constexpr auto groups = makeGroups();
+
+    static const std::regex& regex() {
+        static const std::regex re(pattern.begin(), pattern.end());
+        return re;
+    }
+
+    /// 每得到一个匹配就调用一次 sink(对应类型的对象, 整个匹配的文本)，同类结果按出现顺序给出
+    template <typename Sink>
+    static void scan(std::string_view code, Sink&& sink) {
+        std::cregex_iterator it(code.data(), code.data() + code.size(), regex()), end;
+        for (; it != end; ++it)
+            dispatch(*it, sink, std::index_sequence_for<Ts...>{});
+    }
+
+    /// 同上，只在预筛给出的候选窗口里尝试，结果不变
+    template <typename Windows, typename Sink>
+    static void scan(std::string_view code, Windows&& windows, Sink&& sink) {
+        searchAnchored(code, regex(), windows, [&](const std::cmatch& m) {
+            dispatch(m, sink, std::index_sequence_for<Ts...>{});
+            return true;
+        });
+    }
+
+    /// 同上，按 guard 的限额逐条声明匹配；返回 false 时本段结果不完整
+    template <typename Windows, typename Sink>
+    static bool scan(std::string_view code, Windows&& windows, RegexGuard& guard, Sink&& sink) {
+        static_assert(sizeof...(Ts) <= RegexStats::MaxBranches);
+        return searchBounded(code, regex(), windows, guard, [&](const std::cmatch& m) {
+            return dispatch(m, sink, std::index_sequence_for<Ts...>{});
+        });
+    }
+
+private:
+    // 返回参与匹配的分支号
+    template <typename Sink, std::size_t... K>
+    static std::size_t dispatch(const std::cmatch& m, Sink& sink, std::index_sequence<K...>) {
+        // 交替分支中恰有一个参与了匹配
+        const std::string_view whole(m[0].first, static_cast<std::size_t>(m[0].length()));
+        std::size_t branch = 0;
+        (void)((m[groups[K]].matched && (sink(StaticRegex<Ts>::assign(m, groups[K]), whole), branch = K, true)) || ...);
+        return branch;
     }
 };
@@ -0,0 +1,727 @@
+#pragma once
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <set>
+#include <tuple>
+#include <utility>
+#include <charconv>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <format>
+#include <iterator>
+#include <algorithm>
+#include <ranges>
+#include <stdexcept>
+#include <system_error>
+#include <exception>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+#include "ClassInfo.hpp"
+#include "Namespaces.hpp"
+#include "SymbolIndex.hpp"
+#include "IOUtils.hpp"
+#include "Manifest.hpp"
+#include "ThreadPool.hpp"
+#include "Logger.hpp"
+
+/// 常驻查询服务：解析一次后把各文件的 ClassInfo 留在内存里，类型名、成员名各建一张哈希表，
+/// 通过本地 Unix 域套接字回答查询，省去每次调用的进程启动、正则编译与全量解析。
+/// 协议按行：请求为一行文本（type Foo）或扁平 JSON（{"op":"type","name":"Foo"}），回应为一行 JSON。
+/// 目前只有 Linux 实现，其他平台构造 Listener 或连接时抛异常
+namespace serve {
+
+    namespace fs = std::filesystem;
+
+    /// 套接字默认放在输入目录旁边，例如 input -> input.sock
+    inline fs::path socketPathFor(const fs::path& inputDir) {
+        return IOUtils::sibling_path(inputDir, ".sock");
+    }
+
+    namespace detail {
+        // 回应里带多行的类型文本，控制字符都要转义
+        inline void escapeTo(std::string& out, std::string_view s) {
+            for (char c : s) {
+                switch (c) {
+                case '"':  out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20)
+                        std::format_to(std::back_inserter(out), "\\u{:04x}", static_cast<unsigned>(c));
+                    else
+                        out += c;
+                }
+            }
+        }
+
+        inline std::string quoted(std::string_view s) {
+            std::string out = "\"";
+            escapeTo(out, s);
+            out += '"';
+            return out;
+        }
+    } // namespace detail
+
+    /// 一条请求。op 为 type、member、ns、roots、stats 或 reload
+    struct Request {
+        std::string op;
+        std::string name;           // type/member 要找的名字，ns 的命名空间前缀
+        unsigned depth = 1;         // ns 相对前缀展开的层数，roots 取前几段
+    };
+
+    namespace detail {
+        inline unsigned parseDepth(std::string_view text) {
+            unsigned v{};
+            auto [p, ec] = std::from_chars(text.data(), text.data() + text.size(), v);
+            if (ec != std::errc{} || p != text.data() + text.size())
+                throw std::runtime_error(std::format("depth 需要非负整数，实际为：{}", text));
+            return v;
+        }
+
+        // 只认字符串与非负整数值的扁平对象，够用即可
+        inline Request parseJson(std::string_view s) {
+            Request r;
+            std::size_t i = 0;
+            auto fail = [&] { return std::runtime_error(std::format("无法解析的 JSON 请求（位置 {}）", i)); };
+            // \u 后的 4 位十六进制，i 停在最后一位
+            auto hex4 = [&] {
+                unsigned v{};
+                if (i + 4 >= s.size())
+                    throw fail();
+                auto [p, ec] = std::from_chars(s.data() + i + 1, s.data() + i + 5, v, 16);
+                if (ec != std::errc{} || p != s.data() + i + 5)
+                    throw fail();
+                i += 4;
+                return v;
+            };
+            auto space = [&] { while (i < s.size() && cs::detail::isSpace(s[i])) ++i; };
+            auto expect = [&](char c) { space(); if (i >= s.size() || s[i] != c) throw fail(); ++i; };
+            auto string = [&] {
+                expect('"');
+                std::string out;
+                for (; i < s.size() && s[i] != '"'; ++i) {
+                    if (s[i] != '\\') {
+                        out += s[i];
+                        continue;
+                    }
+                    if (++i >= s.size())
+                        throw fail();
+                    switch (s[i]) {
+                    case 'n': out += '\n'; break;
+                    case 't': out += '\t'; break;
+                    case 'r': out += '\r'; break;
+                    case 'b': out += '\b'; break;
+                    case 'f': out += '\f'; break;
+                    case '"': case '\\': case '/': out += s[i]; break;
+                    case 'u': {
+                        // 代理对须成对出现，合成一个码点后按 UTF-8 写出
+                        auto c = hex4();
+                        if (c >= 0xD800 && c < 0xDC00) {
+                            if (i + 2 >= s.size() || s[i + 1] != '\\' || s[i + 2] != 'u')
+                                throw fail();
+                            i += 2;
+                            auto lo = hex4();
+                            if (lo < 0xDC00 || lo > 0xDFFF)
+                                throw fail();
+                            c = 0x10000 + ((c - 0xD800) << 10) + (lo - 0xDC00);
+                        }
+                        else if (c >= 0xDC00 && c <= 0xDFFF)
+                            throw fail();
+                        IOUtils::append_utf8(out, c);
+                        break;
+                    }
+                    default:
+                        throw fail();
+                    }
+                }
+                if (i >= s.size())
+                    throw fail();
+                ++i;
+                return out;
+            };
+
+            expect('{');
+            space();
+            if (i < s.size() && s[i] == '}')
+                return r;
+            while (true) {
+                auto key = string();
+                expect(':');
+                space();
+                std::string value;
+                if (i < s.size() && s[i] == '"')
+                    value = string();
+                else {
+                    auto start = i;
+                    while (i < s.size() && s[i] >= '0' && s[i] <= '9')
+                        ++i;
+                    if (start == i)
+                        throw fail();
+                    value = s.substr(start, i - start);
+                }
+                if (key == "op")
+                    r.op = std::move(value);
+                else if (key == "name" || key == "prefix")
+                    r.name = std::move(value);
+                else if (key == "depth")
+                    r.depth = parseDepth(value);
+                space();
+                if (i < s.size() && s[i] == ',') {
+                    ++i;
+                    continue;
+                }
+                expect('}');
+                return r;
+            }
+        }
+    } // namespace detail
+
+    /// 一行文本：op [名字] [深度]，或以 { 开头的 JSON
+    inline Request parseRequest(std::string_view line) {
+        while (!line.empty() && cs::detail::isSpace(line.back()))
+            line.remove_suffix(1);
+        while (!line.empty() && cs::detail::isSpace(line.front()))
+            line.remove_prefix(1);
+        if (line.starts_with('{'))
+            return detail::parseJson(line);
+
+        Request r;
+        std::vector<std::string_view> words;
+        for (auto w : line | std::views::split(' '))
+            if (!w.empty())
+                words.emplace_back(w);
+        if (words.empty())
+            return r;
+        r.op = words[0];
+        // roots 只带深度；ns 的唯一参数是纯数字时也当作深度
+        std::size_t k = 1;
+        if (r.op != "roots" && k < words.size() && !(r.op == "ns" && words.size() == 2 && std::ranges::all_of(words[1], [](char c) { return c >= '0' && c <= '9'; })))
+            r.name = words[k++];
+        if (k < words.size())
+            r.depth = detail::parseDepth(words[k++]);
+        if (k < words.size())
+            throw std::runtime_error(std::format("多余的参数：{}", words[k]));
+        return r;
+    }
+
+    /// 文件的大小与修改时间，有变化才重新解析
+    struct FileStamp {
+        std::uintmax_t size = 0;
+        fs::file_time_type mtime{};
+
+        bool operator==(const FileStamp&) const = default;
+
+        static FileStamp of(const fs::path& file) {
+            std::error_code ec;
+            FileStamp s;
+            s.size = fs::file_size(file, ec);
+            s.mtime = fs::last_write_time(file, ec);
+            return s;
+        }
+    };
+
+    /// 内存中的全部解析结果。查询持共享锁并发进行；重新解析在锁外完成，换入时才持独占锁
+    class Store {
+    public:
+        using Parse = std::function<ClassInfo(std::string_view)>;
+
+        struct Counts {
+            std::size_t files = 0, types = 0, members = 0;
+        };
+
+        /// 与磁盘比对：新出现或大小、时间有变的文件重新解析，已不在 files 中的去掉。返回有变化的文件数
+        std::size_t sync(const std::vector<fs::path>& files, const fs::path& root, const Parse& parse, unsigned jobs) {
+            std::vector<fs::path> changed;
+            std::vector<std::string> removed;
+            {
+                std::shared_lock lock(mutex_);
+                std::set<std::string> present;
+                for (auto&& file : files) {
+                    auto key = Manifest::keyFor(file, root);
+                    auto it = files_.find(key);
+                    if (it == files_.end() || it->second->stamp != FileStamp::of(file))
+                        changed.push_back(file);
+                    present.insert(std::move(key));
+                }
+                for (auto&& [key, e] : files_)
+                    if (!present.contains(key))
+                        removed.push_back(key);
+            }
+            return apply(changed, removed, root, parse, jobs);
+        }
+
+        /// 按监视到的变化更新：changed 重新解析（已不存在的当作删除），removed 去掉
+        std::size_t update(const std::vector<fs::path>& changed, const std::vector<fs::path>& removed,
+                           const fs::path& root, const Parse& parse, unsigned jobs) {
+            std::vector<fs::path> present;
+            std::vector<std::string> gone;
+            for (auto&& file : changed) {
+                std::error_code ec;
+                if (fs::is_regular_file(file, ec))
+                    present.push_back(file);
+                else
+                    gone.push_back(Manifest::keyFor(file, root));
+            }
+            for (auto&& file : removed)
+                gone.push_back(Manifest::keyFor(file, root));
+            return apply(present, gone, root, parse, jobs);
+        }
+
+        Counts counts() const {
+            std::shared_lock lock(mutex_);
+            Counts c{ files_.size(), 0, members_.size() };
+            for (auto&& [key, e] : files_)
+                c.types += e->types.size();
+            return c;
+        }
+
+        /// 按全名（Ns.Outer.Inner）或简单名查找类型，每项带上该类型的完整输出
+        std::string findType(std::string_view name, std::size_t& count) const {
+            std::shared_lock lock(mutex_);
+            std::vector<const TypeRef*> hits;
+            for (auto [it, end] = types_.equal_range(name); it != end; ++it)
+                hits.push_back(&it->second);
+            sortHits(hits);
+
+            std::string out = "[";
+            for (auto* h : hits) {
+                out += out.size() > 1 ? "," : "";
+                std::string text;
+                std::formatter<ClassInfo>::formatType(std::back_inserter(text), *h->rec->info, 0);
+                std::format_to(std::back_inserter(out), "{{\"name\":{},\"kind\":{},\"file\":{},\"text\":{}}}",
+                               detail::quoted(h->rec->fullName), detail::quoted(h->rec->info->self.type),
+                               detail::quoted(*h->file), detail::quoted(text));
+            }
+            count = hits.size();
+            return out + "]";
+        }
+
+        /// 按成员名查找（泛型方法不带类型参数），列出所在类型与签名
+        std::string findMember(std::string_view name, std::size_t& count) const {
+            std::shared_lock lock(mutex_);
+            std::vector<const MemberRef*> hits;
+            for (auto [it, end] = members_.equal_range(name); it != end; ++it)
+                hits.push_back(&it->second);
+            std::ranges::sort(hits, {}, [](const MemberRef* m) { return std::tie(m->owner->fullName, *m->file, m->kind, m->index); });
+
+            std::string out = "[";
+            for (auto* h : hits) {
+                out += out.size() > 1 ? "," : "";
+                auto&& [kind, v] = h->owner->info->members[h->kind];
+                std::string text = std::visit([&](auto&& vec) { return std::format("{}", vec[h->index]); }, v);
+                std::format_to(std::back_inserter(out), "{{\"type\":{},\"kind\":{},\"file\":{},\"text\":{}}}",
+                               detail::quoted(h->owner->fullName), detail::quoted(kind), detail::quoted(*h->file), detail::quoted(text));
+            }
+            count = hits.size();
+            return out + "]";
+        }
+
+        /// 命名空间列表（同 --namespaces）或根命名空间列表（同 --root-namespaces），覆盖全部文件
+        std::string listing(const nslist::Filter& filter, bool roots, std::size_t& count) const {
+            std::vector<nslist::TypeName> all;
+            {
+                std::shared_lock lock(mutex_);
+                for (auto&& [key, e] : files_)
+                    all.insert(all.end(), e->names.begin(), e->names.end());
+            }
+            auto text = roots ? nslist::rootListing(all, filter) : nslist::namespaceListing(all, filter);
+            std::string_view rest(text);
+            if (rest.starts_with("\xEF\xBB\xBF"))
+                rest.remove_prefix(3);
+
+            std::string out = "[";
+            count = 0;
+            for (auto line : rest | std::views::split('\n')) {
+                if (line.empty())
+                    continue;
+                out += count++ ? "," : "";
+                out += detail::quoted(std::string_view(line));
+            }
+            return out + "]";
+        }
+
+    private:
+        // 一个类型（含嵌套类型）的全名，指向所在文件的 ClassInfo
+        struct TypeRec {
+            const ClassInfo* info;
+            std::string fullName;
+        };
+
+        struct Entry {
+            FileStamp stamp;
+            ClassInfo info;
+            std::vector<TypeRec> types;             // 换入表中之后才填，指针指向本条目的 info
+            std::vector<nslist::TypeName> names;    // 顶层类型，供命名空间列表使用
+        };
+
+        struct TypeRef {
+            const std::string* file;
+            const TypeRec* rec;
+        };
+
+        struct MemberRef {
+            const std::string* file;
+            const TypeRec* owner;
+            std::uint32_t kind;
+            std::uint32_t index;
+        };
+
+        mutable std::shared_mutex mutex_;
+        std::unordered_map<std::string, std::unique_ptr<Entry>> files_;
+        // 键指向各条目中的字符串，条目去掉前先从表里摘掉
+        std::unordered_multimap<std::string_view, TypeRef> types_;
+        std::unordered_multimap<std::string_view, MemberRef> members_;
+
+        static void sortHits(std::vector<const TypeRef*>& hits) {
+            std::ranges::sort(hits, {}, [](const TypeRef* t) { return std::tie(t->rec->fullName, *t->file); });
+        }
+
+        static void collectTypes(Entry& e, const ClassInfo& c, std::string_view scope) {
+            auto name = symidx::keyName(c.self.name);
+            if (name.empty())
+                return;
+            auto full = scope.empty() ? std::string(name) : std::format("{}.{}", scope, name);
+            e.types.push_back({ &c, full });
+            for (auto&& n : c.nested)
+                collectTypes(e, n, full);
+        }
+
+        std::size_t apply(const std::vector<fs::path>& changed, const std::vector<std::string>& removed,
+                          const fs::path& root, const Parse& parse, unsigned jobs) {
+            if (changed.empty() && removed.empty())
+                return 0;
+
+            // 解析不持锁，查询照常进行
+            std::vector<std::unique_ptr<Entry>> parsed(changed.size());
+            std::vector<std::exception_ptr> errors(changed.size());
+            auto one = [&](std::size_t i) {
+                try {
+                    auto e = std::make_unique<Entry>();
+                    e->stamp = FileStamp::of(changed[i]);
+                    IOUtils::MappedFile mapped(changed[i]);
+                    e->info = parse(mapped.view());
+                    e->names = nslist::collectTypes(e->info);
+                    parsed[i] = std::move(e);
+                }
+                catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            };
+            if (jobs > 1 && changed.size() > 1) {
+                ThreadPool pool(jobs);
+                for (std::size_t i = 0; i < changed.size(); ++i)
+                    pool.submit([&, i] { one(i); });
+                pool.wait();
+            }
+            else {
+                for (std::size_t i = 0; i < changed.size(); ++i)
+                    one(i);
+            }
+
+            std::unique_lock lock(mutex_);
+            for (auto&& key : removed)
+                drop(key);
+            std::size_t n = removed.size();
+            for (std::size_t i = 0; i < changed.size(); ++i) {
+                auto key = Manifest::keyFor(changed[i], root);
+                if (errors[i]) {
+                    // 读不了的文件（如正被替换）保留旧结果，下次变化时再试
+                    try {
+                        std::rethrow_exception(errors[i]);
+                    }
+                    catch (const std::exception& ex) {
+                        LOG_WARN("解析 {} 失败：{}", key, ex.what());
+                    }
+                    continue;
+                }
+                drop(key);
+                auto [it, _] = files_.emplace(std::move(key), std::move(parsed[i]));
+                add(it->first, *it->second);
+                ++n;
+            }
+            return n;
+        }
+
+        void add(const std::string& key, Entry& e) {
+            std::string_view ns = e.info.namespaceName;
+            if (!e.info.self.name.empty()) {
+                collectTypes(e, e.info, ns);
+                for (auto&& other : e.info.others)
+                    collectTypes(e, other, ns);
+            }
+            for (auto&& rec : e.types) {
+                types_.emplace(rec.fullName, TypeRef{ &key, &rec });
+                auto simple = symidx::keyName(rec.info->self.name);
+                if (simple != rec.fullName)
+                    types_.emplace(simple, TypeRef{ &key, &rec });
+                for (std::uint32_t k = 0; k < rec.info->members.size(); ++k) {
+                    std::visit([&](auto&& v) {
+                        for (std::uint32_t i = 0; i < v.size(); ++i)
+                            members_.emplace(symidx::keyName(v[i].name), MemberRef{ &key, &rec, k, i });
+                    }, rec.info->members[k].second);
+                }
+            }
+        }
+
+        void drop(const std::string& key) {
+            auto it = files_.find(key);
+            if (it == files_.end())
+                return;
+            const std::string* file = &it->first;
+            auto unlink = [&](auto& table, std::string_view name) {
+                for (auto [i, end] = table.equal_range(name); i != end;)
+                    i = i->second.file == file ? table.erase(i) : std::next(i);
+            };
+            for (auto&& rec : it->second->types) {
+                unlink(types_, rec.fullName);
+                unlink(types_, symidx::keyName(rec.info->self.name));
+                for (auto&& [kind, v] : rec.info->members)
+                    std::visit([&](auto&& vec) {
+                        for (auto&& m : vec)
+                            unlink(members_, symidx::keyName(m.name));
+                    }, v);
+            }
+            files_.erase(it);
+        }
+    };
+
+    /// 处理一条请求，返回一行 JSON（不含换行）。reload 交给 onReload，返回有变化的文件数
+    inline std::string respond(const Store& store, std::string_view line, const std::function<std::size_t()>& onReload) {
+        using clock = std::chrono::steady_clock;
+        auto start = clock::now();
+        std::string body;
+        std::size_t count = 0;
+        try {
+            auto req = parseRequest(line);
+            if (req.op == "type" || req.op == "member") {
+                if (req.name.empty())
+                    throw std::runtime_error(std::format("{} 需要名字", req.op));
+                body = std::format("\"results\":{}", req.op == "type" ? store.findType(req.name, count) : store.findMember(req.name, count));
+            }
+            else if (req.op == "ns" || req.op == "roots") {
+                nslist::Filter filter;
+                if (!req.name.empty())
+                    filter.prefixes.push_back(req.name);
+                filter.depth = filter.rootDepth = req.depth;
+                body = std::format("\"results\":{}", store.listing(filter, req.op == "roots", count));
+            }
+            else if (req.op == "stats") {
+                auto c = store.counts();
+                body = std::format("\"files\":{},\"types\":{},\"members\":{}", c.files, c.types, c.members);
+            }
+            else if (req.op == "reload") {
+                count = onReload();
+                body = std::format("\"changed\":{}", count);
+            }
+            else
+                throw std::runtime_error(req.op.empty() ? "空请求" : std::format("未知请求：{}", req.op));
+        }
+        catch (const std::exception& e) {
+            return std::format("{{\"ok\":false,\"error\":{}}}", detail::quoted(e.what()));
+        }
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start).count();
+        return std::format("{{\"ok\":true,\"count\":{},{},\"us\":{}}}", count, body, us);
+    }
+
+#if defined(__linux__)
+    namespace detail {
+        inline sockaddr_un address(const fs::path& path) {
+            sockaddr_un addr{};
+            addr.sun_family = AF_UNIX;
+            auto s = path.string();
+            if (s.size() >= sizeof(addr.sun_path))
+                throw std::runtime_error(std::format("套接字路径过长（上限 {} 字节），请用 --socket 指定较短的路径：{}", sizeof(addr.sun_path) - 1, s));
+            std::memcpy(addr.sun_path, s.c_str(), s.size() + 1);
+            return addr;
+        }
+
+        inline int socketFd() {
+            int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (fd < 0)
+                throw std::system_error(errno, std::generic_category(), "socket");
+            return fd;
+        }
+    } // namespace detail
+#endif
+
+    /// 一条连接，按行收发
+    class Connection {
+    public:
+        explicit Connection(int fd = -1) noexcept : fd_(fd) {}
+        Connection(Connection&& o) noexcept : fd_(std::exchange(o.fd_, -1)), buf_(std::move(o.buf_)) {}
+        Connection& operator=(Connection&&) = delete;
+        ~Connection() {
+#if defined(__linux__)
+            if (fd_ >= 0)
+                ::close(fd_);
+#endif
+        }
+
+        /// 作为客户端连到 path
+        static Connection connect(const fs::path& path) {
+#if defined(__linux__)
+            auto addr = detail::address(path);
+            Connection c(detail::socketFd());
+            if (::connect(c.fd_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) < 0)
+                throw std::system_error(errno, std::generic_category(), std::format("无法连接 {}", path.string()));
+            return c;
+#else
+            (void)path;
+            throw std::runtime_error("serve/client 目前只支持 Linux");
+#endif
+        }
+
+        /// 读一行（不含换行），对方关闭时返回 false；单行超过 maxLine 字节抛异常
+        bool readLine(std::string& line, std::size_t maxLine = 1 << 16) {
+#if defined(__linux__)
+            while (true) {
+                if (auto nl = buf_.find('\n'); nl != std::string::npos) {
+                    line.assign(buf_, 0, nl);
+                    buf_.erase(0, nl + 1);
+                    return true;
+                }
+                if (buf_.size() > maxLine)
+                    throw std::runtime_error("请求过长");
+                char chunk[4096];
+                auto n = ::recv(fd_, chunk, sizeof(chunk), 0);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0) {
+                    if (buf_.empty())
+                        return false;
+                    line = std::exchange(buf_, {});     // 最后一行可以不带换行
+                    return true;
+                }
+                buf_.append(chunk, static_cast<std::size_t>(n));
+            }
+#else
+            (void)line, (void)maxLine;
+            return false;
+#endif
+        }
+
+        void writeLine(std::string_view s) {
+#if defined(__linux__)
+            std::string msg(s);
+            msg += '\n';
+            for (std::size_t off = 0; off < msg.size();) {
+                auto n = ::send(fd_, msg.data() + off, msg.size() - off, MSG_NOSIGNAL);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n < 0)
+                    throw std::system_error(errno, std::generic_category(), "send");
+                off += static_cast<std::size_t>(n);
+            }
+#else
+            (void)s;
+#endif
+        }
+
+    private:
+        int fd_;
+        std::string buf_;
+    };
+
+    /// 监听套接字。启动时删掉上次残留的套接字文件，析构时删除自己的
+    class Listener {
+    public:
+        explicit Listener(fs::path path) : path_(std::move(path)) {
+#if defined(__linux__)
+            auto addr = detail::address(path_);
+            struct stat st{};
+            if (::lstat(path_.c_str(), &st) == 0) {
+                if (!S_ISSOCK(st.st_mode))
+                    throw std::runtime_error(std::format("{} 已存在且不是套接字", path_.string()));
+                // 还有服务在监听时不抢占
+                bool alive = false;
+                try {
+                    Connection::connect(path_);
+                    alive = true;
+                }
+                catch (const std::system_error&) {}
+                if (alive)
+                    throw std::runtime_error(std::format("{} 上已有服务在运行", path_.string()));
+                ::unlink(path_.c_str());
+            }
+            fd_ = detail::socketFd();
+            if (::bind(fd_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(fd_, SOMAXCONN) < 0) {
+                auto err = errno;
+                ::close(fd_);
+                throw std::system_error(err, std::generic_category(), std::format("无法监听 {}", path_.string()));
+            }
+#else
+            throw std::runtime_error("serve 目前只支持 Linux");
+#endif
+        }
+
+        ~Listener() {
+#if defined(__linux__)
+            if (fd_ >= 0) {
+                ::close(fd_);
+                ::unlink(path_.c_str());
+            }
+#endif
+        }
+
+        Listener(const Listener&) = delete;
+        Listener& operator=(const Listener&) = delete;
+
+        const fs::path& path() const noexcept { return path_; }
+
+        /// 阻塞等待下一条连接
+        Connection accept() {
+#if defined(__linux__)
+            while (true) {
+                int fd = ::accept4(fd_, nullptr, nullptr, SOCK_CLOEXEC);
+                if (fd >= 0)
+                    return Connection(fd);
+                if (errno != EINTR && errno != ECONNABORTED)
+                    throw std::system_error(errno, std::generic_category(), "accept");
+            }
+#else
+            return Connection();
+#endif
+        }
+
+    private:
+        fs::path path_;
+        int fd_ = -1;
+    };
+
+    /// 每条连接一个线程，逐行请求、逐行回应，直到客户端断开。不会返回
+    [[noreturn]] inline void run(Listener& listener, const Store& store, const std::function<std::size_t()>& onReload) {
+        while (true) {
+            auto conn = listener.accept();
+            // 连接线程只引用常驻的 store，进程退出前一直有效
+            std::thread([&store, &onReload, c = std::move(conn)]() mutable {
+                try {
+                    std::string line;
+                    while (c.readLine(line))
+                        c.writeLine(respond(store, line, onReload));
+                }
+                catch (const std::exception& e) {
+                    LOG_WARN("连接中断：{}", e.what());
+                }
+            }).detach();
+        }
+    }
+
+} // namespace serve
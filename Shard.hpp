@@ -0,0 +1,142 @@
+#pragma once
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <format>
+#include <charconv>
+#include <cstdint>
+#include <stdexcept>
+
+#include "IOUtils.hpp"
+
+/// --shard i/N：把输入目录的文件按大小均衡地分成 N 份，各分片可以在不同机器上独立运行，
+/// 再由 merge 子命令把各分片的输出、清单、索引与类型目录合并成与单机运行相同的结果
+namespace shard {
+
+    namespace fs = std::filesystem;
+
+    /// 每个文件所属的分片。keys 为相对输入目录的路径，与 list_files 的返回顺序无关，各机器算出的结果相同。
+    /// 从大到小依次放进路径哈希指定的分片，放不下（超过平均字节数）时改放当前最轻的分片；
+    /// 文件增删只会挪动少数文件，各分片输出目录里的增量结果大多仍然可用
+    inline std::vector<unsigned> assign(const std::vector<std::string>& keys, const std::vector<std::uintmax_t>& sizes, unsigned count) {
+        std::vector<std::uint64_t> hashes(keys.size());
+        std::vector<std::size_t> order(keys.size());
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            hashes[i] = IOUtils::hash_bytes(keys[i]);
+            order[i] = i;
+        }
+        std::ranges::sort(order, [&](std::size_t a, std::size_t b) {
+            if (sizes[a] != sizes[b])
+                return sizes[a] > sizes[b];
+            if (hashes[a] != hashes[b])
+                return hashes[a] < hashes[b];
+            return keys[a] < keys[b];
+        });
+
+        const auto total = std::accumulate(sizes.begin(), sizes.end(), std::uintmax_t{ 0 });
+        const auto limit = (total + count - 1) / count;
+        std::vector<std::uintmax_t> load(count);
+        std::vector<unsigned> result(keys.size());
+        for (auto i : order) {
+            auto s = static_cast<unsigned>(hashes[i] % count);
+            if (load[s] + sizes[i] > limit)
+                s = static_cast<unsigned>(std::ranges::min_element(load) - load.begin());
+            load[s] += sizes[i];
+            result[i] = s;
+        }
+        return result;
+    }
+
+    /// 整个输入目录的文件列表（路径与大小）的哈希，merge 用它确认各分片看到的是同一份输入
+    inline std::uint64_t listingHash(const std::vector<std::string>& keys, const std::vector<std::uintmax_t>& sizes) {
+        std::vector<std::size_t> order(keys.size());
+        std::iota(order.begin(), order.end(), std::size_t{ 0 });
+        std::ranges::sort(order, {}, [&](std::size_t i) -> const std::string& { return keys[i]; });
+        std::string buf;
+        for (auto i : order)
+            std::format_to(std::back_inserter(buf), "{}\t{}\n", keys[i], sizes[i]);
+        return IOUtils::hash_bytes(buf);
+    }
+
+    /// 分片摘要：放在输出目录旁边（output -> output.shard），单行文本
+    struct Summary {
+        unsigned index = 0;
+        unsigned count = 0;
+        std::uint64_t config = 0;       // 工具版本、匹配规则与解析方式，不含输入目录
+        std::uint64_t stamp = 0;        // 本分片清单与类型目录的版本戳
+        std::size_t files = 0;          // 整个输入目录的文件数
+        std::uint64_t listing = 0;      // 整个输入目录的 listingHash
+        std::string mode;               // 解析方式，merge 据此算出合并后清单的版本戳
+
+        static fs::path pathFor(const fs::path& output) {
+            return IOUtils::sibling_path(output, ".shard");
+        }
+
+        void save(const fs::path& file) const {
+            IOUtils::write_file(file, std::format("AnalyzeCsClass shard {}/{} {:016x} {:016x} {} {:016x} {}\n",
+                                                  index, count, config, stamp, files, listing, mode));
+        }
+
+        static Summary load(const fs::path& file) {
+            std::ifstream in(file, std::ios::binary);
+            std::string line;
+            if (!in || !std::getline(in, line))
+                throw std::runtime_error(std::format("找不到分片摘要 {}，分片需要用 --shard 运行", file.string()));
+
+            constexpr std::string_view prefix = "AnalyzeCsClass shard ";
+            Summary s;
+            const char* p = line.data() + prefix.size();
+            const char* end = line.data() + line.size();
+            auto field = [&](auto& value, int base, char sep) {
+                auto [q, ec] = std::from_chars(p, end, value, base);
+                if (ec != std::errc{} || q == end || *q != sep)
+                    return false;
+                p = q + 1;
+                return true;
+            };
+            if (!line.starts_with(prefix) || !field(s.index, 10, '/') || !field(s.count, 10, ' ') || !field(s.config, 16, ' ')
+                || !field(s.stamp, 16, ' ') || !field(s.files, 10, ' ') || !field(s.listing, 16, ' ') || s.index >= s.count)
+                throw std::runtime_error(std::format("分片摘要已损坏：{}", file.string()));
+            s.mode.assign(p, end);
+            return s;
+        }
+    };
+
+    /// 确认各分片出自同一份输入、同样的配置，且编号 0..N-1 恰好各出现一次；parts 按编号重排
+    inline void verify(std::vector<Summary>& parts, std::vector<fs::path>& outputs, std::uint64_t config) {
+        const auto& first = parts.front();
+        for (std::size_t k = 0; k < parts.size(); ++k) {
+            const auto& s = parts[k];
+            if (s.config != config)
+                throw std::runtime_error(std::format("分片 {} 由不同版本的工具或不同的解析方式生成", outputs[k].string()));
+            if (s.count != first.count || s.mode != first.mode)
+                throw std::runtime_error(std::format("分片 {} 与 {} 的分片数或解析方式不同", outputs[k].string(), outputs[0].string()));
+            if (s.files != first.files || s.listing != first.listing)
+                throw std::runtime_error(std::format("分片 {} 与 {} 看到的输入文件不一致", outputs[k].string(), outputs[0].string()));
+        }
+
+        std::vector<std::size_t> order(parts.size());
+        std::iota(order.begin(), order.end(), std::size_t{ 0 });
+        std::ranges::sort(order, {}, [&](std::size_t k) { return parts[k].index; });
+        for (std::size_t k = 1; k < order.size(); ++k)
+            if (parts[order[k]].index == parts[order[k - 1]].index)
+                throw std::runtime_error(std::format("{} 与 {} 是同一个分片 {}/{}", outputs[order[k - 1]].string(),
+                                                     outputs[order[k]].string(), parts[order[k]].index, first.count));
+        if (parts.size() != first.count)
+            throw std::runtime_error(std::format("共 {} 个分片，只给出了 {} 个", first.count, parts.size()));
+
+        std::vector<Summary> sortedParts;
+        std::vector<fs::path> sortedOutputs;
+        for (auto k : order) {
+            sortedParts.push_back(std::move(parts[k]));
+            sortedOutputs.push_back(std::move(outputs[k]));
+        }
+        parts = std::move(sortedParts);
+        outputs = std::move(sortedOutputs);
+    }
+
+} // namespace shard
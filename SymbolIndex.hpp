@@ -0,0 +1,613 @@
+#pragma once
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <span>
+#include <variant>
+#include <unordered_map>
+#include <map>
+#include <algorithm>
+#include <ranges>
+#include <format>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "ClassInfo.hpp"
+#include "IOUtils.hpp"
+
+/// 二进制符号索引：字符串表 + 类型记录 + 成员记录 + 以全名/简单名为键的哈希表 + 按全名排序的数组，
+/// 文件直接 mmap 后按偏移访问，不做反序列化
+namespace symidx {
+
+    namespace fs = std::filesystem;
+
+    enum class SymbolKind : std::uint8_t {
+        Type,
+        Method,
+        Field,
+        Property,
+        Constant,
+        Event,
+    };
+
+    inline constexpr std::string_view kindName(SymbolKind k) noexcept {
+        constexpr std::string_view names[] = { "Type", "Method", "Field", "Property", "Constant", "Event" };
+        return names[static_cast<std::size_t>(k)];
+    }
+
+    // ---------- 解析结果的中间形式（自持字符串，可在工作线程里生成） ----------
+
+    struct MemberEntry {
+        SymbolKind kind{};
+        std::string modifier, type, name, parameters;
+    };
+
+    struct TypeEntry {
+        std::string fullName;          // Ns.Outer.Inner，不含泛型参数
+        std::string modifier, kind, name, super;
+        std::uint32_t parent = UINT32_MAX;     // 文件内的下标，顶层类型为 UINT32_MAX
+        std::vector<MemberEntry> members;
+    };
+
+    /// 符号引用：最高位为 1 表示成员，其余位为下标（文件内或索引内，视上下文而定）
+    inline constexpr std::uint32_t MemberBit = 0x80000000u;
+
+    struct FileSymbols {
+        std::string path;              // 相对输入目录的路径
+        std::vector<TypeEntry> types;  // 先序：外层类型总在其嵌套类型之前
+        /// 本文件的类型引用分片：(类型名, 文件内符号)，按类型名、符号排序去重；成员按在本文件中的出现次序编号
+        std::vector<std::pair<std::string, std::uint32_t>> uses;
+    };
+
+    /// 去掉泛型参数与首尾空白，作为查找用的名字：Build<X> -> Build
+    inline std::string_view keyName(std::string_view name) noexcept {
+        name = name.substr(0, name.find('<'));
+        while (!name.empty() && cs::detail::isSpace(name.back()))
+            name.remove_suffix(1);
+        return name;
+    }
+
+    /// 把连续空白压成一个空格，去掉首尾与左括号后的空白，跨行的声明变成单行
+    inline void squeeze(std::string& s) {
+        auto out = s.begin();
+        for (auto in = s.begin(); in != s.end(); ++in) {
+            if (!cs::detail::isSpace(*in))
+                *out++ = *in;
+            else if (out != s.begin() && out[-1] != ' ' && out[-1] != '(')
+                *out++ = ' ';
+        }
+        while (out != s.begin() && out[-1] == ' ')
+            --out;
+        s.erase(out, s.end());
+    }
+
+    namespace detail {
+        inline bool isKeyword(std::string_view w) noexcept {
+            // 内置类型与修饰符，按字典序排列供二分查找
+            static constexpr std::string_view words[] = {
+                "abstract", "async", "bool", "byte", "char", "class", "const", "decimal", "default", "delegate",
+                "double", "dynamic", "event", "explicit", "extern", "false", "fixed", "float", "global",
+                "implicit", "in", "int", "internal", "long", "new", "nint", "notnull", "nuint", "null",
+                "object", "operator", "out", "override", "params", "partial", "private", "protected", "public",
+                "readonly", "ref", "sbyte", "scoped", "sealed", "short", "static", "string", "struct", "this",
+                "true", "uint", "ulong", "unmanaged", "unsafe", "ushort", "var", "virtual", "void", "volatile",
+                "where",
+            };
+            static_assert(std::ranges::is_sorted(words));
+            return std::ranges::binary_search(words, w);
+        }
+    } // namespace detail
+
+    /// 依次报告一段类型文本（成员类型、参数表、基类列表）中引用的类型名：
+    /// 限定名只取最后一段，跳过关键字、参数/元组元素名、默认值以及 where 之后的类型参数
+    template <typename F>
+    void forEachTypeName(std::string_view text, F&& sink) {
+        using cs::detail::isSpace;
+        using cs::detail::isWord;
+        std::size_t i = 0;
+        auto skipSpace = [&](std::size_t p) {
+            while (p < text.size() && isSpace(text[p]))
+                ++p;
+            return p;
+        };
+
+        char prev = '\0';          // 上一个有意义的记号：'w' 表示单词，其余为标点本身
+        bool afterWhere = false;
+        while ((i = skipSpace(i)) < text.size()) {
+            char c = text[i];
+            if (c == '=') {         // 默认值一直跳到同层的 , 或 )
+                int depth = 0;
+                for (++i; i < text.size(); ++i) {
+                    char d = text[i];
+                    if (d == '(' || d == '<' || d == '[' || d == '{')
+                        ++depth;
+                    else if (d == ')' || d == '>' || d == ']' || d == '}') {
+                        if (depth-- == 0)
+                            break;
+                    }
+                    else if (d == ',' && depth == 0)
+                        break;
+                    else if (d == '"' || d == '\'') {
+                        for (++i; i < text.size() && text[i] != d; ++i)
+                            i += text[i] == '\\';
+                    }
+                }
+                prev = '=';
+                continue;
+            }
+            if (!isWord(c) || (c >= '0' && c <= '9')) {
+                prev = c;
+                ++i;
+                continue;
+            }
+
+            auto b = i;
+            while (i < text.size() && isWord(text[i]))
+                ++i;
+            auto word = text.substr(b, i - b);
+            auto n = skipSpace(i);
+            char next = n < text.size() ? text[n] : '\0';
+
+            bool qualifier = next == '.' || (next == ':' && n + 1 < text.size() && text[n + 1] == ':');
+            bool name = (prev == 'w' || prev == '>' || prev == ']' || prev == '?' || prev == '*' || prev == ')')
+                      && (next == ',' || next == ')' || next == '=' || next == '\0');
+            if (!qualifier && !name && !afterWhere && !detail::isKeyword(word))
+                sink(word);
+            afterWhere = word == "where";
+            prev = 'w';
+        }
+    }
+
+    template <typename Str>
+    void collectType(FileSymbols& out, const BasicClassInfo<Str>& info, std::string_view scope, std::uint32_t parent) {
+        TypeEntry t;
+        t.name = info.self.name;
+        t.fullName = scope.empty() ? std::string(keyName(t.name)) : std::format("{}.{}", scope, keyName(t.name));
+        t.modifier = info.self.modifier;
+        t.kind = info.self.type;
+        t.super = info.self.super;
+        t.parent = parent;
+
+        constexpr SymbolKind kinds[] = { SymbolKind::Method, SymbolKind::Field, SymbolKind::Property, SymbolKind::Constant, SymbolKind::Event };
+        for (std::size_t k = 0; k < info.members.size(); ++k) {
+            std::visit([&](auto&& v) {
+                for (auto&& m : v) {
+                    MemberEntry e{ kinds[k], std::string(m.modifier), std::string(m.type), std::string(m.name), {} };
+                    if constexpr (requires { m.parameters; })
+                        e.parameters = m.parameters;
+                    t.members.push_back(std::move(e));
+                }
+            }, info.members[k].second);
+        }
+
+        auto self = static_cast<std::uint32_t>(out.types.size());
+        std::string fullName = t.fullName;
+        out.types.push_back(std::move(t));
+        for (auto&& n : info.nested)
+            collectType(out, n, fullName, self);
+    }
+
+    /// 把一个文件的解析结果转成自持的符号记录
+    template <typename Str>
+    FileSymbols collectSymbols(std::string path, const BasicClassInfo<Str>& info) {
+        FileSymbols out{ std::move(path), {}, {} };
+        if (info.self.name.empty())
+            return out;
+        std::string_view ns = info.namespaceName;
+        collectType(out, info, ns, UINT32_MAX);
+        for (auto&& other : info.others)
+            collectType(out, other, ns, UINT32_MAX);
+
+        auto use = [&](std::uint32_t symbol) {
+            return [&out, symbol](std::string_view name) { out.uses.emplace_back(name, symbol); };
+        };
+        std::uint32_t member = 0;
+        for (std::uint32_t t = 0; t < out.types.size(); ++t) {
+            forEachTypeName(out.types[t].super, use(t));
+            for (auto&& m : out.types[t].members) {
+                forEachTypeName(m.type, use(member | MemberBit));
+                forEachTypeName(m.parameters, use(member | MemberBit));
+                ++member;
+            }
+        }
+        std::ranges::sort(out.uses);
+        auto dup = std::ranges::unique(out.uses);
+        out.uses.erase(dup.begin(), dup.end());
+        return out;
+    }
+
+    // ---------- 磁盘格式 ----------
+
+    namespace format {
+        inline constexpr char Magic[8] = { 'C', 'S', 'S', 'Y', 'M', 'I', 'D', 'X' };
+        inline constexpr std::uint32_t Version = 2;
+        inline constexpr std::uint32_t None = UINT32_MAX;
+
+        struct StrRef {
+            std::uint32_t off = 0;
+            std::uint32_t len = 0;
+        };
+
+        struct Header {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t fileCount;
+            std::uint32_t typeCount;
+            std::uint32_t memberCount;
+            std::uint32_t bucketCount;     // 2 的幂
+            std::uint32_t sortedCount;
+            std::uint32_t usageCount;
+            std::uint32_t postingCount;
+            std::uint64_t filesOff, typesOff, membersOff, bucketsOff, sortedOff, usagesOff, postingsOff, stringsOff, stringsLen;
+        };
+
+        struct TypeRec {
+            StrRef fullName, modifier, kind, name, super;
+            std::uint32_t file;
+            std::uint32_t parent;          // 外层类型下标，None 为顶层
+            std::uint32_t firstMember;     // 成员在成员表中连续存放
+            std::uint32_t memberCount;
+        };
+
+        struct MemberRec {
+            StrRef fullName, modifier, type, name, parameters;
+            std::uint32_t owner;           // 所属类型下标
+            SymbolKind kind;
+            std::uint8_t pad[3];
+        };
+
+        struct Bucket {
+            std::uint64_t hash;
+            std::uint32_t symbol;          // None 为空桶
+            std::uint32_t simple;          // 1 表示按简单名登记，0 为全名
+        };
+
+        /// 倒排表：按类型名排序，postings 中 [first, first + count) 为引用它的符号，按符号排序
+        struct UsageRec {
+            StrRef name;
+            std::uint32_t first;
+            std::uint32_t count;
+        };
+
+        static_assert(std::is_trivially_copyable_v<Header> && sizeof(Header) == 112);
+        static_assert(sizeof(TypeRec) == 56 && sizeof(MemberRec) == 48 && sizeof(Bucket) == 16 && sizeof(UsageRec) == 16);
+    } // namespace format
+
+    /// 汇总各文件的符号并写出索引文件；add 的顺序决定记录顺序
+    class IndexBuilder {
+    public:
+        void add(const FileSymbols& file) {
+            using namespace format;
+            auto fileIndex = static_cast<std::uint32_t>(files_.size());
+            files_.push_back(intern(file.path));
+
+            auto base = static_cast<std::uint32_t>(types_.size());
+            auto memberBase = static_cast<std::uint32_t>(members_.size());
+            for (auto&& t : file.types) {
+                TypeRec r{};
+                r.fullName = intern(t.fullName);
+                r.modifier = intern(t.modifier);
+                r.kind = intern(t.kind);
+                r.name = intern(t.name);
+                r.super = intern(t.super);
+                r.file = fileIndex;
+                r.parent = t.parent == UINT32_MAX ? None : base + t.parent;
+                r.firstMember = static_cast<std::uint32_t>(members_.size());
+                r.memberCount = static_cast<std::uint32_t>(t.members.size());
+                auto owner = static_cast<std::uint32_t>(types_.size());
+                types_.push_back(r);
+
+                for (auto&& m : t.members) {
+                    MemberRec mr{};
+                    mr.fullName = intern(std::format("{}.{}", t.fullName, keyName(m.name)));
+                    mr.modifier = intern(m.modifier);
+                    mr.type = intern(m.type);
+                    mr.name = intern(m.name);
+                    mr.parameters = intern(m.parameters);
+                    mr.owner = owner;
+                    mr.kind = m.kind;
+                    members_.push_back(mr);
+                }
+            }
+
+            // 合并本文件的引用分片，文件内下标换算为全局下标
+            for (auto&& [name, local] : file.uses) {
+                auto symbol = local & MemberBit ? (memberBase + (local & ~MemberBit)) | MemberBit : base + local;
+                auto it = uses_.find(name);
+                if (it == uses_.end())
+                    it = uses_.emplace(name, std::vector<std::uint32_t>{}).first;
+                it->second.push_back(symbol);
+            }
+        }
+
+        std::size_t typeCount() const noexcept { return types_.size(); }
+        std::size_t memberCount() const noexcept { return members_.size(); }
+        std::size_t usageCount() const noexcept { return uses_.size(); }
+
+        void write(const fs::path& path) {
+            using namespace format;
+            std::vector<std::uint32_t> sorted;
+            sorted.reserve(types_.size() + members_.size());
+            for (std::uint32_t i = 0; i < types_.size(); ++i)
+                sorted.push_back(i);
+            for (std::uint32_t i = 0; i < members_.size(); ++i)
+                sorted.push_back(i | MemberBit);
+            std::ranges::stable_sort(sorted, {}, [&](std::uint32_t s) { return view(fullNameOf(s)); });
+
+            // 每个符号按全名登记一次，简单名与全名不同时再按简单名登记一次
+            std::uint32_t entries = 0;
+            for (auto s : sorted)
+                entries += simpleKey(s) != view(fullNameOf(s)) ? 2 : 1;
+            std::uint32_t bucketCount = 16;
+            while (bucketCount < entries * 2)
+                bucketCount <<= 1;
+            std::vector<Bucket> buckets(bucketCount, Bucket{ 0, None, 0 });
+            auto insert = [&](std::string_view key, std::uint32_t symbol, std::uint32_t simple) {
+                auto h = IOUtils::hash_bytes(key);
+                for (auto i = static_cast<std::uint32_t>(h) & (bucketCount - 1);; i = (i + 1) & (bucketCount - 1)) {
+                    if (buckets[i].symbol == None) {
+                        buckets[i] = { h, symbol, simple };
+                        return;
+                    }
+                }
+            };
+            for (auto s : sorted) {
+                insert(view(fullNameOf(s)), s, 0);
+                if (simpleKey(s) != view(fullNameOf(s)))
+                    insert(simpleKey(s), s, 1);
+            }
+
+            Header h{};
+            std::memcpy(h.magic, Magic, sizeof(Magic));
+            h.version = Version;
+            h.fileCount = static_cast<std::uint32_t>(files_.size());
+            h.typeCount = static_cast<std::uint32_t>(types_.size());
+            h.memberCount = static_cast<std::uint32_t>(members_.size());
+            h.bucketCount = bucketCount;
+            h.sortedCount = static_cast<std::uint32_t>(sorted.size());
+
+            std::vector<UsageRec> usages;
+            std::vector<std::uint32_t> postings;
+            usages.reserve(uses_.size());
+            for (auto&& [name, symbols] : uses_) {
+                std::ranges::sort(symbols);
+                usages.push_back({ intern(name), static_cast<std::uint32_t>(postings.size()), static_cast<std::uint32_t>(symbols.size()) });
+                postings.insert(postings.end(), symbols.begin(), symbols.end());
+            }
+            h.usageCount = static_cast<std::uint32_t>(usages.size());
+            h.postingCount = static_cast<std::uint32_t>(postings.size());
+
+            std::string out(sizeof(Header), '\0');
+            auto section = [&](const auto& vec) {
+                out.resize((out.size() + 7) & ~std::size_t{ 7 }, '\0');    // 各段按 8 字节对齐
+                auto off = out.size();
+                out.append(reinterpret_cast<const char*>(vec.data()), vec.size() * sizeof(vec[0]));
+                return static_cast<std::uint64_t>(off);
+            };
+            h.filesOff = section(files_);
+            h.typesOff = section(types_);
+            h.membersOff = section(members_);
+            h.bucketsOff = section(buckets);
+            h.sortedOff = section(sorted);
+            h.usagesOff = section(usages);
+            h.postingsOff = section(postings);
+            h.stringsOff = section(strings_);
+            h.stringsLen = strings_.size();
+            std::memcpy(out.data(), &h, sizeof(h));
+
+            // 先写临时文件再替换，正在映射旧索引的查询不受影响
+            IOUtils::write_file(path, out);
+        }
+
+    private:
+        std::string strings_;
+        std::unordered_map<std::string, format::StrRef> pool_;
+        std::vector<format::StrRef> files_;
+        std::vector<format::TypeRec> types_;
+        std::vector<format::MemberRec> members_;
+        std::map<std::string, std::vector<std::uint32_t>, std::less<>> uses_;   // 类型名 -> 引用它的全局符号
+
+        format::StrRef intern(std::string_view s) {
+            auto [it, inserted] = pool_.try_emplace(std::string(s));
+            if (inserted) {
+                it->second = { static_cast<std::uint32_t>(strings_.size()), static_cast<std::uint32_t>(s.size()) };
+                strings_ += s;
+            }
+            return it->second;
+        }
+
+        std::string_view view(format::StrRef r) const noexcept { return std::string_view(strings_).substr(r.off, r.len); }
+
+        format::StrRef fullNameOf(std::uint32_t s) const noexcept {
+            return s & MemberBit ? members_[s & ~MemberBit].fullName : types_[s].fullName;
+        }
+
+        std::string_view simpleKey(std::uint32_t s) const noexcept {
+            return keyName(view(s & MemberBit ? members_[s & ~MemberBit].name : types_[s].name));
+        }
+    };
+
+    /// 索引放在输出目录旁边，例如 output -> output.idx
+    inline fs::path indexPathFor(const fs::path& outputDir) {
+        return IOUtils::sibling_path(outputDir, ".idx");
+    }
+
+    /// 只读打开索引文件，所有访问都直接落在映射内存上
+    class SymbolIndex {
+    public:
+        using TypeRec = format::TypeRec;
+        using MemberRec = format::MemberRec;
+
+        explicit SymbolIndex(const fs::path& path) : file_(path) {
+            auto data = file_.view();
+            if (data.size() < sizeof(format::Header))
+                throw std::runtime_error(std::format("索引文件过小：{}", path.string()));
+            header_ = reinterpret_cast<const format::Header*>(data.data());
+            if (std::memcmp(header_->magic, format::Magic, sizeof(format::Magic)) != 0 || header_->version != format::Version)
+                throw std::runtime_error(std::format("不是可识别的索引文件：{}", path.string()));
+            if (header_->stringsOff + header_->stringsLen > data.size())
+                throw std::runtime_error(std::format("索引文件已损坏：{}", path.string()));
+        }
+
+        std::size_t fileCount() const noexcept { return header_->fileCount; }
+        std::size_t typeCount() const noexcept { return header_->typeCount; }
+        std::size_t memberCount() const noexcept { return header_->memberCount; }
+
+        const TypeRec& type(std::uint32_t i) const noexcept { return at<TypeRec>(header_->typesOff)[i]; }
+        const MemberRec& member(std::uint32_t i) const noexcept { return at<MemberRec>(header_->membersOff)[i]; }
+        std::string_view file(std::uint32_t i) const noexcept { return str(at<format::StrRef>(header_->filesOff)[i]); }
+
+        std::string_view str(format::StrRef r) const noexcept {
+            return std::string_view(file_.view().data() + header_->stringsOff + r.off, r.len);
+        }
+
+        static bool isMember(std::uint32_t symbol) noexcept { return symbol & MemberBit; }
+        static std::uint32_t indexOf(std::uint32_t symbol) noexcept { return symbol & ~MemberBit; }
+
+        std::string_view fullName(std::uint32_t symbol) const noexcept {
+            return str(isMember(symbol) ? member(indexOf(symbol)).fullName : type(symbol).fullName);
+        }
+
+        /// 按全名或简单名精确查找（不含泛型参数），结果按全名排序
+        std::vector<std::uint32_t> find(std::string_view key) const {
+            std::vector<std::uint32_t> result;
+            const auto* buckets = at<format::Bucket>(header_->bucketsOff);
+            const auto mask = header_->bucketCount - 1;
+            auto h = IOUtils::hash_bytes(key);
+            for (auto i = static_cast<std::uint32_t>(h) & mask; buckets[i].symbol != format::None; i = (i + 1) & mask) {
+                const auto& b = buckets[i];
+                if (b.hash != h)
+                    continue;
+                auto name = b.simple ? keyName(str(isMember(b.symbol) ? member(indexOf(b.symbol)).name : type(b.symbol).name))
+                                     : fullName(b.symbol);
+                if (name == key)
+                    result.push_back(b.symbol);
+            }
+            std::ranges::sort(result, {}, [&](std::uint32_t s) { return fullName(s); });
+            return result;
+        }
+
+        /// 全名以 prefix 开头的符号，按全名排序
+        std::span<const std::uint32_t> prefix(std::string_view prefix) const {
+            std::span<const std::uint32_t> sorted(at<std::uint32_t>(header_->sortedOff), header_->sortedCount);
+            auto first = std::ranges::lower_bound(sorted, prefix, {}, [&](std::uint32_t s) { return fullName(s); });
+            auto last = std::find_if(first, sorted.end(), [&](std::uint32_t s) { return !fullName(s).starts_with(prefix); });
+            return { first, last };
+        }
+
+        /// 引用了类型名 name 的符号（成员类型、参数、基类列表中出现，含泛型参数），按符号排序
+        std::span<const std::uint32_t> uses(std::string_view name) const {
+            auto all = allUsages();
+            auto it = std::ranges::lower_bound(all, name, {}, [&](const format::UsageRec& u) { return str(u.name); });
+            if (it == all.end() || str(it->name) != name)
+                return {};
+            return postings(*it);
+        }
+
+        /// 类型名以 prefix 开头的倒排项，按类型名排序；传空串得到全部
+        std::span<const format::UsageRec> usages(std::string_view prefix) const {
+            auto all = allUsages();
+            auto first = std::ranges::lower_bound(all, prefix, {}, [&](const format::UsageRec& u) { return str(u.name); });
+            auto last = std::find_if(first, all.end(), [&](const format::UsageRec& u) { return !str(u.name).starts_with(prefix); });
+            return { first, last };
+        }
+
+        std::span<const std::uint32_t> postings(const format::UsageRec& u) const noexcept {
+            return { at<std::uint32_t>(header_->postingsOff) + u.first, u.count };
+        }
+
+        /// 类型的成员，在成员表中连续存放
+        std::span<const MemberRec> members(std::uint32_t typeIndex) const noexcept {
+            const auto& t = type(typeIndex);
+            return { at<MemberRec>(header_->membersOff) + t.firstMember, t.memberCount };
+        }
+
+        /// 单行形式的声明，跨行的参数表等连续空白压成一个空格
+        std::string describe(std::uint32_t symbol) const {
+            std::string s;
+            if (!isMember(symbol)) {
+                const auto& t = type(symbol);
+                s = std::format("{}{} {}{}", str(t.modifier), str(t.kind), str(t.name), str(t.super));
+            }
+            else {
+                const auto& m = member(indexOf(symbol));
+                s = std::format("{}{} {}", str(m.modifier), str(m.type), str(m.name));
+                if (m.kind == SymbolKind::Method)
+                    s += std::format("({})", str(m.parameters));
+            }
+            squeeze(s);
+            return s;
+        }
+
+        /// 符号所在的源文件
+        std::string_view fileOf(std::uint32_t symbol) const noexcept {
+            return file(type(isMember(symbol) ? member(indexOf(symbol)).owner : symbol).file);
+        }
+
+        SymbolKind kindOf(std::uint32_t symbol) const noexcept {
+            return isMember(symbol) ? member(indexOf(symbol)).kind : SymbolKind::Type;
+        }
+
+    private:
+        IOUtils::MappedFile file_;
+        const format::Header* header_ = nullptr;
+
+        std::span<const format::UsageRec> allUsages() const noexcept {
+            return { at<format::UsageRec>(header_->usagesOff), header_->usageCount };
+        }
+
+        template <typename T>
+        const T* at(std::uint64_t off) const noexcept {
+            return reinterpret_cast<const T*>(file_.view().data() + off);
+        }
+    };
+
+    /// 把索引还原成逐文件的符号记录，与写入时交给 IndexBuilder::add 的内容相同；
+    /// 合并分片时按路径顺序重新 add，得到的索引与一次汇总全部文件逐字节相同
+    inline std::vector<FileSymbols> readSymbols(const SymbolIndex& index) {
+        std::vector<FileSymbols> out(index.fileCount());
+        for (std::uint32_t f = 0; f < out.size(); ++f)
+            out[f].path = index.file(f);
+
+        // 同一文件的类型、成员在表中连续存放，减去文件的第一个即为文件内下标
+        std::vector<std::uint32_t> typeBase(out.size(), format::None);
+        for (std::uint32_t t = 0; t < index.typeCount(); ++t) {
+            const auto& r = index.type(t);
+            if (typeBase[r.file] == format::None)
+                typeBase[r.file] = t;
+            TypeEntry e;
+            e.fullName = index.str(r.fullName);
+            e.modifier = index.str(r.modifier);
+            e.kind = index.str(r.kind);
+            e.name = index.str(r.name);
+            e.super = index.str(r.super);
+            e.parent = r.parent == format::None ? UINT32_MAX : r.parent - typeBase[r.file];
+            for (auto&& m : index.members(t))
+                e.members.push_back({ m.kind, std::string(index.str(m.modifier)), std::string(index.str(m.type)),
+                                      std::string(index.str(m.name)), std::string(index.str(m.parameters)) });
+            out[r.file].types.push_back(std::move(e));
+        }
+
+        for (auto&& u : index.usages("")) {
+            auto name = index.str(u.name);
+            for (auto s : index.postings(u)) {
+                if (SymbolIndex::isMember(s)) {
+                    auto m = SymbolIndex::indexOf(s);
+                    auto file = index.type(index.member(m).owner).file;
+                    out[file].uses.emplace_back(name, (m - index.type(typeBase[file]).firstMember) | MemberBit);
+                }
+                else {
+                    auto file = index.type(s).file;
+                    out[file].uses.emplace_back(name, s - typeBase[file]);
+                }
+            }
+        }
+        for (auto&& f : out)
+            std::ranges::sort(f.uses);
+        return out;
+    }
+
+} // namespace symidx
@@ -0,0 +1,126 @@
+#pragma once
+#include <thread>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+/// 工作窃取线程池：每个工作线程从自己的队头取任务，空闲时从其他线程的队尾窃取
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency()) {
+        threads = std::max(threads, 1u);
+        for (unsigned i = 0; i < threads; ++i)
+            queues_.push_back(std::make_unique<Queue>());
+        for (unsigned i = 0; i < threads; ++i)
+            workers_.emplace_back([this, i] { run(i); });
+    }
+
+    ~ThreadPool() {
+        wait();
+        {
+            std::lock_guard lock(sleepMutex_);
+            stopping_ = true;
+        }
+        wakeCv_.notify_all();
+        workers_.clear();   // 先汇合线程，再析构它们用到的同步对象
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const noexcept { return static_cast<unsigned>(queues_.size()); }
+
+    /// 按轮转顺序投递到各线程队列，先投递的任务在各自队列中先执行
+    void submit(Task task) {
+        auto idx = next_.fetch_add(1, std::memory_order_relaxed) % size();
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard lock(queues_[idx]->mutex);
+            queues_[idx]->tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard lock(sleepMutex_);
+            ++signal_;
+        }
+        wakeCv_.notify_one();
+    }
+
+    /// 阻塞直到所有已投递任务执行完毕
+    void wait() {
+        std::unique_lock lock(sleepMutex_);
+        doneCv_.wait(lock, [this] { return pending_.load(std::memory_order_acquire) == 0; });
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::jthread> workers_;
+    std::atomic<std::size_t> pending_{ 0 };
+    std::atomic<unsigned> next_{ 0 };
+
+    std::mutex sleepMutex_;
+    std::condition_variable wakeCv_;
+    std::condition_variable doneCv_;
+    std::size_t signal_ = 0;       // 每次投递自增，避免错过唤醒
+    bool stopping_ = false;
+
+    bool popLocal(unsigned self, Task& out) {
+        auto& q = *queues_[self];
+        std::lock_guard lock(q.mutex);
+        if (q.tasks.empty())
+            return false;
+        out = std::move(q.tasks.front());
+        q.tasks.pop_front();
+        return true;
+    }
+
+    bool steal(unsigned self, Task& out) {
+        for (unsigned k = 1; k < size(); ++k) {
+            auto& q = *queues_[(self + k) % size()];
+            std::lock_guard lock(q.mutex);
+            if (q.tasks.empty())
+                continue;
+            out = std::move(q.tasks.back());
+            q.tasks.pop_back();
+            return true;
+        }
+        return false;
+    }
+
+    void run(unsigned self) {
+        while (true) {
+            std::size_t seen;
+            {
+                std::lock_guard lock(sleepMutex_);
+                seen = signal_;
+            }
+
+            Task task;
+            if (popLocal(self, task) || steal(self, task)) {
+                try { task(); }
+                catch (...) {}  // 投递方负责记录异常，这里只保证计数正确
+                if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    std::lock_guard lock(sleepMutex_);
+                    doneCv_.notify_all();
+                }
+                continue;
+            }
+
+            std::unique_lock lock(sleepMutex_);
+            wakeCv_.wait(lock, [&] { return stopping_ || signal_ != seen; });
+            if (stopping_)
+                return;
+        }
+    }
+};
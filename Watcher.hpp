@@ -0,0 +1,184 @@
+#pragma once
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <chrono>
+#include <format>
+#include <stdexcept>
+#include <algorithm>
+#include <ranges>
+#include <system_error>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+/// 递归监视目录下指定后缀的文件，同一文件在 debounce 时间内没有新事件才报告，避免读到写了一半的文件
+/// 目前只有 Linux (inotify) 实现，其他平台构造时抛异常
+class DirWatcher {
+public:
+    using clock = std::chrono::steady_clock;
+
+    struct Change {
+        std::filesystem::path path;
+        bool removed = false;       // 文件被删除或移出监视目录
+    };
+
+    struct Batch {
+        std::vector<Change> changes;
+        bool rescan = false;        // 事件队列溢出或整个目录被移走，调用方应整体重新比对一次
+    };
+
+    DirWatcher(const std::filesystem::path& root, std::string extension, std::chrono::milliseconds debounce)
+        : extension_(std::move(extension)), debounce_(debounce) {
+#if defined(__linux__)
+        fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd_ < 0)
+            throw std::system_error(errno, std::generic_category(), "inotify_init1");
+        if (!addTree(root, false))
+            throw std::system_error(errno, std::generic_category(), std::format("无法监视目录：{}", root.string()));
+#else
+        (void)root;
+        throw std::runtime_error("--watch 目前只支持 Linux");
+#endif
+    }
+
+    ~DirWatcher() {
+#if defined(__linux__)
+        if (fd_ >= 0)
+            ::close(fd_);
+#endif
+    }
+
+    DirWatcher(const DirWatcher&) = delete;
+    DirWatcher& operator=(const DirWatcher&) = delete;
+
+    /// 阻塞直到至少有一个文件安静了 debounce 时间（或需要重新比对），同一批内按路径排序
+    Batch wait() {
+        Batch batch;
+#if defined(__linux__)
+        while (true) {
+            auto now = clock::now();
+            for (auto it = pending_.begin(); it != pending_.end();) {
+                if (now - it->second.last >= debounce_) {
+                    batch.changes.push_back({ it->first, it->second.removed });
+                    it = pending_.erase(it);
+                }
+                else
+                    ++it;
+            }
+            if (!batch.changes.empty() || batch.rescan)
+                return batch;
+
+            int timeout = -1;
+            if (!pending_.empty()) {
+                auto next = std::ranges::min(pending_ | std::views::values, {}, &Pending::last).last + debounce_;
+                timeout = static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(next - now).count());
+            }
+            pollfd pfd{ fd_, POLLIN, 0 };
+            if (::poll(&pfd, 1, timeout) < 0 && errno != EINTR)
+                throw std::system_error(errno, std::generic_category(), "poll");
+            if (pfd.revents & POLLIN)
+                batch.rescan |= drain();
+        }
+#endif
+        return batch;
+    }
+
+private:
+    struct Pending {
+        clock::time_point last;
+        bool removed = false;
+    };
+
+    std::string extension_;
+    std::chrono::milliseconds debounce_;
+    std::map<std::filesystem::path, Pending> pending_;
+#if defined(__linux__)
+    int fd_ = -1;
+    std::unordered_map<int, std::filesystem::path> dirs_;   // watch 描述符 -> 目录
+
+    void touch(const std::filesystem::path& path, bool removed) {
+        if (path.extension() == extension_)
+            pending_[path] = { clock::now(), removed };
+    }
+
+    // 新出现的目录里可能已经有文件写完了（监视加上之前），一并登记；目录已消失时返回 false
+    bool addTree(const std::filesystem::path& dir, bool reportExisting) {
+        constexpr std::uint32_t mask = IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_MOVED_TO
+                                     | IN_MOVED_FROM | IN_DELETE | IN_ONLYDIR;
+        int wd = inotify_add_watch(fd_, dir.c_str(), mask);
+        if (wd < 0)
+            return false;
+        dirs_[wd] = dir;
+
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+            if (entry.is_directory(ec))
+                addTree(entry.path(), reportExisting);
+            else if (reportExisting && entry.is_regular_file(ec))
+                touch(entry.path(), false);
+        }
+        return true;
+    }
+
+    // 移出监视目录的子树 inode 仍然有效，要主动摘掉它们的 watch，否则之后的事件会报到旧路径上
+    void removeTree(const std::filesystem::path& dir) {
+        std::erase_if(dirs_, [&](const auto& kv) {
+            auto [a, b] = std::ranges::mismatch(dir, kv.second);
+            if (a != dir.end())
+                return false;
+            inotify_rm_watch(fd_, kv.first);
+            return true;
+        });
+    }
+
+    // 读空事件队列，返回是否需要整体重新比对
+    bool drain() {
+        alignas(inotify_event) char buf[64 * 1024];
+        bool overflow = false;
+        while (true) {
+            auto len = ::read(fd_, buf, sizeof(buf));
+            if (len <= 0) {
+                if (len < 0 && errno != EAGAIN && errno != EINTR)
+                    throw std::system_error(errno, std::generic_category(), "read inotify");
+                return overflow;
+            }
+            for (char* p = buf; p < buf + len;) {
+                auto* ev = reinterpret_cast<inotify_event*>(p);
+                p += sizeof(inotify_event) + ev->len;
+
+                if (ev->mask & IN_Q_OVERFLOW) {
+                    overflow = true;
+                    continue;
+                }
+                if (ev->mask & IN_IGNORED) {
+                    dirs_.erase(ev->wd);
+                    continue;
+                }
+                auto it = dirs_.find(ev->wd);
+                if (it == dirs_.end() || ev->len == 0)
+                    continue;
+
+                auto path = it->second / ev->name;
+                if (ev->mask & IN_ISDIR) {
+                    if (ev->mask & (IN_CREATE | IN_MOVED_TO))
+                        addTree(path, true);
+                    else if (ev->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                        removeTree(path);
+                        overflow = true;    // 整个目录没了，逐个文件的事件不一定齐全，交给重新比对
+                    }
+                    continue;
+                }
+                touch(path, (ev->mask & (IN_DELETE | IN_MOVED_FROM)) != 0);
+            }
+        }
+    }
+#endif
+};
@@ -1,12 +1,208 @@
 #pragma once
 #include <chrono>
+#include <string>
 #include <string_view>
 #include <source_location>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <format>
+#include <iterator>
+#include <cstdint>
 #include "Logger.hpp"
+#include "IOUtils.hpp"
 
 namespace bench {
 
     using namespace std::literals;
+
+    /// 分层性能统计：各线程把作用域的起止记到自己的缓冲区（按调用栈记录父作用域），
+    /// 结束时按"路径"汇总 次数/总计/最小/最大/p50/p99，也可导出 Chrome trace_event JSON 供 Perfetto 查看。
+    /// 未启用时各作用域只做一次原子读
+    class Profiler {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        static Profiler& instance() {
+            static Profiler p;
+            return p;
+        }
+
+        static bool enabled() noexcept { return instance().enabled_.load(std::memory_order_relaxed); }
+        void enable(bool on = true) noexcept { enabled_.store(on, std::memory_order_relaxed); }
+
+        /// 开始一个作用域，返回交给 end() 的句柄
+        std::uint32_t begin(std::string name, std::string detail = {}) {
+            auto& t = local();
+            std::lock_guard lock(t.mutex);
+            auto id = static_cast<std::uint32_t>(t.records.size());
+            t.records.push_back({ std::move(name), std::move(detail), clock::now() - epoch_, {},
+                                  t.stack.empty() ? NoParent : t.stack.back() });
+            t.stack.push_back(id);
+            return id;
+        }
+
+        void end(std::uint32_t id) {
+            auto& t = local();
+            std::lock_guard lock(t.mutex);
+            t.records[id].duration = clock::now() - epoch_ - t.records[id].start;
+            t.stack.pop_back();
+        }
+
+        /// 计数器，按名字跨线程累加；name 须指向静态存储
+        void count(std::string_view name, std::uint64_t n) {
+            auto& t = local();
+            std::lock_guard lock(t.mutex);
+            t.counters[name] += n;
+        }
+
+        /// 汇总表：作用域按调用路径缩进，时间单位 ms；应在工作线程都结束后调用
+        std::string summary() const {
+            struct Row {
+                std::vector<std::int64_t> ns;
+                std::size_t depth = 0;
+                std::string_view name;
+            };
+            std::map<std::string, Row> rows;       // 键为以 \x1f 连接的路径，父路径排在子路径之前
+            std::map<std::string_view, std::uint64_t> counters;
+            forEachThread([&](const ThreadData& t) {
+                std::vector<std::string> paths(t.records.size());
+                std::vector<std::size_t> depths(t.records.size());
+                for (std::size_t i = 0; i < t.records.size(); ++i) {
+                    const auto& r = t.records[i];
+                    paths[i] = r.parent == NoParent ? r.name : paths[r.parent] + '\x1f' + r.name;
+                    depths[i] = r.parent == NoParent ? 0 : depths[r.parent] + 1;
+                    auto& row = rows[paths[i]];
+                    row.ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(r.duration).count());
+                    row.depth = depths[i];
+                    row.name = r.name;
+                }
+                for (auto&& [name, n] : t.counters)
+                    counters[name] += n;
+            });
+
+            std::string out = std::format("{:<40}{:>8}{:>12}{:>10}{:>10}{:>10}{:>10}\n",
+                                          "作用域", "次数", "总计(ms)", "最小", "最大", "p50", "p99");
+            for (auto&& [path, row] : rows) {
+                auto v = row.ns;
+                std::ranges::sort(v);
+                auto total = 0.0;
+                for (auto x : v)
+                    total += x;
+                auto ms = [](double ns) { return ns / 1e6; };
+                auto pct = [&](double p) { return v[static_cast<std::size_t>(p * static_cast<double>(v.size() - 1) + 0.5)]; };
+                std::format_to(std::back_inserter(out), "{:<40}{:>8}{:>12.3f}{:>10.3f}{:>10.3f}{:>10.3f}{:>10.3f}\n",
+                               std::string(row.depth * 2, ' ') + std::string(row.name), v.size(), ms(total),
+                               ms(static_cast<double>(v.front())), ms(static_cast<double>(v.back())),
+                               ms(static_cast<double>(pct(0.5))), ms(static_cast<double>(pct(0.99))));
+            }
+            if (!counters.empty()) {
+                out += std::format("{:<40}{:>8}\n", "计数", "总数");
+                for (auto&& [name, n] : counters)
+                    std::format_to(std::back_inserter(out), "{:<40}{:>8}\n", name, n);
+            }
+            return out;
+        }
+
+        /// Chrome trace_event 格式（"X" 完整事件，时间单位 μs）
+        std::string chromeTrace() const {
+            std::string out = "{\"traceEvents\":[\n";
+            bool first = true;
+            forEachThread([&](const ThreadData& t) {
+                std::format_to(std::back_inserter(out), "{}{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"线程 {}\"}}}}",
+                               first ? "" : ",\n", t.tid, t.tid);
+                first = false;
+                for (auto&& r : t.records) {
+                    using us = std::chrono::duration<double, std::micro>;
+                    std::format_to(std::back_inserter(out), ",\n{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}",
+                                   escape(r.name), t.tid, us(r.start).count(), us(r.duration).count());
+                    if (!r.detail.empty())
+                        std::format_to(std::back_inserter(out), ",\"args\":{{\"detail\":\"{}\"}}", escape(r.detail));
+                    out += '}';
+                }
+            });
+            out += "\n]}\n";
+            return IOUtils::to_utf8(out);     // 作用域名是中文字面量，Perfetto 只认 UTF-8
+        }
+
+    private:
+        static constexpr std::uint32_t NoParent = UINT32_MAX;
+
+        struct Record {
+            std::string name, detail;
+            clock::duration start, duration;
+            std::uint32_t parent;
+        };
+
+        // 线程退出后数据仍由注册表持有，线程池销毁后照样能汇总
+        struct ThreadData {
+            std::mutex mutex;
+            std::uint32_t tid = 0;
+            std::vector<Record> records;
+            std::vector<std::uint32_t> stack;      // 未结束的作用域
+            std::map<std::string_view, std::uint64_t> counters;
+        };
+
+        std::atomic<bool> enabled_{ false };
+        clock::time_point epoch_ = clock::now();
+        mutable std::mutex mutex_;
+        std::vector<std::shared_ptr<ThreadData>> threads_;
+
+        ThreadData& local() {
+            thread_local std::shared_ptr<ThreadData> data = [this] {
+                auto d = std::make_shared<ThreadData>();
+                std::lock_guard lock(mutex_);
+                d->tid = static_cast<std::uint32_t>(threads_.size() + 1);
+                threads_.push_back(d);
+                return d;
+            }();
+            return *data;
+        }
+
+        template <typename F>
+        void forEachThread(F&& f) const {
+            std::lock_guard lock(mutex_);
+            for (auto&& t : threads_) {
+                std::lock_guard tl(t->mutex);
+                f(*t);
+            }
+        }
+
+        static std::string escape(std::string_view s) {
+            std::string out;
+            for (char c : s) {
+                if (c == '"' || c == '\\')
+                    out += '\\';
+                if (static_cast<unsigned char>(c) >= 0x20)
+                    out += c;
+            }
+            return out;
+        }
+    };
+
+    /// 只进分析器、不打日志的作用域，用于细粒度的内部阶段
+    class ProfileScope {
+    public:
+        explicit ProfileScope(std::string_view name) {
+            if (Profiler::enabled())
+                id_ = Profiler::instance().begin(std::string(name));
+        }
+        ~ProfileScope() {
+            if (id_ != None)
+                Profiler::instance().end(id_);
+        }
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+
+    private:
+        static constexpr std::uint32_t None = UINT32_MAX;
+        std::uint32_t id_ = None;
+    };
+
+    /// 计时并打印一行日志；启用分析器时改为记入分析器、不再逐个打印，detail 不参与汇总（如文件名）
     class Timer {
     public:
         using clock = std::chrono::steady_clock;
@@ -14,10 +210,23 @@ namespace bench {
         explicit Timer(std::string_view name,
             simplelog::Level lvl = simplelog::Level::INFO,
             const std::source_location& loc = std::source_location::current()) noexcept
-            : name_(name), level_(lvl), loc_(loc), start_(clock::now()) {
+            : Timer(name, {}, lvl, loc) {
+        }
+
+        Timer(std::string_view name, std::string_view detail,
+            simplelog::Level lvl = simplelog::Level::INFO,
+            const std::source_location& loc = std::source_location::current()) noexcept
+            : name_(name), detail_(detail), level_(lvl), loc_(loc), start_(clock::now()) {
+            if (Profiler::enabled()) {
+                try {
+                    id_ = Profiler::instance().begin(name_, detail_);
+                }
+                catch (...) {
+                }
+            }
         }
 
-        // ӡʱԶӡ
+        // 打印耗时（析构自动打印）
         ~Timer() noexcept {
             stop();
         }
@@ -25,18 +234,25 @@ namespace bench {
         void stop() noexcept {
             if (stopped_) return;
             stopped_ = true;
+            if (id_ != NoProfile) {
+                Profiler::instance().end(id_);
+                return;
+            }
             using namespace std::chrono;
             auto end = clock::now();
             auto us = duration_cast<microseconds>(end - start_).count();
             auto ms = us / 1000.0;
 
             simplelog::defaultLogger().log(level_,
-                "[{}] ʱ: {:.3f} ms ({} s)", loc_,
-                name_, ms, us);
+                "[{}{}{}] 耗时: {:.3f} ms ({} μs)", loc_,
+                name_, detail_.empty() ? "" : " ", detail_, ms, us);
         }
 
     private:
+        static constexpr std::uint32_t NoProfile = UINT32_MAX;
         std::string name_;
+        std::string detail_;
+        std::uint32_t id_ = NoProfile;
         simplelog::Level level_;
         std::source_location loc_;
         clock::time_point start_;
@@ -46,10 +262,17 @@ namespace bench {
 #define CONCAT_IMPL(prefix, line) prefix##line
 #define CONCAT(prefix, line) CONCAT_IMPL(prefix, line)
 
-    /// ֱӴʱĺ
+    /// 方便直接创建作用域计时器的宏
 #define BENCH_SCOPE(name, ...) \
     ::bench::Timer CONCAT(_bench_timer_instance_, __LINE__){ name __VA_OPT__(,) __VA_ARGS__ }
 
+    /// 只记入分析器的作用域与计数，未启用时近乎零开销
+#define PROFILE_SCOPE(name) \
+    ::bench::ProfileScope CONCAT(_profile_scope_instance_, __LINE__){ name }
+
+#define PROFILE_COUNT(name, n) \
+    do { if (::bench::Profiler::enabled()) ::bench::Profiler::instance().count(name, n); } while (0)
+
 #define BENCH_DEBUG(name) \
     ::bench::Timer CONCAT(_bench_debug_timer_instance_, __LINE__){ name, simplelog::Level::DEBUG }
 } // namespace bench
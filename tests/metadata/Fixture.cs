@@ -0,0 +1,84 @@
+using System;
+using System.Collections.Generic;
+
+namespace Fixture.Game
+{
+	public delegate void HitHandler(int damage, ref float scale);
+
+	public interface IPoolable
+	{
+		void Release();
+		int Count { get; }
+		event Action Changed;
+	}
+
+	public enum Status : byte
+	{
+		Idle,
+		Busy = 3
+	}
+
+	public abstract class Base<T> : IComparable<Base<T>>
+	{
+		public abstract int CompareTo(Base<T> other);
+		protected virtual void OnUpdate(float deltaTime) { }
+		public T Value { get; protected set; }
+	}
+
+	public static class Extensions
+	{
+		public static int Sum(this List<int> list, params int[] extra) { return 0; }
+		public static bool TryGet<TKey, TValue>(Dictionary<TKey, TValue> d, TKey key, out TValue value) { value = default; return false; }
+	}
+
+	public sealed class Bubble : Base<string>, IPoolable, IDisposableLike
+	{
+		public const int Max = 10;
+		private const string fileName = "a\"b";
+		public static readonly Bubble Empty = new Bubble();
+		private volatile int counter;
+		internal float radius;
+		protected Dictionary<string, List<int>>[] table;
+		private (int, string) pair;
+		private int? maybe;
+		private event Action changed;
+		public event Action Changed { add { changed += value; } remove { changed -= value; } }
+		public event EventHandler<int> Ticked;
+
+		public int Count => 0;
+		public Status State { get; private set; }
+		public int this[int i] => i;
+
+		public Bubble() { }
+		public override int CompareTo(Base<string> other) { return 0; }
+		protected sealed override void OnUpdate(float deltaTime) { }
+		public void Release() { }
+		void IDisposableLike.Dispose() { }
+		public void Setup(string name = null, float scale = 1.5f, double d = 2, Status s = Status.Busy, bool flag = true, char c = 'x', DateTime when = default) { }
+		public IEnumerable<T> Each<T>(Func<T, bool> pred) where T : class { yield break; }
+		public unsafe void Raw(int* p, in Vector v, ref int r) { }
+		public static extern void Native();
+		public static Bubble operator +(Bubble a, Bubble b) => a;
+
+		public struct Vector
+		{
+			public float x;
+			public float y;
+		}
+
+		public enum Kind
+		{
+			A, B
+		}
+
+		public delegate bool Filter<U>(U item);
+
+		private class Hidden<K>
+		{
+			public K Key;
+			public List<K> Keys() => null;
+		}
+	}
+
+	interface IDisposableLike { void Dispose(); }
+}
@@ -0,0 +1,54 @@
+#!/bin/sh
+# ============================================
+# dll 子命令的回归检查
+# 用法：tests/metadata/run.sh <AnalyzeCsClass 可执行文件> [--update]
+#  - 对 Fixture.dll 运行 dll 子命令（含命名空间列表），与 expected/ 逐文件比较，有差异时返回 1
+#  - --update：用本次输出覆盖 expected/，确认差异符合预期后再提交
+#
+# expected/ 为 UTF-8，由仓库根目录 CMakeLists.txt 的 Linux 构建生成（GCC 14，头文件先转成 UTF-8 再编译），
+# 该构建的 ctest 即运行本脚本：
+#   cmake -S . -B build && cmake --build build -j && ctest --test-dir build --output-on-failure
+# vcxproj（MSVC）构建输出为本地代码页，中文内容与 expected/ 不一致
+#
+# Fixture.dll 由同目录的 Fixture.cs 编译而来，改动 Fixture.cs 后用 .NET SDK 自带的 csc 重新生成：
+#   R=<dotnet>/shared/Microsoft.NETCore.App/8.0.x
+#   dotnet <dotnet>/sdk/8.0.x/Roslyn/bincore/csc.dll -nologo -unsafe -t:library -nostdlib \
+#       -r:$R/System.Runtime.dll -r:$R/System.Private.CoreLib.dll -r:$R/System.Collections.dll \
+#       -out:Fixture.dll Fixture.cs
+# ============================================
+set -eu
+
+if [ $# -lt 1 ]; then
+    echo "用法：$0 <AnalyzeCsClass 可执行文件> [--update]" >&2
+    exit 2
+fi
+exe=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+here=$(cd "$(dirname "$0")" && pwd)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+"$exe" dll "$here/Fixture.dll" -o "$work/output" \
+    --namespaces "$work/namespaces" --root-namespaces "$work/root-namespaces" --ns-depth 2 2>"$work/log" || {
+    cat "$work/log" >&2
+    exit 1
+}
+rm -f "$work"/*.manifest "$work"/*.types
+
+if [ "${2:-}" = "--update" ]; then
+    rm -rf "$here/expected"
+    mkdir -p "$here/expected"
+    cp -R "$work/output" "$work/namespaces" "$work/root-namespaces" "$here/expected/"
+    echo "已更新 $here/expected"
+    exit 0
+fi
+
+status=0
+for d in output namespaces root-namespaces; do
+    diff -r "$here/expected/$d" "$work/$d" || status=1
+done
+if [ $status -eq 0 ]; then
+    echo "dll 子命令输出与 expected/ 一致"
+else
+    echo "dll 子命令输出与 expected/ 不一致" >&2
+fi
+exit $status